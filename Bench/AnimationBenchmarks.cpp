@@ -0,0 +1,94 @@
+#include "Benchmarks.h"
+
+#include "Common/Common.h"
+#include "Common/Settings.h"
+#include "Objects/RTObjects.h"
+#include "Render/RTRender.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    RTBench::Result AnimationResult(const std::string& name, const RT::Settings& settings, const double seconds)
+    {
+        RTBench::Result result;
+        result.group = "animation";
+        result.name = std::to_string(settings.imageWidth) + "x" + std::to_string(settings.imageHeight) + "/"
+            + std::to_string(settings.samplesPerPixel) + "spp/" + name;
+        result.operations = static_cast<uint64_t>(settings.frameCount);
+        result.nsPerOperation = seconds * 1e9 / settings.frameCount;
+        result.operationsPerSecond = settings.frameCount / seconds;
+        result.AddMetric("frames", settings.frameCount);
+        result.AddMetric("seconds", seconds);
+        result.AddMetric("frames_per_second", result.operationsPerSecond);
+        return result;
+    }
+}
+
+namespace RTBench
+{
+    void RunAnimationBenchmarks(Harness& harness, const AnimationOptions& options)
+    {
+        RT::Settings settings;
+        settings.imageWidth = options.width;
+        settings.imageHeight = options.height;
+        settings.samplesPerPixel = options.samplesPerPixel;
+        settings.sceneExtent = options.sceneExtent;
+        settings.threadCount = options.threadCount;
+        settings.frameCount = options.frameCount;
+        settings.outputPath = options.directory + "/bench_frame_####.png";
+
+        RTOScene scene;
+        RTOCameraView view;
+        RTObject::MakeScene(settings, scene, view, std::cerr);
+        const RTOCameraPath cameraPath = RTOCameraPath::Orbit(view);
+
+        /*
+         * One frame per launch, as a script calling the renderer for every frame does, without the process start:
+         * each frame generates the scene, builds the BVH, starts the threads and writes its image before the next begins.
+         */
+        const Clock::time_point perFrameStart = Clock::now();
+        for (int frame = 0; frame < settings.frameCount; ++frame)
+        {
+            RTOScene frameScene;
+            RTOCameraView frameView;
+            RTObject::MakeScene(settings, frameScene, frameView, std::cerr);
+            const RTTBVH world = frameScene.BuildHierarchy(settings.sphereGroupSize);
+            const RTOCamera camera = cameraPath.FrameView(frame, settings.frameCount).ToCamera(settings.AspectRatio());
+            RTRWorkerPool pool(settings.threadCount);
+            RTRFrameRenderer renderer(settings, camera, world, pool);
+            RTRFrameBuffer image(settings.imageWidth, settings.imageHeight);
+            renderer.RenderRows(image, 0, settings.imageHeight);
+            RTRImageWriter writer(settings.FramePath(frame), RTRImageFormat::PNG, image);
+            writer.Finish();
+        }
+        const double perFrameSeconds = RT::SecondsSince(perFrameStart);
+        Result perFrame = AnimationResult("per-frame setup", settings, perFrameSeconds);
+        harness.Add(std::move(perFrame));
+
+        // The animation mode: scene, BVH and threads stay resident, frame f is written while frame f + 1 is traced
+        const Clock::time_point residentStart = Clock::now();
+        const RTTBVH world = scene.BuildHierarchy(settings.sphereGroupSize);
+        RTRWorkerPool pool(settings.threadCount);
+        RTRFrameRenderer renderer(settings, view.ToCamera(settings.AspectRatio()), world, pool);
+        RTRAnimationStats animationStats;
+        std::ostringstream log;
+        RTRender::RenderAnimation(settings, cameraPath, renderer, animationStats, log);
+        const double residentSeconds = RT::SecondsSince(residentStart);
+        Result resident = AnimationResult("resident pipelined", settings, residentSeconds);
+        resident.AddMetric("speedup", perFrameSeconds / residentSeconds);
+        resident.AddMetric("write_wait_seconds", animationStats.writeWaitSeconds);
+        harness.Add(std::move(resident));
+
+        for (int frame = 0; frame < settings.frameCount; ++frame)
+        {
+            std::remove(settings.FramePath(frame).c_str());
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Harness.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace RTRender
+{
+    class FrameBuffer;
+}
+
+namespace RTBench
+{
+    // Sphere and list intersection, Vector3 operators, random directions and material scattering
+    void RunMicrobenchmarks(Harness& harness);
+
+    // Throughput and accuracy of vector math and sphere intersection in float and double, textbook and robust quadratic
+    void RunPrecisionBenchmarks(Harness& harness);
+
+    struct FrameOptions
+    {
+        // Width x height pairs
+        std::vector<std::pair<int, int>> resolutions{{160, 90}, {320, 180}, {640, 360}};
+        // Empty runs 1, 2, 4, ... up to the hardware thread count
+        std::vector<int> threadCounts;
+        int samplesPerPixel = 4;
+        int sceneExtent = 11;
+        // Every thread count also with its workers pinned to CPUs and the frame rows placed on their NUMA nodes
+        bool comparePinning = true;
+    };
+
+    // Whole frames of the fixed-seed random scene, with a scaling curve over the thread counts, unpinned and pinned
+    void RunFrameBenchmarks(Harness& harness, const FrameOptions& options);
+
+    struct SceneOptions
+    {
+        // Random scenes of (2 * extent)^2 small spheres
+        std::vector<int> sceneExtents{11, 100, 300};
+        // Where the scene files are written, and removed again
+        std::string directory = ".";
+        // Random scenes built from instances of one cluster, 5000 places a million of them
+        std::vector<int> instancedExtents{50, 500, 5000};
+        int clusterExtent = 5;
+        // Largest extent also built with every sphere on its own, for comparison
+        int maxFlatExtent = 500;
+    };
+
+    // Time to first ray, memory and camera ray rate of random scenes generated in code, loaded from a scene file and
+    // built from instances of one cluster
+    void RunSceneBenchmarks(Harness& harness, const SceneOptions& options);
+
+    struct AnimationOptions
+    {
+        int frameCount = 8;
+        int width = 640;
+        int height = 360;
+        int samplesPerPixel = 4;
+        // 0 is one thread per hardware thread
+        int threadCount = 0;
+        int sceneExtent = 11;
+        // Where the frames are written, and removed again
+        std::string directory = ".";
+    };
+
+    // Frames per second of an orbit around the random scene, set up anew for every frame against the animation mode
+    void RunAnimationBenchmarks(Harness& harness, const AnimationOptions& options);
+
+    struct DenoiseOptions
+    {
+        int width = 320;
+        int height = 180;
+        // Sample counts the denoiser is measured at
+        std::vector<int> samplesPerPixel{1, 2, 4, 8, 16, 32};
+        // Samples per pixel of the image the error is measured against
+        int referenceSamplesPerPixel = 256;
+        // 0 is one thread per hardware thread
+        int threadCount = 0;
+        int sceneExtent = 11;
+    };
+
+    // Denoiser time and display RMSE against a high sample count reference, before and after denoising
+    void RunDenoiseBenchmarks(Harness& harness, const DenoiseOptions& options);
+
+    struct SamplerOptions
+    {
+        int width = 160;
+        int height = 90;
+        // Sample counts every sampler is measured at
+        std::vector<int> samplesPerPixel{1, 2, 4, 8, 16, 32, 64};
+        // Samples per pixel of the random-sampler image the error is measured against
+        int referenceSamplesPerPixel = 2048;
+        // Sample count of the random sampler whose error the others are matched against
+        int matchedSamplesPerPixel = 32;
+        // 0 is one thread per hardware thread
+        int threadCount = 0;
+        int sceneExtent = 11;
+    };
+
+    // Display RMSE against sample count of the random, Sobol and blue-noise samplers, and the samples each one needs
+    // to match the error of the random sampler at matchedSamplesPerPixel
+    void RunSamplerBenchmarks(Harness& harness, const SamplerOptions& options);
+
+    // RMSE after gamma 2, as --compare measures it, of two images of the same size
+    double DisplayRmse(const RTRender::FrameBuffer& image, const RTRender::FrameBuffer& reference);
+
+    /*
+     * Display-space difference of two PFM renders of the same size, for example the float and the double build:
+     * RMSE and maximum after gamma 2, PSNR, and the share of pixels that change by more than one 8-bit step.
+     */
+    bool CompareImages(Harness& harness, const std::string& referencePath, const std::string& imagePath, std::ostream& errorOut);
+}
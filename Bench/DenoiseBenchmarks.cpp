@@ -0,0 +1,85 @@
+#include "Benchmarks.h"
+
+#include "Common/Common.h"
+#include "Common/Settings.h"
+#include "Objects/RTObjects.h"
+#include "Render/RTRender.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+}
+
+namespace RTBench
+{
+    void RunDenoiseBenchmarks(Harness& harness, const DenoiseOptions& options)
+    {
+        RT::Settings settings;
+        settings.imageWidth = options.width;
+        settings.imageHeight = options.height;
+        settings.sceneExtent = options.sceneExtent;
+        settings.threadCount = options.threadCount;
+
+        RTOScene scene;
+        RTOCameraView view;
+        RTObject::MakeScene(settings, scene, view, std::cerr);
+        const RTTBVH world = scene.BuildHierarchy(settings.sphereGroupSize);
+        const RTOCamera camera = view.ToCamera(settings.AspectRatio());
+        RTRWorkerPool pool(settings.threadCount);
+        RTRFrameRenderer renderer(settings, camera, world, pool);
+
+        // Samples are seeded per pixel and sample, so the reference shares the first samples of every level
+        settings.samplesPerPixel = options.referenceSamplesPerPixel;
+        RTRFrameBuffer reference(settings.imageWidth, settings.imageHeight);
+        renderer.RenderRows(reference, 0, settings.imageHeight);
+
+        RTRDenoiser::Parameters parameters;
+        for (const int samplesPerPixel : options.samplesPerPixel)
+        {
+            settings.samplesPerPixel = samplesPerPixel;
+            parameters.samplesPerPixel = samplesPerPixel;
+            const RTRDenoiser denoiser(parameters);
+            RTRFrameBuffer noisy(settings.imageWidth, settings.imageHeight);
+            RTRGuideBuffers guides(settings.imageWidth, settings.imageHeight);
+            renderer.SetGuideBuffers(&guides);
+            const RTRTileScheduler::Stats traceStats = renderer.RenderRows(noisy, 0, settings.imageHeight);
+            renderer.SetGuideBuffers(nullptr);
+
+            // Fastest of a few runs on copies of the noisy image
+            RTRFrameBuffer denoised = noisy;
+            double denoiseSeconds = 0.0;
+            for (int run = 0; run < 3; ++run)
+            {
+                denoised = noisy;
+                const Clock::time_point start = Clock::now();
+                denoiser.Denoise(denoised, guides, pool);
+                const double seconds = RT::SecondsSince(start);
+                denoiseSeconds = run == 0 ? seconds : std::min(denoiseSeconds, seconds);
+            }
+
+            const double noisyRmse = DisplayRmse(noisy, reference);
+            const double denoisedRmse = DisplayRmse(denoised, reference);
+            const auto pixelCount = static_cast<double>(settings.PixelCount());
+
+            Result result;
+            result.group = "denoise";
+            result.name = std::to_string(settings.imageWidth) + "x" + std::to_string(settings.imageHeight) + "/"
+                + std::to_string(samplesPerPixel) + "spp/" + std::to_string(pool.GetThreadCount()) + " threads";
+            result.operations = static_cast<uint64_t>(pixelCount);
+            result.nsPerOperation = denoiseSeconds * 1e9 / pixelCount;
+            result.operationsPerSecond = pixelCount / denoiseSeconds;
+            result.AddMetric("trace_ms", traceStats.wallSeconds * 1e3);
+            result.AddMetric("denoise_ms", denoiseSeconds * 1e3);
+            result.AddMetric("noisy_rmse", noisyRmse);
+            result.AddMetric("denoised_rmse", denoisedRmse);
+            result.AddMetric("rmse_reduction", noisyRmse / denoisedRmse);
+            harness.Add(std::move(result));
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#include "Benchmarks.h"
+
+#include "Common/Common.h"
+#include "Common/CpuTopology.h"
+#include "Common/Settings.h"
+#include "Objects/RTObjects.h"
+#include "Render/RTRender.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace RTBench
+{
+    void RunFrameBenchmarks(Harness& harness, const FrameOptions& options)
+    {
+        std::vector<int> threadCounts = options.threadCounts;
+        if (threadCounts.empty())
+        {
+            const int hardwareThreads = RTRWorkerPool::HardwareThreadCount();
+            for (int threads = 1; threads < hardwareThreads; threads *= 2)
+            {
+                threadCounts.push_back(threads);
+            }
+            threadCounts.push_back(hardwareThreads);
+        }
+
+        // Every thread count unpinned, then pinned
+        std::vector<std::pair<int, bool>> runs;
+        for (const int threads : threadCounts)
+        {
+            runs.emplace_back(threads, false);
+            if (options.comparePinning) runs.emplace_back(threads, true);
+        }
+
+        // Same scene and camera as the renderer with its default seed
+        RT::Settings settings;
+        settings.samplesPerPixel = options.samplesPerPixel;
+        settings.sceneExtent = options.sceneExtent;
+
+        RT::ThreadRandom().Seed(settings.seed, 0);
+        RTOScene scene = RTObject::RandomScene(settings.sceneExtent);
+        const RTTBVH world(scene.PackSpheres(settings.sphereGroupSize), 1);
+        const RTRPathIntegrator integrator(settings.minDepth, settings.maxDepth);
+
+        for (const auto& [width, height] : options.resolutions)
+        {
+            settings.imageWidth = width;
+            settings.imageHeight = height;
+            const RTOCamera camera = RTObject::RandomSceneCamera(settings.AspectRatio());
+            const RTRTileScheduler scheduler(width, height, settings.tileWidth, settings.tileHeight, settings.workStealing);
+
+            double singleThreadSeconds = 0.0;
+            for (const auto& [threads, isPinned] : runs)
+            {
+                // Thread counts are measured as asked, past the CPUs too, so the curve shows what oversubscription costs
+                RTRender::WorkerPoolOptions poolOptions;
+                poolOptions.isPinned = isPinned;
+                poolOptions.allowOversubscription = true;
+                RTRWorkerPool pool(threads, poolOptions);
+                RTRFrameBuffer image(width, height);
+                image.PlaceRows(pool, settings.tileHeight);
+                auto renderFrame = [&]()
+                {
+                    return scheduler.Render(pool, [&](const RTRTile& tile, int)
+                    {
+                        integrator.RenderTile(image, settings, camera, world, tile);
+                    });
+                };
+
+                // The first frame warms caches and page tables, the second one is measured
+                renderFrame();
+                RTRRenderStats::Reset();
+                const RTRTileScheduler::Stats frameStats = renderFrame();
+
+                // Without render statistics only the primary rays are known
+                const double seconds = frameStats.wallSeconds;
+                const auto primaryRays = static_cast<uint64_t>(settings.PixelCount()) * settings.samplesPerPixel;
+                const uint64_t rays = RT::renderStats ? RTRRenderStats::Total().Rays() : primaryRays;
+                if (threads == threadCounts.front() && !isPinned) singleThreadSeconds = seconds * threads;
+
+                Result result;
+                result.group = "frame";
+                result.name = std::to_string(width) + "x" + std::to_string(height) + "/" + std::to_string(settings.samplesPerPixel) + "spp/"
+                    + std::to_string(threads) + "t" + (isPinned ? "/pinned" : "");
+                result.operations = rays;
+                result.nsPerOperation = seconds * 1e9 / static_cast<double>(rays);
+                result.operationsPerSecond = static_cast<double>(rays) / seconds;
+                result.AddMetric("threads", threads);
+                if (isPinned)
+                {
+                    const RT::CpuTopology& topology = RT::SystemTopology();
+                    result.AddMetric("cpus", static_cast<double>(topology.cpus.size()));
+                    result.AddMetric("cores", topology.coreCount);
+                    result.AddMetric("numa_nodes", topology.nodeCount);
+                }
+                result.AddMetric("seconds", seconds);
+                result.AddMetric("primary_rays_per_second", static_cast<double>(primaryRays) / seconds);
+                if constexpr (RT::renderStats) result.AddMetric("rays_per_second", result.operationsPerSecond);
+                // Scaling curve, relative to the smallest unpinned thread count as if it scaled perfectly down to one thread
+                result.AddMetric("speedup", singleThreadSeconds / seconds);
+                result.AddMetric("efficiency", singleThreadSeconds / seconds / threads);
+                result.AddMetric("load_imbalance", frameStats.LoadImbalance());
+                harness.Add(std::move(result));
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#include "Harness.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+    std::string EscapeJson(const std::string& text)
+    {
+        std::string escaped;
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+}
+
+namespace RTBench
+{
+    void Result::AddMetric(const std::string& key, const double value)
+    {
+        metrics.emplace_back(key, value);
+    }
+
+    Harness::Harness(const double inMinSeconds, const int inRepetitions)
+        : minSeconds(inMinSeconds), repetitions(std::max(1, inRepetitions))
+    {
+    }
+
+    Result& Harness::Add(Result result)
+    {
+        results.push_back(std::move(result));
+        return results.back();
+    }
+
+    const std::vector<Result>& Harness::GetResults() const
+    {
+        return results;
+    }
+
+    void Harness::Print(std::ostream& out) const
+    {
+        for (const Result& result : results)
+        {
+            out << std::left << std::setw(10) << result.group << std::setw(34) << result.name << std::right
+                << std::setw(12) << std::fixed << std::setprecision(2) << result.nsPerOperation << " ns/op"
+                << std::setw(14) << std::setprecision(2) << result.operationsPerSecond / 1e6 << " M/s";
+            for (const auto& [key, value] : result.metrics)
+            {
+                out << "  " << key << " " << std::defaultfloat << std::setprecision(4) << value;
+            }
+            out << std::defaultfloat << "\n";
+        }
+    }
+
+    bool Harness::WriteJson(const std::string& path) const
+    {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        out << std::setprecision(9) << "[\n";
+        for (size_t index = 0; index < results.size(); ++index)
+        {
+            const Result& result = results[index];
+            out << "  {\"group\": \"" << EscapeJson(result.group) << "\", \"name\": \"" << EscapeJson(result.name)
+                << "\", \"operations\": " << result.operations
+                << ", \"ns_per_op\": " << result.nsPerOperation
+                << ", \"ops_per_second\": " << result.operationsPerSecond
+                << ", \"metrics\": {";
+            for (size_t metric = 0; metric < result.metrics.size(); ++metric)
+            {
+                out << (metric > 0 ? ", " : "") << "\"" << EscapeJson(result.metrics[metric].first) << "\": " << result.metrics[metric].second;
+            }
+            out << "}}" << (index + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+        return static_cast<bool>(out);
+    }
+
+    bool Harness::WriteCsv(const std::string& path) const
+    {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        out << std::setprecision(9) << "group,name,metric,value\n";
+        for (const Result& result : results)
+        {
+            out << result.group << "," << result.name << ",ns_per_op," << result.nsPerOperation << "\n";
+            out << result.group << "," << result.name << ",ops_per_second," << result.operationsPerSecond << "\n";
+            for (const auto& [key, value] : result.metrics)
+            {
+                out << result.group << "," << result.name << "," << key << "," << value << "\n";
+            }
+        }
+        return static_cast<bool>(out);
+    }
+
+    void Harness::Consume(const double checksum)
+    {
+        static volatile double sink = 0.0;
+        sink = sink + checksum;
+    }
+}
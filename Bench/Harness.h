@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace RTBench
+{
+    struct Result
+    {
+        std::string group;
+        std::string name;
+        uint64_t operations{};
+        double nsPerOperation{};
+        double operationsPerSecond{};
+        // Extra numbers of this benchmark, for example rays per second or speedup over one thread
+        std::vector<std::pair<std::string, double>> metrics;
+
+        void AddMetric(const std::string& key, double value);
+    };
+
+    /*
+     * Times small kernels and collects results. A kernel runs a fixed batch of operations per call and returns a
+     * checksum, so the optimizer cannot drop the work. Calls are repeated until a run takes minSeconds, the fastest
+     * of a few runs is kept.
+     */
+    class Harness
+    {
+    private:
+        double minSeconds;
+        int repetitions;
+        std::vector<Result> results;
+
+    public:
+        explicit Harness(double inMinSeconds = 0.2, int inRepetitions = 3);
+
+        template <typename Kernel>
+        Result& Measure(const std::string& group, const std::string& name, uint64_t operationsPerCall, Kernel&& kernel);
+
+        // Result measured elsewhere, for example a whole frame
+        Result& Add(Result result);
+
+        [[nodiscard]] const std::vector<Result>& GetResults() const;
+
+        void Print(std::ostream& out) const;
+        bool WriteJson(const std::string& path) const;
+        // One row per number: group, name, metric, value
+        bool WriteCsv(const std::string& path) const;
+
+    private:
+        static void Consume(double checksum);
+    };
+
+    template <typename Kernel>
+    Result& Harness::Measure(const std::string& group, const std::string& name, const uint64_t operationsPerCall, Kernel&& kernel)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Warm up caches and find a call count that runs for at least minSeconds
+        uint64_t calls = 1;
+        while (true)
+        {
+            const auto start = Clock::now();
+            for (uint64_t call = 0; call < calls; ++call)
+            {
+                Consume(kernel());
+            }
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (seconds >= minSeconds) break;
+            calls = seconds > 0.0 ? std::max(calls * 2, static_cast<uint64_t>(calls * minSeconds / seconds * 1.1)) : calls * 2;
+        }
+
+        double bestSeconds = 0.0;
+        for (int repetition = 0; repetition < repetitions; ++repetition)
+        {
+            const auto start = Clock::now();
+            for (uint64_t call = 0; call < calls; ++call)
+            {
+                Consume(kernel());
+            }
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (repetition == 0 || seconds < bestSeconds) bestSeconds = seconds;
+        }
+
+        Result result;
+        result.group = group;
+        result.name = name;
+        result.operations = calls * operationsPerCall;
+        result.nsPerOperation = bestSeconds * 1e9 / static_cast<double>(result.operations);
+        result.operationsPerSecond = static_cast<double>(result.operations) / bestSeconds;
+        return Add(std::move(result));
+    }
+}
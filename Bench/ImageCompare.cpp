@@ -0,0 +1,112 @@
+#include "Benchmarks.h"
+
+#include "Render/FrameBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+    struct FloatImage
+    {
+        int width = 0;
+        int height = 0;
+        // Linear RGB, rows top to bottom
+        std::vector<float> pixels;
+    };
+
+    // Reads the little-endian PFM files the renderer writes
+    bool ReadPfm(const std::string& path, FloatImage& image, std::ostream& errorOut)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string magic;
+        float scale = 0.0f;
+        if (!(file >> magic >> image.width >> image.height >> scale) || magic != "PF" || image.width <= 0 || image.height <= 0 || scale >= 0.0f)
+        {
+            errorOut << path << " is not a little-endian color PFM image.\n";
+            return false;
+        }
+        file.get();
+
+        const size_t rowValues = static_cast<size_t>(image.width) * 3;
+        image.pixels.resize(rowValues * image.height);
+        for (int fileRow = 0; fileRow < image.height; ++fileRow)
+        {
+            float* row = image.pixels.data() + static_cast<size_t>(image.height - 1 - fileRow) * rowValues;
+            if (!file.read(reinterpret_cast<char*>(row), static_cast<std::streamsize>(rowValues * sizeof(float))))
+            {
+                errorOut << path << " ends early.\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Same transfer as the 8-bit writers, gamma 2 on [0, 1]
+    double Display(const float value)
+    {
+        return std::sqrt(std::clamp(static_cast<double>(value), 0.0, 1.0));
+    }
+}
+
+namespace RTBench
+{
+    double DisplayRmse(const RTRender::FrameBuffer& image, const RTRender::FrameBuffer& reference)
+    {
+        double squaredSum = 0.0;
+        for (int y = 0; y < image.GetHeight(); ++y)
+        {
+            const float* row = image.Row(y);
+            const float* referenceRow = reference.Row(y);
+            for (int value = 0; value < 3 * image.GetWidth(); ++value)
+            {
+                const double difference = Display(row[value]) - Display(referenceRow[value]);
+                squaredSum += difference * difference;
+            }
+        }
+        return std::sqrt(squaredSum / (3.0 * image.GetWidth() * image.GetHeight()));
+    }
+
+    bool CompareImages(Harness& harness, const std::string& referencePath, const std::string& imagePath, std::ostream& errorOut)
+    {
+        FloatImage reference, image;
+        if (!ReadPfm(referencePath, reference, errorOut) || !ReadPfm(imagePath, image, errorOut)) return false;
+        if (reference.width != image.width || reference.height != image.height)
+        {
+            errorOut << "Images differ in size, " << reference.width << 'x' << reference.height << " and " << image.width << 'x' << image.height << ".\n";
+            return false;
+        }
+
+        double squaredSum = 0.0;
+        double maxDifference = 0.0;
+        size_t differingPixels = 0;
+        const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+        for (size_t pixel = 0; pixel < pixelCount; ++pixel)
+        {
+            bool isDiffering = false;
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                const double difference = std::fabs(Display(image.pixels[3 * pixel + channel]) - Display(reference.pixels[3 * pixel + channel]));
+                squaredSum += difference * difference;
+                maxDifference = std::max(maxDifference, difference);
+                // More than one step of an 8-bit image
+                isDiffering |= difference > 1.0 / 255.0;
+            }
+            differingPixels += isDiffering;
+        }
+
+        const double rmse = std::sqrt(squaredSum / static_cast<double>(3 * pixelCount));
+        Result result;
+        result.group = "image";
+        result.name = "difference";
+        result.operations = pixelCount;
+        result.AddMetric("rmse", rmse);
+        // Identical images have no finite PSNR
+        if (rmse > 0.0) result.AddMetric("psnr_db", -20.0 * std::log10(rmse));
+        result.AddMetric("max_difference", maxDifference);
+        result.AddMetric("differing_pixels", static_cast<double>(differingPixels) / static_cast<double>(pixelCount));
+        harness.Add(std::move(result));
+        return true;
+    }
+}
@@ -0,0 +1,277 @@
+#include "Benchmarks.h"
+
+#include "Common/Common.h"
+#include "Objects/RTObjects.h"
+#include "Types/RTTypes.h"
+
+#include <string>
+
+namespace
+{
+    // Operations per kernel call, large enough to hide the call, small enough to stay in L1
+    constexpr int batchSize = 1024;
+
+    // Start a sample of the default sampler as a render does, whose paths then draw from the dimensions of their bounces
+    void StartRenderSample(const int sampleIndex)
+    {
+        RT::ThreadSampler().StartSample(RT::sampler, RT::seed, 0, 0, 1, sampleIndex);
+    }
+
+    // Rays from z = -5 towards points at a distance in [minRadius, maxRadius) from the axis through a unit sphere at the origin
+    std::vector<RTTRay> RaysTowardsRing(const double minRadius, const double maxRadius)
+    {
+        std::vector<RTTRay> rays;
+        rays.reserve(batchSize);
+        const RTTPoint3 origin(0.0, 0.0, -5.0);
+        for (int index = 0; index < batchSize; ++index)
+        {
+            const double angle = RT::RandomDouble(0.0, 2.0 * RT::pi);
+            const double radius = RT::RandomDouble(minRadius, maxRadius);
+            const RTTPoint3 target(radius * std::cos(angle), radius * std::sin(angle), 0.0);
+            rays.emplace_back(origin, target - origin);
+        }
+        return rays;
+    }
+
+    std::vector<RTTRay> RandomRays(const double extent)
+    {
+        std::vector<RTTRay> rays;
+        rays.reserve(batchSize);
+        for (int index = 0; index < batchSize; ++index)
+        {
+            rays.emplace_back(RTTPoint3::Random(-extent, extent), RTType::SampleUnitVector());
+        }
+        return rays;
+    }
+
+    void SphereBenchmarks(RTBench::Harness& harness, const RTTMaterial* material)
+    {
+        const RTOSphere sphere(RTTPoint3(0.0, 0.0, 0.0), 1.0, material);
+
+        struct Case
+        {
+            const char* name;
+            double minRadius;
+            double maxRadius;
+        };
+        const Case cases[] = {{"Sphere::Hit/hit", 0.0, 0.9}, {"Sphere::Hit/miss", 1.1, 2.0}, {"Sphere::Hit/grazing", 0.99, 1.0}};
+
+        for (const Case& testCase : cases)
+        {
+            const std::vector<RTTRay> rays = RaysTowardsRing(testCase.minRadius, testCase.maxRadius);
+            harness.Measure("intersect", testCase.name, batchSize, [&]()
+            {
+                double checksum = 0.0;
+                RTTHitResult hitRecord;
+                for (const RTTRay& ray : rays)
+                {
+                    if (sphere.Hit(ray, 0.001, RT::infinity, hitRecord)) checksum += hitRecord.t;
+                }
+                return checksum;
+            });
+        }
+    }
+
+    void ListBenchmarks(RTBench::Harness& harness, const RTTMaterial* material)
+    {
+        constexpr double extent = 10.0;
+        const std::vector<RTTRay> rays = RandomRays(extent);
+
+        for (const int size : {1, 8, 64, 512})
+        {
+            std::vector<RTOSphere> spheres;
+            spheres.reserve(size);
+            for (int index = 0; index < size; ++index)
+            {
+                spheres.emplace_back(RTTPoint3::Random(-extent, extent), 0.5, material);
+            }
+
+            RTTHittableList list;
+            for (const RTOSphere& sphere : spheres)
+            {
+                list.Add(&sphere);
+            }
+            const RTTBVH bvh(list);
+
+            auto traceAll = [&](const RTTHittable& world)
+            {
+                return [&rays, &world]()
+                {
+                    double checksum = 0.0;
+                    RTTHitResult hitRecord;
+                    for (const RTTRay& ray : rays)
+                    {
+                        if (world.Hit(ray, 0.001, RT::infinity, hitRecord)) checksum += hitRecord.t;
+                    }
+                    return checksum;
+                };
+            };
+            auto occludeAll = [&](const RTTHittable& world)
+            {
+                return [&rays, &world]()
+                {
+                    double checksum = 0.0;
+                    for (const RTTRay& ray : rays)
+                    {
+                        if (world.Occluded(ray, 0.001, RT::infinity)) checksum += 1.0;
+                    }
+                    return checksum;
+                };
+            };
+
+            // A list tests every sphere, so the time per ray over the size is the cost of one intersection
+            RTBench::Result& listResult = harness.Measure("intersect", "HittableList::Hit/" + std::to_string(size), batchSize, traceAll(list));
+            listResult.AddMetric("ns_per_intersection", listResult.nsPerOperation / size);
+
+            harness.Measure("intersect", "BVH::Hit/" + std::to_string(size), batchSize, traceAll(bvh));
+
+            // Any hit ends the query, so the occlusion tests stop early on rays that hit something
+            harness.Measure("intersect", "HittableList::Occluded/" + std::to_string(size), batchSize, occludeAll(list));
+            harness.Measure("intersect", "BVH::Occluded/" + std::to_string(size), batchSize, occludeAll(bvh));
+        }
+    }
+
+    void VectorBenchmarks(RTBench::Harness& harness)
+    {
+        std::vector<RTTVector3> a(batchSize), b(batchSize);
+        for (int index = 0; index < batchSize; ++index)
+        {
+            a[index] = RTTVector3::Random(-1.0, 1.0);
+            b[index] = RTTVector3::Random(-1.0, 1.0);
+        }
+
+        harness.Measure("vector", "operator+", batchSize, [&]()
+        {
+            RTTVector3 sum;
+            for (int index = 0; index < batchSize; ++index) sum += a[index] + b[index];
+            return sum.x + sum.y + sum.z;
+        });
+        harness.Measure("vector", "operator*(scalar)", batchSize, [&]()
+        {
+            RTTVector3 sum;
+            for (int index = 0; index < batchSize; ++index) sum += a[index] * 0.5;
+            return sum.x + sum.y + sum.z;
+        });
+        harness.Measure("vector", "operator*(Vector3)", batchSize, [&]()
+        {
+            RTTVector3 sum;
+            for (int index = 0; index < batchSize; ++index) sum += a[index] * b[index];
+            return sum.x + sum.y + sum.z;
+        });
+        harness.Measure("vector", "Dot", batchSize, [&]()
+        {
+            double sum = 0.0;
+            for (int index = 0; index < batchSize; ++index) sum += Dot(a[index], b[index]);
+            return sum;
+        });
+        harness.Measure("vector", "Cross", batchSize, [&]()
+        {
+            RTTVector3 sum;
+            for (int index = 0; index < batchSize; ++index) sum += Cross(a[index], b[index]);
+            return sum.x + sum.y + sum.z;
+        });
+        harness.Measure("vector", "UnitVector", batchSize, [&]()
+        {
+            RTTVector3 sum;
+            for (int index = 0; index < batchSize; ++index) sum += UnitVector(a[index]);
+            return sum.x + sum.y + sum.z;
+        });
+    }
+
+    void RandomBenchmarks(RTBench::Harness& harness)
+    {
+        harness.Measure("random", "RandomDouble", batchSize, []()
+        {
+            double sum = 0.0;
+            for (int index = 0; index < batchSize; ++index) sum += RT::RandomDouble();
+            return sum;
+        });
+
+        // The warps the materials and the lens draw from, every call at the dimensions of one bounce of a path
+        int sampleIndex = 0;
+        harness.Measure("random", "SampleUnitVector", batchSize, [&]()
+        {
+            StartRenderSample(sampleIndex++);
+            RTTVector3 sum;
+            for (int index = 0; index < batchSize; ++index)
+            {
+                RT::ThreadSampler().StartBounce(index % RT::maxDepth);
+                sum += RTType::SampleUnitVector();
+            }
+            return sum.x + sum.y + sum.z;
+        });
+        harness.Measure("random", "SampleUnitDisk", batchSize, [&]()
+        {
+            StartRenderSample(sampleIndex++);
+            RTTVector3 sum;
+            for (int index = 0; index < batchSize; ++index)
+            {
+                RT::ThreadSampler().StartBounce(index % RT::maxDepth);
+                sum += RTType::SampleUnitDisk();
+            }
+            return sum.x + sum.y + sum.z;
+        });
+    }
+
+    void ScatterBenchmarks(RTBench::Harness& harness)
+    {
+        const RTType::Lambertian lambertian(RTTColor(0.5, 0.5, 0.5));
+        const RTType::Metal metal(RTTColor(0.8, 0.8, 0.8), 0.3);
+        const RTType::Dielectric dielectric(1.5);
+
+        // Rays coming down onto the top of a unit sphere at the origin
+        std::vector<RTTRay> rays;
+        std::vector<RTTHitResult> hits;
+        rays.reserve(batchSize);
+        hits.reserve(batchSize);
+        for (int index = 0; index < batchSize; ++index)
+        {
+            RTTVector3 direction = RTType::SampleUnitVector();
+            direction.y = -std::fabs(direction.y) - 0.1;
+            const RTTRay& ray = rays.emplace_back(RTTPoint3(0.0, 2.0, 0.0), direction);
+
+            RTTHitResult& hit = hits.emplace_back();
+            hit.point = RTTPoint3(0.0, 1.0, 0.0);
+            hit.t = 1.0;
+            hit.SetFaceNormal(ray, RTTVector3(0.0, 1.0, 0.0));
+        }
+
+        const std::pair<const char*, const RTTMaterial*> materials[] = {
+            {"Lambertian::Scatter", &lambertian}, {"Metal::Scatter", &metal}, {"Dielectric::Scatter", &dielectric}
+        };
+        int sampleIndex = 0;
+        for (const auto& [name, material] : materials)
+        {
+            harness.Measure("scatter", name, batchSize, [&, material = material]()
+            {
+                StartRenderSample(sampleIndex++);
+                double checksum = 0.0;
+                RTTColor attenuation;
+                RTTRay scattered;
+                for (int index = 0; index < batchSize; ++index)
+                {
+                    RT::ThreadSampler().StartBounce(index % RT::maxDepth);
+                    if (material->Scatter(rays[index], hits[index], attenuation, scattered)) checksum += scattered.direction.y;
+                }
+                return checksum;
+            });
+        }
+    }
+}
+
+namespace RTBench
+{
+    void RunMicrobenchmarks(Harness& harness)
+    {
+        // Scenes and rays come from independent numbers, the kernels that render paths draw from the default sampler
+        RT::ThreadRandom().Seed(RT::seed, 1);
+        RT::ThreadSampler().StartSample(RT::SamplerType::Random, RT::seed, 0, 0, 1, 0);
+        const RTType::Lambertian material(RTTColor(0.5, 0.5, 0.5));
+
+        SphereBenchmarks(harness, &material);
+        ListBenchmarks(harness, &material);
+        VectorBenchmarks(harness);
+        RandomBenchmarks(harness);
+        ScatterBenchmarks(harness);
+    }
+}
@@ -0,0 +1,198 @@
+#include "Benchmarks.h"
+
+#include "Common/Common.h"
+#include "Objects/RTObjects.h"
+#include "Types/RTTypes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace
+{
+    constexpr int batchSize = 1024;
+    constexpr double tMin = 0.001;
+
+    // The quadratic as Sphere::Hit solved it before it was made robust, for comparison
+    template <typename T>
+    bool IntersectSphereTextbook(const RTType::TRay<T>& ray, const RTType::TVector3<T>& center, const T radius, const T tMin, const T tMax, T& t)
+    {
+        const RTType::TVector3<T> oc = ray.Origin() - center;
+        const T a = ray.Direction().LengthSquared();
+        const T b = 2 * Dot(oc, ray.Direction());
+        const T c = oc.LengthSquared() - radius * radius;
+        const T discriminant = b * b - 4 * a * c;
+        if (discriminant < 0) return false;
+
+        const T left = -b / (2 * a);
+        const T right = std::sqrt(discriminant) / (2 * a);
+        T root = left - right;
+        if (root < tMin || tMax < root)
+        {
+            root = left + right;
+            if (root < tMin || tMax < root) return false;
+        }
+        t = root;
+        return true;
+    }
+
+    // Plain long double textbook solution, with 64 mantissa bits it loses nothing that matters here
+    bool ReferenceIntersection(const double (&origin)[3], const double (&direction)[3], const double (&center)[3], const double radius, long double& t)
+    {
+        long double oc[3], a = 0, halfB = 0, c = -static_cast<long double>(radius) * radius;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            oc[axis] = static_cast<long double>(origin[axis]) - center[axis];
+            a += static_cast<long double>(direction[axis]) * direction[axis];
+            halfB += oc[axis] * direction[axis];
+            c += oc[axis] * oc[axis];
+        }
+        const long double discriminant = halfB * halfB - a * c;
+        if (discriminant < 0) return false;
+
+        const long double root = std::sqrt(discriminant);
+        t = (-halfB - root) / a;
+        if (t < tMin) t = (-halfB + root) / a;
+        return t >= tMin;
+    }
+
+    /*
+     * Rays of one accuracy case in double, converted to each precision before they are traced.
+     *	far: a unit sphere 1000 to 10000 units away, where b^2 - 4ac cancels;
+     *	surface: rays leaving random points on a sphere of radius 1000, like bounces off the ground of the random scene,
+     *	which must not hit their own sphere again (shadow acne).
+     */
+    struct AccuracyCase
+    {
+        std::string name;
+        double center[3];
+        double radius;
+        std::vector<std::pair<RTType::TVector3<double>, RTType::TVector3<double>>> rays;
+    };
+
+    AccuracyCase FarCase()
+    {
+        AccuracyCase accuracyCase{"far", {0.0, 0.0, 0.0}, 1.0, {}};
+        for (int index = 0; index < batchSize; ++index)
+        {
+            const double distance = RT::RandomDouble(1000.0, 10000.0);
+            const RTType::TVector3<double> origin = distance * UnitVector(RTType::TVector3<double>::Random(-1.0, 1.0));
+            const RTType::TVector3<double> target = RTType::TVector3<double>::Random(-1.2, 1.2);
+            accuracyCase.rays.emplace_back(origin, UnitVector(target - origin));
+        }
+        return accuracyCase;
+    }
+
+    AccuracyCase SurfaceCase()
+    {
+        AccuracyCase accuracyCase{"surface", {0.0, -1000.0, 0.0}, 1000.0, {}};
+        const RTType::TVector3<double> center(0.0, -1000.0, 0.0);
+        for (int index = 0; index < batchSize; ++index)
+        {
+            // Points near the top, where the random scene's spheres stand
+            const RTType::TVector3<double> normal = UnitVector(RTType::TVector3<double>(RT::RandomDouble(-0.01, 0.01), 1.0, RT::RandomDouble(-0.01, 0.01)));
+            RTType::TVector3<double> direction = UnitVector(normal + UnitVector(RTType::TVector3<double>::Random(-1.0, 1.0)));
+            if (Dot(direction, normal) < 0.0) direction = -direction;
+            accuracyCase.rays.emplace_back(center + 1000.0 * normal, direction);
+        }
+        return accuracyCase;
+    }
+
+    template <typename T, typename Intersect>
+    void MeasureAccuracy(RTBench::Harness& harness, const AccuracyCase& accuracyCase, const std::string& name, Intersect&& intersect)
+    {
+        const RTType::TVector3<T> center(static_cast<T>(accuracyCase.center[0]), static_cast<T>(accuracyCase.center[1]), static_cast<T>(accuracyCase.center[2]));
+        const auto radius = static_cast<T>(accuracyCase.radius);
+
+        std::vector<RTType::TRay<T>> rays;
+        rays.reserve(accuracyCase.rays.size());
+        for (const auto& [origin, direction] : accuracyCase.rays)
+        {
+            rays.emplace_back(RTType::TVector3<T>(static_cast<T>(origin.x), static_cast<T>(origin.y), static_cast<T>(origin.z)),
+                RTType::TVector3<T>(static_cast<T>(direction.x), static_cast<T>(direction.y), static_cast<T>(direction.z)));
+        }
+
+        RTBench::Result& result = harness.Measure("precision", accuracyCase.name + "/" + name, rays.size(), [&]()
+        {
+            double checksum = 0.0;
+            for (const RTType::TRay<T>& ray : rays)
+            {
+                T t{};
+                if (intersect(ray, center, radius, static_cast<T>(tMin), std::numeric_limits<T>::infinity(), t)) checksum += t;
+            }
+            return checksum;
+        });
+
+        // Rays are compared in the precision they were traced in, so rounding of the ray itself is not counted
+        double maxRelativeError = 0.0;
+        size_t wrongHits = 0;
+        for (const RTType::TRay<T>& ray : rays)
+        {
+            const double origin[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+            const double direction[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+            const double centerValues[3] = {center.x, center.y, center.z};
+
+            long double expected = 0;
+            const bool isExpectedHit = ReferenceIntersection(origin, direction, centerValues, radius, expected);
+            T t{};
+            const bool isHit = intersect(ray, center, radius, static_cast<T>(tMin), std::numeric_limits<T>::infinity(), t);
+            if (isHit != isExpectedHit)
+            {
+                ++wrongHits;
+            }
+            else if (isHit)
+            {
+                maxRelativeError = std::max(maxRelativeError, static_cast<double>(std::fabs((t - expected) / expected)));
+            }
+        }
+        result.AddMetric("max_relative_error", maxRelativeError);
+        result.AddMetric("wrong_hits", static_cast<double>(wrongHits));
+    }
+
+    template <typename T>
+    void MeasurePrecision(RTBench::Harness& harness, const AccuracyCase& accuracyCase, const char* typeName)
+    {
+        MeasureAccuracy<T>(harness, accuracyCase, std::string("textbook<") + typeName + ">", IntersectSphereTextbook<T>);
+        MeasureAccuracy<T>(harness, accuracyCase, std::string("IntersectSphere<") + typeName + ">", RTObject::IntersectSphere<T>);
+    }
+
+    template <typename T>
+    void VectorPrecision(RTBench::Harness& harness, const char* typeName)
+    {
+        std::vector<RTType::TVector3<T>> a(batchSize), b(batchSize);
+        for (int index = 0; index < batchSize; ++index)
+        {
+            a[index] = RTType::TVector3<T>::Random(-1, 1);
+            b[index] = RTType::TVector3<T>::Random(-1, 1);
+        }
+
+        // Mix of the operations one bounce does
+        harness.Measure("precision", std::string("vector<") + typeName + ">", batchSize, [&]()
+        {
+            RTType::TVector3<T> sum;
+            for (int index = 0; index < batchSize; ++index)
+            {
+                sum += UnitVector(Cross(a[index], b[index]) + a[index] * Dot(a[index], b[index]));
+            }
+            return static_cast<double>(sum.x + sum.y + sum.z);
+        });
+    }
+}
+
+namespace RTBench
+{
+    void RunPrecisionBenchmarks(Harness& harness)
+    {
+        RT::ThreadRandom().Seed(RT::seed, 2);
+
+        VectorPrecision<float>(harness, "float");
+        VectorPrecision<double>(harness, "double");
+
+        for (const AccuracyCase& accuracyCase : {FarCase(), SurfaceCase()})
+        {
+            MeasurePrecision<float>(harness, accuracyCase, "float");
+            MeasurePrecision<double>(harness, accuracyCase, "double");
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include "Benchmarks.h"
+
+#include "Common/Common.h"
+#include "Common/Settings.h"
+#include "Objects/RTObjects.h"
+#include "Render/RTRender.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace
+{
+    struct Curve
+    {
+        // Samples per pixel and display RMSE, by increasing sample count
+        std::vector<std::pair<int, double>> points;
+
+        // Samples per pixel at which the error falls to target, interpolated on log-log axes between the measured
+        // points; past the last point the slope of the last two carries on
+        [[nodiscard]] double SamplesFor(const double target) const
+        {
+            if (points.front().second <= target) return points.front().first;
+            for (size_t index = 1; index < points.size(); ++index)
+            {
+                if (points[index].second <= target || index + 1 == points.size())
+                {
+                    const double x0 = std::log(static_cast<double>(points[index - 1].first));
+                    const double x1 = std::log(static_cast<double>(points[index].first));
+                    const double y0 = std::log(points[index - 1].second);
+                    const double y1 = std::log(points[index].second);
+                    if (y1 >= y0) return points[index].first;
+                    return std::exp(x0 + (std::log(target) - y0) * (x1 - x0) / (y1 - y0));
+                }
+            }
+            return points.back().first;
+        }
+    };
+}
+
+namespace RTBench
+{
+    void RunSamplerBenchmarks(Harness& harness, const SamplerOptions& options)
+    {
+        RT::Settings settings;
+        settings.imageWidth = options.width;
+        settings.imageHeight = options.height;
+        settings.sceneExtent = options.sceneExtent;
+        settings.threadCount = options.threadCount;
+
+        RTOScene scene;
+        RTOCameraView view;
+        RTObject::MakeScene(settings, scene, view, std::cerr);
+        const RTTBVH world = scene.BuildHierarchy(settings.sphereGroupSize);
+        const RTOCamera camera = view.ToCamera(settings.AspectRatio());
+        RTRWorkerPool pool(settings.threadCount);
+        RTRFrameRenderer renderer(settings, camera, world, pool);
+
+        // Independent numbers converge to the same image as the others, without sharing their structure. Random
+        // images of fewer samples are prefixes of the reference, which lowers their error by the reference's own.
+        settings.sampler = RT::SamplerType::Random;
+        settings.samplesPerPixel = options.referenceSamplesPerPixel;
+        RTRFrameBuffer reference(settings.imageWidth, settings.imageHeight);
+        renderer.RenderRows(reference, 0, settings.imageHeight);
+
+        const auto render = [&](const RT::SamplerType sampler, const int samplesPerPixel, double& outSeconds)
+        {
+            settings.sampler = sampler;
+            settings.samplesPerPixel = samplesPerPixel;
+            RTRFrameBuffer image(settings.imageWidth, settings.imageHeight);
+            outSeconds = renderer.RenderRows(image, 0, settings.imageHeight).wallSeconds;
+            return DisplayRmse(image, reference);
+        };
+
+        // The blue-noise mask is built on first use, keep that out of the timings
+        RT::Detail::BlueNoise(0, 0);
+
+        double seconds = 0.0;
+        const double matchedRmse = render(RT::SamplerType::Random, options.matchedSamplesPerPixel, seconds);
+        const auto pixelCount = static_cast<double>(settings.PixelCount());
+        const std::string size = std::to_string(settings.imageWidth) + "x" + std::to_string(settings.imageHeight);
+
+        for (const RT::SamplerType sampler : {RT::SamplerType::Random, RT::SamplerType::Sobol, RT::SamplerType::BlueNoise})
+        {
+            Curve curve;
+            for (const int samplesPerPixel : options.samplesPerPixel)
+            {
+                const double rmse = render(sampler, samplesPerPixel, seconds);
+                curve.points.emplace_back(samplesPerPixel, rmse);
+
+                const double samples = pixelCount * samplesPerPixel;
+                Result result;
+                result.group = "sampler";
+                result.name = std::string(RT::SamplerTypeName(sampler)) + "/" + size + "/" + std::to_string(samplesPerPixel) + "spp";
+                result.operations = static_cast<uint64_t>(samples);
+                result.nsPerOperation = seconds * 1e9 / samples;
+                result.operationsPerSecond = samples / seconds;
+                result.AddMetric("rmse", rmse);
+                // Error times the square root of the sample count, constant for independent samples
+                result.AddMetric("rmse_sqrt_spp", rmse * std::sqrt(static_cast<double>(samplesPerPixel)));
+                harness.Add(std::move(result));
+            }
+
+            const double matchingSamples = curve.SamplesFor(matchedRmse);
+            Result result;
+            result.group = "sampler";
+            result.name = std::string(RT::SamplerTypeName(sampler)) + "/" + size + "/matches random " + std::to_string(options.matchedSamplesPerPixel) + "spp";
+            result.operations = 1;
+            result.AddMetric("target_rmse", matchedRmse);
+            result.AddMetric("spp", matchingSamples);
+            result.AddMetric("fraction", matchingSamples / options.matchedSamplesPerPixel);
+            harness.Add(std::move(result));
+        }
+    }
+}
@@ -0,0 +1,140 @@
+#include "Benchmarks.h"
+
+#include "Common/Common.h"
+#include "Common/MappedFile.h"
+#include "Objects/RTObjects.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double MillisecondsSince(const Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /*
+     * Time from nothing to the first traced ray: get the scene, build the BVH over its sphere groups as the
+     * renderer does, and trace one camera ray through the middle of the image. Then the memory the scene and BVH
+     * hold, and the rate of camera rays on a grid over the image.
+     */
+    RTBench::Result TimeToFirstRay(const std::string& name, const std::function<bool(RTOScene&, RTOCameraView&)>& makeScene)
+    {
+        RTBench::Result result;
+        result.group = "scene";
+        result.name = name;
+
+        const Clock::time_point start = Clock::now();
+        RTOScene scene;
+        RTOCameraView view;
+        if (!makeScene(scene, view)) return result;
+        const double sceneMilliseconds = MillisecondsSince(start);
+
+        const Clock::time_point buildStart = Clock::now();
+        const RTTBVH world = scene.BuildHierarchy(RT::sphereGroupSize);
+        const double buildMilliseconds = MillisecondsSince(buildStart);
+
+        const Clock::time_point rayStart = Clock::now();
+        const RTOCamera camera = view.ToCamera(RT::aspectRatio);
+        RTTHitResult hitResult;
+        const bool isHit = world.Hit(camera.GetRay(0.5, 0.5), 0.001, RT::infinity, hitResult);
+        const double rayMilliseconds = MillisecondsSince(rayStart);
+        const double totalMilliseconds = MillisecondsSince(start);
+
+        constexpr int gridWidth = 160;
+        constexpr int gridHeight = 90;
+        int hitCount = 0;
+        const Clock::time_point gridStart = Clock::now();
+        for (int y = 0; y < gridHeight; ++y)
+        {
+            for (int x = 0; x < gridWidth; ++x)
+            {
+                const RTTRay ray = camera.GetRay((x + 0.5) / gridWidth, (y + 0.5) / gridHeight);
+                if (world.Hit(ray, 0.001, RT::infinity, hitResult)) ++hitCount;
+            }
+        }
+        const double gridMilliseconds = MillisecondsSince(gridStart);
+
+        result.operations = scene.RenderedSphereCount();
+        result.nsPerOperation = totalMilliseconds * 1e6 / static_cast<double>(result.operations);
+        result.operationsPerSecond = static_cast<double>(result.operations) / (totalMilliseconds / 1e3);
+        result.AddMetric("spheres", static_cast<double>(scene.RenderedSphereCount()));
+        result.AddMetric("instances", static_cast<double>(scene.instances.size()));
+        result.AddMetric("memory_mib", static_cast<double>(scene.MemorySize() + world.MemorySize()) / (1 << 20));
+        result.AddMetric("scene_ms", sceneMilliseconds);
+        result.AddMetric("bvh_ms", buildMilliseconds);
+        result.AddMetric("first_ray_ms", rayMilliseconds);
+        result.AddMetric("time_to_first_ray_ms", totalMilliseconds);
+        result.AddMetric("first_ray_hit", isHit ? 1.0 : 0.0);
+        result.AddMetric("camera_mrays_per_s", gridWidth * gridHeight / (gridMilliseconds * 1e3));
+        result.AddMetric("camera_hits", hitCount);
+        return result;
+    }
+}
+
+namespace RTBench
+{
+    void RunSceneBenchmarks(Harness& harness, const SceneOptions& options)
+    {
+        for (const int extent : options.sceneExtents)
+        {
+            const std::string path = options.directory + "/bench_scene_" + std::to_string(extent) + ".rts";
+
+            // The generator as the renderer runs it
+            auto generate = [&](RTOScene& scene, RTOCameraView& view)
+            {
+                RT::ThreadRandom().Seed(RT::seed, 0);
+                scene = RTObject::RandomScene(extent);
+                view = RTObject::RandomSceneView();
+                return true;
+            };
+            {
+                RTOScene scene;
+                RTOCameraView view;
+                generate(scene, view);
+                if (!RTObject::SaveScene(path, scene, view, std::cerr)) continue;
+            }
+            harness.Add(TimeToFirstRay("generate/extent " + std::to_string(extent), generate));
+
+            // Straight after saving, the file is in the page cache, as a scene read a second time would be
+            Result loaded = TimeToFirstRay("load/extent " + std::to_string(extent), [&](RTOScene& scene, RTOCameraView& view)
+            {
+                return RTObject::LoadScene(path, scene, view, std::cerr);
+            });
+            if (loaded.operations > 0)
+            {
+                const RT::MappedFile file(path);
+                loaded.AddMetric("file_mib", static_cast<double>(file.Size()) / (1 << 20));
+                harness.Add(std::move(loaded));
+            }
+            std::remove(path.c_str());
+        }
+
+        // The same number of small spheres, one cluster repeated as instances against every sphere on its own
+        for (const int extent : options.instancedExtents)
+        {
+            const std::string name = "extent " + std::to_string(extent) + "/cluster " + std::to_string(options.clusterExtent);
+            harness.Add(TimeToFirstRay("instanced/" + name, [&](RTOScene& scene, RTOCameraView& view)
+            {
+                RT::ThreadRandom().Seed(RT::seed, 0);
+                scene = RTObject::InstancedRandomScene(extent, options.clusterExtent, RT::sphereGroupSize);
+                view = RTObject::RandomSceneView();
+                return true;
+            }));
+            if (extent > options.maxFlatExtent) continue;
+            harness.Add(TimeToFirstRay("flat/" + name, [&](RTOScene& scene, RTOCameraView& view)
+            {
+                RT::ThreadRandom().Seed(RT::seed, 0);
+                scene = RTObject::RandomScene(extent);
+                view = RTObject::RandomSceneView();
+                return true;
+            }));
+        }
+    }
+}
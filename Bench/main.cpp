@@ -0,0 +1,171 @@
+#include "Benchmarks.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+	void PrintUsage(const char* programName) {
+		std::cerr << "Usage: " << programName << " [options]\n"
+			<< "  --micro               microbenchmarks only\n"
+			<< "  --precision           float against double benchmarks only\n"
+			<< "  --frames              full-frame benchmarks only\n"
+			<< "  --scenes              scene generation against scene file loading only\n"
+			<< "  --animation           animation mode against per-frame setup only\n"
+			<< "  --denoise             denoiser time and error against a reference at several sample counts only\n"
+			<< "  --samplers            error against sample count of the random, Sobol and blue-noise samplers only\n"
+			<< "  --compare REF IMAGE   difference of two PFM images instead of benchmarks\n"
+			<< "  --min-time S          seconds per microbenchmark run (0.2)\n"
+			<< "  --resolutions LIST    frame sizes, for example 320x180,1280x720\n"
+			<< "  --threads LIST        thread counts, for example 1,2,4,8 (powers of two up to the hardware threads)\n"
+			<< "  --no-pinning          frames without the runs pinned to CPUs and NUMA nodes\n"
+			<< "  --spp N               samples per pixel of the frames (4)\n"
+			<< "  --scene-extents LIST  random scene extents, for example 11,100,700 (11,100,300)\n"
+			<< "  --animation-frames N  frames of the animation benchmark (8)\n"
+			<< "  --scene-dir PATH      directory for the temporary scene files and frames (.)\n"
+			<< "  --json PATH           write results as JSON\n"
+			<< "  --csv PATH            write results as CSV\n";
+	}
+
+	bool ParseList(const std::string& text, std::vector<int>& values) {
+		std::stringstream stream(text);
+		std::string item;
+		while (std::getline(stream, item, ',')) {
+			const int value = std::atoi(item.c_str());
+			if (value <= 0) return false;
+			values.push_back(value);
+		}
+		return !values.empty();
+	}
+
+	bool ParseResolutions(const std::string& text, std::vector<std::pair<int, int>>& resolutions) {
+		std::stringstream stream(text);
+		std::string item;
+		while (std::getline(stream, item, ',')) {
+			int width = 0, height = 0;
+			if (std::sscanf(item.c_str(), "%dx%d", &width, &height) != 2 || width < 2 || height < 2) return false;
+			resolutions.emplace_back(width, height);
+		}
+		return !resolutions.empty();
+	}
+}
+
+int main(int argc, char* argv[]) {
+	bool isMicroEnabled = false;
+	bool isPrecisionEnabled = false;
+	bool isFrameEnabled = false;
+	bool isSceneEnabled = false;
+	bool isAnimationEnabled = false;
+	bool isDenoiseEnabled = false;
+	bool isSamplerEnabled = false;
+	std::string referencePath, comparedPath;
+	double minSeconds = 0.2;
+	std::string jsonPath, csvPath;
+	RTBench::FrameOptions frameOptions;
+	RTBench::SceneOptions sceneOptions;
+	RTBench::AnimationOptions animationOptions;
+	RTBench::DenoiseOptions denoiseOptions;
+	RTBench::SamplerOptions samplerOptions;
+
+	for (int index = 1; index < argc; ++index) {
+		const std::string flag = argv[index];
+		const bool hasValue = index + 1 < argc;
+		bool isValid = true;
+		if (flag == "--micro") {
+			isMicroEnabled = true;
+		} else if (flag == "--precision") {
+			isPrecisionEnabled = true;
+		} else if (flag == "--frames") {
+			isFrameEnabled = true;
+		} else if (flag == "--scenes") {
+			isSceneEnabled = true;
+		} else if (flag == "--animation") {
+			isAnimationEnabled = true;
+		} else if (flag == "--denoise") {
+			isDenoiseEnabled = true;
+		} else if (flag == "--samplers") {
+			isSamplerEnabled = true;
+		} else if (flag == "--compare" && index + 2 < argc) {
+			referencePath = argv[++index];
+			comparedPath = argv[++index];
+		} else if (flag == "--min-time" && hasValue) {
+			minSeconds = std::atof(argv[++index]);
+			isValid = minSeconds > 0.0;
+		} else if (flag == "--resolutions" && hasValue) {
+			frameOptions.resolutions.clear();
+			isValid = ParseResolutions(argv[++index], frameOptions.resolutions);
+		} else if (flag == "--threads" && hasValue) {
+			isValid = ParseList(argv[++index], frameOptions.threadCounts);
+		} else if (flag == "--no-pinning") {
+			frameOptions.comparePinning = false;
+		} else if (flag == "--spp" && hasValue) {
+			frameOptions.samplesPerPixel = std::atoi(argv[++index]);
+			isValid = frameOptions.samplesPerPixel > 0;
+		} else if (flag == "--scene-extents" && hasValue) {
+			sceneOptions.sceneExtents.clear();
+			isValid = ParseList(argv[++index], sceneOptions.sceneExtents);
+		} else if (flag == "--animation-frames" && hasValue) {
+			animationOptions.frameCount = std::atoi(argv[++index]);
+			isValid = animationOptions.frameCount > 0;
+		} else if (flag == "--scene-dir" && hasValue) {
+			sceneOptions.directory = argv[++index];
+		} else if (flag == "--json" && hasValue) {
+			jsonPath = argv[++index];
+		} else if (flag == "--csv" && hasValue) {
+			csvPath = argv[++index];
+		} else {
+			isValid = false;
+		}
+
+		if (!isValid) {
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	// Without a selection everything runs
+	if (!isMicroEnabled && !isPrecisionEnabled && !isFrameEnabled && !isSceneEnabled && !isAnimationEnabled && !isDenoiseEnabled && !isSamplerEnabled
+		&& referencePath.empty()) {
+		isMicroEnabled = isPrecisionEnabled = isFrameEnabled = isSceneEnabled = isAnimationEnabled = isDenoiseEnabled = isSamplerEnabled = true;
+	}
+	animationOptions.samplesPerPixel = frameOptions.samplesPerPixel;
+	animationOptions.directory = sceneOptions.directory;
+
+	RTBench::Harness harness(minSeconds);
+	if (!referencePath.empty() && !RTBench::CompareImages(harness, referencePath, comparedPath, std::cerr)) {
+		return 1;
+	}
+	if (isMicroEnabled) {
+		RTBench::RunMicrobenchmarks(harness);
+	}
+	if (isPrecisionEnabled) {
+		RTBench::RunPrecisionBenchmarks(harness);
+	}
+	if (isFrameEnabled) {
+		RTBench::RunFrameBenchmarks(harness, frameOptions);
+	}
+	if (isSceneEnabled) {
+		RTBench::RunSceneBenchmarks(harness, sceneOptions);
+	}
+	if (isAnimationEnabled) {
+		RTBench::RunAnimationBenchmarks(harness, animationOptions);
+	}
+	if (isDenoiseEnabled) {
+		RTBench::RunDenoiseBenchmarks(harness, denoiseOptions);
+	}
+	if (isSamplerEnabled) {
+		RTBench::RunSamplerBenchmarks(harness, samplerOptions);
+	}
+	harness.Print(std::cout);
+
+	if (!jsonPath.empty() && !harness.WriteJson(jsonPath)) {
+		std::cerr << "Failed to write " << jsonPath << ".\n";
+		return 1;
+	}
+	if (!csvPath.empty() && !harness.WriteCsv(csvPath)) {
+		std::cerr << "Failed to write " << csvPath << ".\n";
+		return 1;
+	}
+}
@@ -1,10 +1,13 @@
 ﻿#pragma once
 
 #include "Config.h"
+#include "Random.h"
+#include "Sampler.h"
 
 // Shared standard headers
+#include <chrono>
+#include <cmath>
 #include <limits>
-#include <random>
 
 namespace RT
 {
@@ -21,6 +24,11 @@ namespace RT
         return val;
     }
 
+    inline double SecondsSince(const std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
     inline double DegreesToRadians(double degrees)
     {
         return degrees * pi / 180.0;
@@ -28,11 +36,7 @@ namespace RT
 
     inline double RandomDouble()
     {
-        static std::random_device rd;
-        static std::seed_seq ss{ rd(), rd(), rd(), rd(), rd(), rd(), rd(), rd() };
-        static std::mt19937 generator{ ss };
-        static std::uniform_real_distribution<double> distribution(0.0, 1.0);
-        return distribution(generator);
+        return ThreadRandom().NextDouble();
     }
 
     inline double RandomDouble(const double min, const double max)
@@ -1,9 +1,23 @@
 ﻿#pragma once
 
+#include <cstdint>
+
+// Defaults of the render settings, all but the statistics switches can be changed from the command line (see Settings.h)
 namespace RT
 {
     // Threads
-    constexpr int threadCount = 90;
+    // 0 uses one worker per CPU this process may run on
+    constexpr int threadCount = 0;
+    // Pin workers to CPUs, one per physical core first and NUMA nodes in turn, and place image rows on their nodes
+    constexpr bool pinThreads = false;
+    // More workers than CPUs are cut down to one per CPU unless this is set
+    constexpr bool allowOversubscription = false;
+
+    // Tiles
+    // Rows that hit glass or metal cost far more than sky rows, idle workers steal tiles from busy ones
+    constexpr int tileWidth = 32;
+    constexpr int tileHeight = 32;
+    constexpr bool workStealing = true;
     
     // Image
     constexpr double aspectRatio = 16.0 / 9.0;
@@ -11,4 +25,102 @@ namespace RT
     constexpr int imageHeight = static_cast<int>(imageWidth / aspectRatio);
     constexpr int samplesPerPixel = 32;
     constexpr int maxDepth = 12;
+    // Paths longer than minDepth bounces are ended at random by Russian roulette, minDepth >= maxDepth disables it
+    constexpr int minDepth = 3;
+
+    // Adaptive sampling
+    // Pixels take minSamplesPerPixel to samplesPerPixel samples and stop once the standard error of their displayed
+    // luminance, and that of their neighbours, is below targetError (0..1 scale); depth-first mode only
+    constexpr bool adaptiveSampling = false;
+    constexpr int minSamplesPerPixel = 16;
+    constexpr double targetError = 0.01;
+    // Heat map of samples per pixel, written next to the image in adaptive mode, "" writes none
+    constexpr const char* sampleHeatmapPath = "samples.png";
+
+    // Render mode
+    // Wavefront traces batches of paths bounce by bounce and shades hits sorted by material type
+    constexpr bool wavefront = false;
+    constexpr int wavefrontBatchSize = 4096;
+    // Above 0, camera rays are shaded by ambient occlusion instead of path tracing: the share of this many cosine-
+    // weighted rays from the first hit that meet nothing within ambientOcclusionDistance. Depth-first mode only
+    constexpr int ambientOcclusionRays = 0;
+    constexpr double ambientOcclusionDistance = 1.0;
+
+    // Framebuffer
+    // Rows of the image held in memory, rounded up to whole tile rows. Each band is written out and its memory reused
+    // before the next one is rendered, so very large images need memory for one band only; 0 holds the whole image
+    constexpr int bandRows = 0;
+
+    // Checkpoints
+    // With a checkpoint file, samples are taken in passes of passSamples per pixel into a radiance buffer that is saved
+    // every checkpointSeconds and after the last pass; a render started again resumes from its checkpoint
+    constexpr int passSamples = 4;
+    constexpr double checkpointSeconds = 300.0;
+
+    // Denoising
+    // The image is filtered after tracing by an edge-avoiding wavelet filter guided by the albedo, normal and depth the
+    // camera rays see; each of the denoiseIterations passes reaches twice as far. Depth-first rendering only
+    constexpr bool denoise = false;
+    constexpr int denoiseIterations = 5;
+
+    // Preview
+    // A preview render publishes coarse images first: previewLevels levels of one sample per pixel, the first at
+    // 1 / 2^previewLevels of the image size and each twice the size of the last, then full-size passes that double the
+    // samples per pixel, every one written over the previous image
+    constexpr int previewLevels = 4;
+
+    // Output
+    // Format follows the extension: .png, .pfm (linear float) or binary .ppm; "-" writes binary PPM to standard output
+    constexpr const char* outputPath = "image.png";
+
+    // Random
+    // Same seed gives the same scene and a bit-identical image for any thread count
+    constexpr uint64_t seed = 2023;
+    // Numbers of the pixel, lens and bounce samples of every path (see Sampler.h): Owen-scrambled Sobol points
+    // scrambled anew for every pixel, the same points shifted by a blue-noise mask so the error of neighbouring
+    // pixels differs, or independent PCG32 numbers
+    enum class SamplerType
+    {
+        Random,
+        Sobol,
+        BlueNoise
+    };
+    constexpr SamplerType sampler = SamplerType::Sobol;
+
+    // Scene
+    // Random small spheres are placed on a (2 * sceneExtent)^2 grid
+    constexpr int sceneExtent = 11;
+    // Above 0, the small spheres are one cluster on a (2 * clusterExtent)^2 grid repeated as instances over the grid
+    constexpr int clusterExtent = 0;
+
+    // Acceleration
+    // Spheres in one BVH leaf are tested together by the SIMD kernel, 1 keeps one sphere per leaf primitive
+    constexpr int sphereGroupSize = 8;
+
+    // Precision
+    // Scalar of vectors, rays, bounds and intersections. Build with RT_SINGLE_PRECISION=1 (CMake option
+    // RT_SINGLE_PRECISION=ON) to trace in float; settings, statistics and the framebuffer do not change
+#ifndef RT_SINGLE_PRECISION
+#define RT_SINGLE_PRECISION 0
+#endif
+#if RT_SINGLE_PRECISION
+    using Real = float;
+#else
+    using Real = double;
+#endif
+    // Build with RT_SIMD_VECTOR3=1 (CMake option RT_SIMD_VECTOR3=ON) to pad vectors to four lanes and do their arithmetic
+    // in one SSE register for float, or one AVX2 register for double when the compiler targets AVX2
+#ifndef RT_SIMD_VECTOR3
+#define RT_SIMD_VECTOR3 0
+#endif
+
+    // Statistics
+    // Ray, hit and path counters with a summary after each frame; they cost a few increments per ray.
+    // Build with RT_RENDER_STATS=0 (CMake option RT_RENDER_STATS=OFF) to compile them out
+#ifndef RT_RENDER_STATS
+#define RT_RENDER_STATS 1
+#endif
+    constexpr bool renderStats = RT_RENDER_STATS != 0;
+    // Nodes and primitives visited per ray
+    constexpr bool bvhStats = false;
 }
\ No newline at end of file
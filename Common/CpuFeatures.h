@@ -0,0 +1,65 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RT_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// Functions using instructions beyond the build baseline are marked with the target they need,
+// so one binary carries every kernel and picks one at run time
+#if defined(RT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define RT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define RT_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define RT_TARGET_AVX2
+#define RT_TARGET_SSE2
+#endif
+
+namespace RT
+{
+    struct CpuFeatures
+    {
+        bool sse2 = false;
+        bool avx2 = false;
+    };
+
+    inline CpuFeatures DetectCpuFeatures()
+    {
+        CpuFeatures features;
+#if defined(RT_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        features.sse2 = (info[3] & (1 << 26)) != 0;
+        const bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+        const bool hasAvx = (info[2] & (1 << 28)) != 0;
+        const bool hasFma = (info[2] & (1 << 12)) != 0;
+
+        // AVX registers are only usable when the OS saves the upper halves on context switches
+        const bool isYmmEnabled = hasOsxsave && (_xgetbv(0) & 0x6) == 0x6;
+        if (maxLeaf >= 7 && hasAvx && hasFma && isYmmEnabled)
+        {
+            __cpuidex(info, 7, 0);
+            features.avx2 = (info[1] & (1 << 5)) != 0;
+        }
+#else
+        __builtin_cpu_init();
+        features.sse2 = __builtin_cpu_supports("sse2");
+        features.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#endif
+        return features;
+    }
+
+    // Detected once per process
+    inline const CpuFeatures& GetCpuFeatures()
+    {
+        static const CpuFeatures features = DetectCpuFeatures();
+        return features;
+    }
+}
@@ -0,0 +1,168 @@
+#include "CpuTopology.h"
+
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    // Every hardware thread its own core, all of them on one node
+    RT::CpuTopology FlatTopology()
+    {
+        RT::CpuTopology topology;
+        const int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int id = 0; id < count; ++id)
+        {
+            topology.cpus.push_back({id, id, 0, 0});
+        }
+        topology.coreCount = count;
+        return topology;
+    }
+
+#ifdef __linux__
+    bool ReadInteger(const std::string& path, int& value)
+    {
+        std::ifstream file(path);
+        return static_cast<bool>(file >> value);
+    }
+
+    // CPU list as sysfs writes it, for example "0-3,8-11"
+    std::vector<int> ParseCpuList(const std::string& text)
+    {
+        std::vector<int> ids;
+        std::stringstream stream(text);
+        std::string range;
+        while (std::getline(stream, range, ','))
+        {
+            char* end = nullptr;
+            const long first = std::strtol(range.c_str(), &end, 10);
+            if (end == range.c_str()) continue;
+            const long last = *end == '-' ? std::strtol(end + 1, nullptr, 10) : first;
+            for (long id = first; id <= last; ++id)
+            {
+                ids.push_back(static_cast<int>(id));
+            }
+        }
+        return ids;
+    }
+
+    bool ReadSysfsTopology(RT::CpuTopology& topology)
+    {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return false;
+
+        // Node of every CPU, from the CPU lists of the nodes; without them, as on kernels built without NUMA, one node
+        std::map<int, int> cpuNodes;
+        for (int node = 0;; ++node)
+        {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file) break;
+            std::string list;
+            std::getline(file, list);
+            for (const int id : ParseCpuList(list))
+            {
+                cpuNodes[id] = node;
+            }
+        }
+
+        std::map<std::pair<int, int>, int> coreIndices;
+        std::map<int, int> nodeIndices;
+        for (int id = 0; id < CPU_SETSIZE; ++id)
+        {
+            if (!CPU_ISSET(id, &allowed)) continue;
+
+            const std::string directory = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+            int core = 0, package = 0;
+            if (!ReadInteger(directory + "core_id", core) || !ReadInteger(directory + "physical_package_id", package)) return false;
+
+            const auto nodeEntry = cpuNodes.find(id);
+            const int systemNode = nodeEntry == cpuNodes.end() ? 0 : nodeEntry->second;
+            const int coreIndex = coreIndices.emplace(std::make_pair(package, core), static_cast<int>(coreIndices.size())).first->second;
+            const int nodeIndex = nodeIndices.emplace(systemNode, static_cast<int>(nodeIndices.size())).first->second;
+            topology.cpus.push_back({id, coreIndex, package, nodeIndex});
+        }
+        if (topology.cpus.empty()) return false;
+
+        topology.coreCount = static_cast<int>(coreIndices.size());
+        topology.nodeCount = static_cast<int>(nodeIndices.size());
+        topology.isFromSysfs = true;
+        return true;
+    }
+#endif
+}
+
+namespace RT
+{
+    std::vector<int> CpuTopology::PinningOrder() const
+    {
+        // Rank of every CPU among the threads of its core: 0 for the first, 1 for its SMT sibling and so on
+        std::vector<int> ranks(cpus.size());
+        std::map<int, int> coreThreads;
+        for (size_t index = 0; index < cpus.size(); ++index)
+        {
+            ranks[index] = coreThreads[cpus[index].core]++;
+        }
+
+        // Per round of ranks, the CPUs of every node in id order, then the nodes dealt in turn
+        std::vector<int> order;
+        order.reserve(cpus.size());
+        for (int rank = 0; order.size() < cpus.size(); ++rank)
+        {
+            std::vector<std::vector<int>> nodeCpus(static_cast<size_t>(nodeCount));
+            for (size_t index = 0; index < cpus.size(); ++index)
+            {
+                if (ranks[index] == rank) nodeCpus[static_cast<size_t>(cpus[index].node)].push_back(static_cast<int>(index));
+            }
+            for (size_t position = 0;; ++position)
+            {
+                bool isAnyLeft = false;
+                for (const std::vector<int>& list : nodeCpus)
+                {
+                    if (position >= list.size()) continue;
+                    order.push_back(list[position]);
+                    isAnyLeft = true;
+                }
+                if (!isAnyLeft) break;
+            }
+        }
+        return order;
+    }
+
+    const CpuTopology& SystemTopology()
+    {
+        static const CpuTopology topology = []()
+        {
+#ifdef __linux__
+            CpuTopology sysfsTopology;
+            if (ReadSysfsTopology(sysfsTopology)) return sysfsTopology;
+#endif
+            return FlatTopology();
+        }();
+        return topology;
+    }
+
+    bool PinCurrentThread(const int cpuId)
+    {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpuId, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpuId;
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+namespace RT
+{
+    /*
+     * CPUs this process may run on, with the physical core, package and NUMA node of each. On Linux they come from
+     * the affinity mask and sysfs (/sys/devices/system/cpu and /sys/devices/system/node), so a container or taskset
+     * limit is seen; elsewhere, or without sysfs, every hardware thread counts as its own core of a single node.
+     */
+    struct CpuTopology
+    {
+        struct Cpu
+        {
+            int id{};
+            // Cores are numbered from 0 over all packages, SMT siblings share one
+            int core{};
+            int package{};
+            // Index into the nodes this process has CPUs on, from 0
+            int node{};
+        };
+
+        // Sorted by id
+        std::vector<Cpu> cpus;
+        int coreCount = 0;
+        int nodeCount = 1;
+        bool isFromSysfs = false;
+
+        /*
+         * Indices into cpus in the order workers take them: one CPU of every core first, then the second threads of
+         * the cores, and within each round the nodes in turn, so a few workers spread over every node and core.
+         */
+        [[nodiscard]] std::vector<int> PinningOrder() const;
+    };
+
+    // Read once, on first use
+    const CpuTopology& SystemTopology();
+
+    // Restrict the calling thread to one CPU, false where that is not supported
+    bool PinCurrentThread(int cpuId);
+}
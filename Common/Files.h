@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+namespace RT
+{
+    /*
+     * Rename `from` over `to` in one step: a reader of `to` sees the old file or the new one, never part of either.
+     * On Windows the move is on the disk when it returns. False when the rename failed, `to` is then left as it was.
+     */
+    bool ReplaceFile(const std::string& from, const std::string& to);
+}
@@ -0,0 +1,80 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace RT
+{
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path)
+    {
+        const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        fileHandle = file;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return;
+
+        const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) return;
+        mappingHandle = mapping;
+
+        data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (data != nullptr) size = static_cast<size_t>(fileSize.QuadPart);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (data != nullptr) UnmapViewOfFile(data);
+        if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+        if (fileHandle != nullptr) CloseHandle(fileHandle);
+    }
+#else
+    MappedFile::MappedFile(const std::string& path)
+    {
+        const int file = open(path.c_str(), O_RDONLY);
+        if (file < 0) return;
+
+        struct stat status{};
+        if (fstat(file, &status) == 0 && status.st_size > 0)
+        {
+            void* mapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapping != MAP_FAILED)
+            {
+                data = static_cast<const uint8_t*>(mapping);
+                size = static_cast<size_t>(status.st_size);
+            }
+        }
+        // The mapping keeps the file contents reachable on its own
+        close(file);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (data != nullptr) munmap(const_cast<uint8_t*>(data), size);
+    }
+#endif
+
+    bool MappedFile::IsOpen() const
+    {
+        return data != nullptr;
+    }
+
+    const uint8_t* MappedFile::Data() const
+    {
+        return data;
+    }
+
+    size_t MappedFile::Size() const
+    {
+        return size;
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace RT
+{
+    /*
+     * Whole file mapped read-only into memory. Pages are read from disk, or taken from the page cache, when they are
+     * first touched, so opening even a large file costs next to nothing. Not open when the file is missing or empty.
+     */
+    class MappedFile
+    {
+    private:
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        [[nodiscard]] bool IsOpen() const;
+        [[nodiscard]] const uint8_t* Data() const;
+        [[nodiscard]] size_t Size() const;
+    };
+}
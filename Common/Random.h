@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+namespace RT
+{
+    // Finalizer of SplitMix64, spreads every input bit over the whole output word
+    inline uint64_t MixBits(uint64_t value)
+    {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ull;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebull;
+        value ^= value >> 31;
+        return value;
+    }
+
+    /*
+     * PCG32 generator (M. E. O'Neill, "PCG: A Family of Simple Fast Space-Efficient Statistically Good
+     * Algorithms for Random Number Generation"). 64-bit LCG state with a permuted 32-bit output.
+     * The increment selects one of 2^63 independent streams.
+     */
+    class Pcg32
+    {
+    private:
+        static constexpr uint64_t multiplier = 6364136223846793005ull;
+
+        uint64_t state = 0x853c49e6748fea9bull;
+        uint64_t increment = 0xda3e39cb94b95bdbull;
+
+    public:
+        Pcg32() = default;
+
+        Pcg32(const uint64_t inSeed, const uint64_t inStream)
+        {
+            Seed(inSeed, inStream);
+        }
+
+        void Seed(const uint64_t inSeed, const uint64_t inStream)
+        {
+            state = 0;
+            increment = (inStream << 1u) | 1u;
+            NextUInt();
+            state += inSeed;
+            NextUInt();
+        }
+
+        uint32_t NextUInt()
+        {
+            const uint64_t oldState = state;
+            state = oldState * multiplier + increment;
+            const auto xorShifted = static_cast<uint32_t>(((oldState >> 18u) ^ oldState) >> 27u);
+            const auto rotation = static_cast<uint32_t>(oldState >> 59u);
+            return (xorShifted >> rotation) | (xorShifted << ((~rotation + 1u) & 31u));
+        }
+
+        // Uniform in [0, 1)
+        double NextDouble()
+        {
+            return NextUInt() * 0x1p-32;
+        }
+    };
+
+    // Generator of the calling thread, no state is shared between threads
+    inline Pcg32& ThreadRandom()
+    {
+        thread_local Pcg32 generator;
+        return generator;
+    }
+}
@@ -0,0 +1,145 @@
+#include "Sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    constexpr int maskSize = 64;
+    constexpr int maskPixelCount = maskSize * maskSize;
+
+    /*
+     * Ranks of a blue-noise mask by void and cluster (Ulichney, "The void-and-cluster method for dither array
+     * generation", 1993). Points are ranked by inserting them, one at a time, into the largest void of the points
+     * before them, measured by a Gaussian energy on the torus, so every prefix of the ranks is evenly spread and the
+     * mask tiles without seams.
+     */
+    class VoidAndCluster
+    {
+    private:
+        std::vector<double> kernel;
+        std::vector<double> energy;
+        std::vector<bool> isSet;
+
+    public:
+        VoidAndCluster()
+            : kernel(maskPixelCount), energy(maskPixelCount, 0.0), isSet(maskPixelCount, false)
+        {
+            constexpr double sigma = 1.5;
+            for (int y = 0; y < maskSize; ++y)
+            {
+                for (int x = 0; x < maskSize; ++x)
+                {
+                    const int dx = std::min(x, maskSize - x);
+                    const int dy = std::min(y, maskSize - y);
+                    kernel[y * maskSize + x] = std::exp(-(dx * dx + dy * dy) / (2.0 * sigma * sigma));
+                }
+            }
+        }
+
+        [[nodiscard]] bool IsSet(const int pixel) const
+        {
+            return isSet[pixel];
+        }
+
+        void Set(const int pixel, const bool value)
+        {
+            isSet[pixel] = value;
+            const double sign = value ? 1.0 : -1.0;
+            const int px = pixel % maskSize;
+            const int py = pixel / maskSize;
+            for (int y = 0; y < maskSize; ++y)
+            {
+                const double* kernelRow = kernel.data() + ((y - py + maskSize) % maskSize) * maskSize;
+                double* energyRow = energy.data() + y * maskSize;
+                for (int x = 0; x < maskSize; ++x)
+                {
+                    energyRow[x] += sign * kernelRow[(x - px + maskSize) % maskSize];
+                }
+            }
+        }
+
+        // Set pixel of the highest energy
+        [[nodiscard]] int TightestCluster() const
+        {
+            int best = -1;
+            for (int pixel = 0; pixel < maskPixelCount; ++pixel)
+            {
+                if (isSet[pixel] && (best < 0 || energy[pixel] > energy[best])) best = pixel;
+            }
+            return best;
+        }
+
+        // Empty pixel of the lowest energy
+        [[nodiscard]] int LargestVoid() const
+        {
+            int best = -1;
+            for (int pixel = 0; pixel < maskPixelCount; ++pixel)
+            {
+                if (!isSet[pixel] && (best < 0 || energy[pixel] < energy[best])) best = pixel;
+            }
+            return best;
+        }
+    };
+
+    std::vector<float> MakeBlueNoiseMask()
+    {
+        // Initial pattern: a tenth of the pixels at random, relaxed until no point moves
+        VoidAndCluster pattern;
+        RT::Pcg32 random(RT::seed, 0x5eed);
+        constexpr int initialCount = maskPixelCount / 10;
+        for (int count = 0; count < initialCount;)
+        {
+            const auto pixel = static_cast<int>(random.NextUInt() % maskPixelCount);
+            if (pattern.IsSet(pixel)) continue;
+            pattern.Set(pixel, true);
+            ++count;
+        }
+        for (int move = 0; move < maskPixelCount; ++move)
+        {
+            const int cluster = pattern.TightestCluster();
+            pattern.Set(cluster, false);
+            const int emptiest = pattern.LargestVoid();
+            pattern.Set(emptiest, true);
+            if (emptiest == cluster) break;
+        }
+
+        std::vector<int> ranks(maskPixelCount, 0);
+
+        // Ranks below the initial points: remove them tightest cluster first
+        VoidAndCluster removal = pattern;
+        for (int rank = initialCount - 1; rank >= 0; --rank)
+        {
+            const int cluster = removal.TightestCluster();
+            removal.Set(cluster, false);
+            ranks[cluster] = rank;
+        }
+
+        // Ranks above: fill the largest void until every pixel is set. The energies of the set and of the empty
+        // pixels add up to the same everywhere, so the largest void of one is the tightest cluster of the other.
+        for (int rank = initialCount; rank < maskPixelCount; ++rank)
+        {
+            const int emptiest = pattern.LargestVoid();
+            pattern.Set(emptiest, true);
+            ranks[emptiest] = rank;
+        }
+
+        std::vector<float> mask(maskPixelCount);
+        for (int pixel = 0; pixel < maskPixelCount; ++pixel)
+        {
+            mask[pixel] = (static_cast<float>(ranks[pixel]) + 0.5f) / maskPixelCount;
+        }
+        return mask;
+    }
+}
+
+namespace RT::Detail
+{
+    double BlueNoise(const uint32_t x, const uint32_t y)
+    {
+        // Built once, on the first sample of the first render that asks for it
+        static const std::vector<float> mask = MakeBlueNoiseMask();
+        return mask[(y % maskSize) * maskSize + x % maskSize];
+    }
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "Config.h"
+#include "Random.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+namespace RT
+{
+    namespace Detail
+    {
+        constexpr uint32_t ReverseBits(uint32_t value)
+        {
+            value = (value << 16u) | (value >> 16u);
+            value = ((value & 0x00ff00ffu) << 8u) | ((value & 0xff00ff00u) >> 8u);
+            value = ((value & 0x0f0f0f0fu) << 4u) | ((value & 0xf0f0f0f0u) >> 4u);
+            value = ((value & 0x33333333u) << 2u) | ((value & 0xccccccccu) >> 2u);
+            value = ((value & 0x55555555u) << 1u) | ((value & 0xaaaaaaaau) >> 1u);
+            return value;
+        }
+
+        // Direction numbers of the second dimension of the Sobol sequence: v[k + 1] = v[k] ^ (v[k] >> 1)
+        constexpr uint32_t SobolSecondDirection(const int bit)
+        {
+            uint32_t direction = 1u << 31u;
+            for (int k = 0; k < bit; ++k) direction ^= direction >> 1u;
+            return direction;
+        }
+
+        // Sums of the direction numbers of every byte value, bits reversed, one table per byte of the index
+        struct SobolSecondTable
+        {
+            uint32_t values[4][256] = {};
+
+            constexpr SobolSecondTable()
+            {
+                for (int byte = 0; byte < 4; ++byte)
+                {
+                    for (int value = 0; value < 256; ++value)
+                    {
+                        for (int bit = 0; bit < 8; ++bit)
+                        {
+                            if (value & (1 << bit)) values[byte][value] ^= ReverseBits(SobolSecondDirection(8 * byte + bit));
+                        }
+                    }
+                }
+            }
+        };
+        inline constexpr SobolSecondTable sobolSecondTable;
+
+        // Second dimension of the Sobol sequence with its bits reversed, a byte of the index at a time
+        inline uint32_t ReversedSobolSecond(const uint32_t index)
+        {
+            return sobolSecondTable.values[0][index & 0xffu] ^ sobolSecondTable.values[1][(index >> 8u) & 0xffu]
+                ^ sobolSecondTable.values[2][(index >> 16u) & 0xffu] ^ sobolSecondTable.values[3][index >> 24u];
+        }
+
+        /*
+         * Owen scrambling by hashing (Burley, "Practical Hash-based Owen Scrambling", 2020): a hash in which every
+         * bit depends only on the bits below it, applied to the reversed bits, flips each bit of the value based on
+         * the bits above it, as a random nested permutation of the elementary intervals does. Points whose bits are
+         * already reversed, as the radical inverse of an index is, go through the hash without reversing them twice.
+         */
+        inline uint32_t ScrambleReversed(uint32_t reversed, const uint32_t seed)
+        {
+            reversed ^= reversed * 0x3d20adeau;
+            reversed += seed;
+            reversed *= (seed >> 16u) | 1u;
+            reversed ^= reversed * 0x05526c56u;
+            reversed ^= reversed * 0x53a22864u;
+            return ReverseBits(reversed);
+        }
+
+        inline uint32_t NestedUniformScramble(const uint32_t value, const uint32_t seed)
+        {
+            return ScrambleReversed(ReverseBits(value), seed);
+        }
+
+        inline double ToUnit(const uint32_t value)
+        {
+            return value * 0x1p-32;
+        }
+
+        // Value in [0, 1) of the blue-noise mask at pixel (x, y), the mask repeats every 64 pixels (see Sampler.cpp)
+        double BlueNoise(uint32_t x, uint32_t y);
+    }
+
+    /*
+     * Numbers of one sample of one pixel. Each number has a dimension: the pixel jitter, the lens and then a block
+     * per bounce, so the same decision of every sample of a pixel draws from the same dimension. With Sobol and
+     * blue noise, the samples of a pixel are points of a (0, 2)-sequence in every pair of dimensions, which covers
+     * the square far more evenly than independent numbers and converges faster. Pairs are decorrelated from each
+     * other by shuffling the sample index and scrambling the points with a hash of their dimension.
+     *  - Sobol scrambles with a hash of the pixel as well, every pixel has its own points and the error is white noise.
+     *  - BlueNoise gives every pixel the same points, shifted modulo 1 by a blue-noise mask (Georgiev and Fajardo,
+     *    "Blue-noise Dithered Sampling", 2016): neighbouring pixels see different points and the error they are left
+     *    with at low sample counts is blue noise, which the eye and the denoiser smooth better.
+     *  - Random draws independent PCG32 numbers, the stream of the sample ignores the dimension.
+     * Every sample is started from the seed, pixel and sample index, so the image does not depend on which thread
+     * takes it. Samplers are small values: a wavefront path carries its own copy between bounces.
+     */
+    class Sampler
+    {
+    public:
+        // Layout of the dimensions of a path
+        static constexpr uint32_t pixelDimension = 0;
+        static constexpr uint32_t lensDimension = 2;
+        static constexpr uint32_t firstBounceDimension = 4;
+        // The material takes up to three numbers of a bounce: a direction and one more, roulette takes the fourth
+        static constexpr uint32_t dimensionsPerBounce = 4;
+        static constexpr uint32_t rouletteOffset = 3;
+
+    private:
+        SamplerType type = SamplerType::Random;
+        uint32_t seed = 0;
+        uint32_t pixelX = 0;
+        uint32_t pixelY = 0;
+        uint32_t pixelSeed = 0;
+        uint32_t sampleIndex = 0;
+        uint32_t dimension = 0;
+        Pcg32 random;
+
+    public:
+        void StartSample(const SamplerType inType, const uint64_t inSeed, const int x, const int y, const int width, const int inSampleIndex)
+        {
+            type = inType;
+            pixelX = static_cast<uint32_t>(x);
+            pixelY = static_cast<uint32_t>(y);
+            sampleIndex = static_cast<uint32_t>(inSampleIndex);
+            dimension = pixelDimension;
+
+            const uint64_t pixelIndex = static_cast<uint64_t>(y) * static_cast<uint64_t>(width) + static_cast<uint64_t>(x);
+            if (type == SamplerType::Random)
+            {
+                random.Seed(MixBits(inSeed ^ MixBits(pixelIndex)), MixBits(sampleIndex ^ (inSeed << 32u)));
+            }
+            seed = static_cast<uint32_t>(MixBits(inSeed));
+            pixelSeed = type == SamplerType::Sobol ? static_cast<uint32_t>(MixBits(inSeed ^ MixBits(pixelIndex + 1))) : seed;
+        }
+
+        void StartBounce(const int depth)
+        {
+            dimension = firstBounceDimension + static_cast<uint32_t>(depth) * dimensionsPerBounce;
+        }
+
+        void StartRoulette(const int depth)
+        {
+            StartBounce(depth);
+            dimension += rouletteOffset;
+        }
+
+        // Uniform in [0, 1), the next dimension
+        double Next1D()
+        {
+            if (type == SamplerType::Random) return random.NextDouble();
+
+            const uint32_t dimensionSeed = DimensionSeed(dimension);
+            const uint32_t index = Detail::NestedUniformScramble(sampleIndex, dimensionSeed);
+            double value = Detail::ToUnit(Detail::ScrambleReversed(index, dimensionSeed ^ 0xa511e9b3u));
+            if (type == SamplerType::BlueNoise) value = ShiftedByMask(value, dimension);
+            ++dimension;
+            return value;
+        }
+
+        // Point uniform in [0, 1)^2, the next two dimensions
+        void Next2D(double& outU, double& outV)
+        {
+            if (type == SamplerType::Random)
+            {
+                outU = random.NextDouble();
+                outV = random.NextDouble();
+                return;
+            }
+
+            const uint32_t dimensionSeed = DimensionSeed(dimension);
+            const uint32_t index = Detail::NestedUniformScramble(sampleIndex, dimensionSeed);
+            // The first dimension is the radical inverse of the index, the reverse of its bits
+            outU = Detail::ToUnit(Detail::ScrambleReversed(index, dimensionSeed ^ 0xa511e9b3u));
+            outV = Detail::ToUnit(Detail::ScrambleReversed(Detail::ReversedSobolSecond(index), dimensionSeed ^ 0x63d83595u));
+            if (type == SamplerType::BlueNoise)
+            {
+                outU = ShiftedByMask(outU, dimension);
+                outV = ShiftedByMask(outV, dimension + 1);
+            }
+            dimension += 2;
+        }
+
+    private:
+        [[nodiscard]] uint32_t DimensionSeed(const uint32_t inDimension) const
+        {
+            return static_cast<uint32_t>(MixBits(pixelSeed ^ (static_cast<uint64_t>(inDimension + 1) << 32u)));
+        }
+
+        // Cranley-Patterson rotation by the mask, read at an offset of its own for every dimension
+        [[nodiscard]] double ShiftedByMask(const double value, const uint32_t inDimension) const
+        {
+            const auto offset = static_cast<uint32_t>(MixBits(seed + inDimension));
+            const double shifted = value + Detail::BlueNoise(pixelX + offset, pixelY + (offset >> 16u));
+            return shifted < 1.0 ? shifted : shifted - 1.0;
+        }
+    };
+
+    inline const char* SamplerTypeName(const SamplerType type)
+    {
+        switch (type)
+        {
+        case SamplerType::Sobol: return "sobol";
+        case SamplerType::BlueNoise: return "bluenoise";
+        default: return "random";
+        }
+    }
+
+    // Sampler type of a name as SamplerTypeName spells it
+    inline bool ParseSamplerType(const std::string& name, SamplerType& outType)
+    {
+        for (const SamplerType type : {SamplerType::Random, SamplerType::Sobol, SamplerType::BlueNoise})
+        {
+            if (name == SamplerTypeName(type))
+            {
+                outType = type;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Sampler of the calling thread, started for each sample by PixelRay
+    inline Sampler& ThreadSampler()
+    {
+        thread_local Sampler sampler;
+        return sampler;
+    }
+
+    inline double SampleDouble()
+    {
+        return ThreadSampler().Next1D();
+    }
+}
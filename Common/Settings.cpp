@@ -0,0 +1,418 @@
+#include "Settings.h"
+
+#include "Sampler.h"
+#include "Socket.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+namespace
+{
+    // Options that take a value, every other option is a switch
+    const std::string valueFlags[] = {
+        "-W", "--width", "-H", "--height", "-s", "--spp", "-d", "--max-depth", "--min-depth", "-t", "--threads", "--seed", "--sampler",
+        "-o", "--output", "-f", "--format", "--tile", "--min-spp", "--target-error", "--heatmap", "--batch", "--ao", "--ao-distance",
+        "--band-rows", "--scene", "--export-scene", "--scene-extent", "--cluster-extent", "--group", "--stats-json",
+        "--listen", "--spawn", "--connect", "--frames", "--camera-path",
+        "--checkpoint", "--checkpoint-interval", "--pass-spp", "--denoise-iterations", "--preview", "--preview-port", "--preview-levels"
+    };
+
+    bool ParseInteger(const char* text, const long long min, const long long max, long long& value)
+    {
+        char* end = nullptr;
+        errno = 0;
+        value = std::strtoll(text, &end, 10);
+        return errno == 0 && end != text && *end == '\0' && value >= min && value <= max;
+    }
+
+    bool ParseUnsigned(const char* text, uint64_t& value)
+    {
+        char* end = nullptr;
+        errno = 0;
+        value = std::strtoull(text, &end, 0);
+        return errno == 0 && end != text && *end == '\0' && text[0] != '-';
+    }
+
+    bool ParseDouble(const char* text, const double min, double& value)
+    {
+        char* end = nullptr;
+        errno = 0;
+        value = std::strtod(text, &end);
+        return errno == 0 && end != text && *end == '\0' && value >= min;
+    }
+
+    // "WxH", for example 1280x720
+    bool ParseSize(const char* text, int& width, int& height)
+    {
+        const char* separator = std::strchr(text, 'x');
+        if (separator == nullptr) return false;
+
+        long long w, h;
+        const std::string widthText(text, separator);
+        if (!ParseInteger(widthText.c_str(), 1, std::numeric_limits<int>::max(), w)) return false;
+        if (!ParseInteger(separator + 1, 1, std::numeric_limits<int>::max(), h)) return false;
+
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        return true;
+    }
+}
+
+namespace RT
+{
+    double Settings::AspectRatio() const
+    {
+        return static_cast<double>(imageWidth) / imageHeight;
+    }
+
+    size_t Settings::PixelCount() const
+    {
+        return static_cast<size_t>(imageWidth) * static_cast<size_t>(imageHeight);
+    }
+
+    int Settings::BandHeight() const
+    {
+        if (bandRows <= 0 || bandRows >= imageHeight) return imageHeight;
+        const int tileRows = (bandRows + tileHeight - 1) / tileHeight;
+        return std::min(imageHeight, tileRows * tileHeight);
+    }
+
+    std::string Settings::FramePath(const int frame) const
+    {
+        if (outputPath == "-") return outputPath;
+
+        std::string number = std::to_string(frame);
+        const size_t hashes = outputPath.find('#');
+        if (hashes != std::string::npos)
+        {
+            const size_t hashCount = std::min(outputPath.find_first_not_of('#', hashes), outputPath.size()) - hashes;
+            if (number.size() < hashCount) number.insert(0, hashCount - number.size(), '0');
+            return outputPath.substr(0, hashes) + number + outputPath.substr(hashes + hashCount);
+        }
+
+        // Only a dot in the file name starts an extension
+        if (number.size() < 4) number.insert(0, 4 - number.size(), '0');
+        const size_t dot = outputPath.find_last_of('.');
+        const size_t slash = outputPath.find_last_of("/\\");
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return outputPath + "_" + number;
+        return outputPath.substr(0, dot) + "_" + number + outputPath.substr(dot);
+    }
+
+    bool Settings::IsCoordinator() const
+    {
+        return coordinatorAddress.empty() && (listenPort >= 0 || spawnWorkers > 0);
+    }
+
+    bool Settings::IsPreview() const
+    {
+        return !previewPath.empty() || previewPort >= 0;
+    }
+
+    CommandLineResult ParseCommandLine(const int argc, const char* const* argv, Settings& settings, std::ostream& errorOut)
+    {
+        constexpr long long intMax = std::numeric_limits<int>::max();
+        bool isWidthSet = false;
+        bool isHeightSet = false;
+
+        for (int index = 1; index < argc; ++index)
+        {
+            const std::string flag = argv[index];
+
+            // Flags without a value
+            if (flag == "-h" || flag == "--help") return CommandLineResult::Help;
+            if (flag == "--wavefront")
+            {
+                settings.wavefront = true;
+                continue;
+            }
+            if (flag == "--adaptive")
+            {
+                settings.adaptiveSampling = true;
+                continue;
+            }
+            if (flag == "--denoise")
+            {
+                settings.denoise = true;
+                continue;
+            }
+            if (flag == "--no-steal")
+            {
+                settings.workStealing = false;
+                continue;
+            }
+            if (flag == "--pin")
+            {
+                settings.pinThreads = true;
+                continue;
+            }
+            if (flag == "--oversubscribe")
+            {
+                settings.allowOversubscription = true;
+                continue;
+            }
+
+            if (std::find(std::begin(valueFlags), std::end(valueFlags), flag) == std::end(valueFlags))
+            {
+                errorOut << "Unknown option " << flag << ".\n";
+                return CommandLineResult::Error;
+            }
+            if (index + 1 >= argc)
+            {
+                errorOut << "Missing value for " << flag << ".\n";
+                return CommandLineResult::Error;
+            }
+            const char* value = argv[++index];
+
+            long long integer = 0;
+            bool isValid = true;
+            if (flag == "-W" || flag == "--width")
+            {
+                isValid = ParseInteger(value, 2, intMax, integer);
+                settings.imageWidth = static_cast<int>(integer);
+                isWidthSet = true;
+            }
+            else if (flag == "-H" || flag == "--height")
+            {
+                isValid = ParseInteger(value, 2, intMax, integer);
+                settings.imageHeight = static_cast<int>(integer);
+                isHeightSet = true;
+            }
+            else if (flag == "-s" || flag == "--spp")
+            {
+                // Sample counts are kept in 16 bits
+                isValid = ParseInteger(value, 1, 65535, integer);
+                settings.samplesPerPixel = static_cast<int>(integer);
+            }
+            else if (flag == "-d" || flag == "--max-depth")
+            {
+                isValid = ParseInteger(value, 1, intMax, integer);
+                settings.maxDepth = static_cast<int>(integer);
+            }
+            else if (flag == "--min-depth")
+            {
+                isValid = ParseInteger(value, 0, intMax, integer);
+                settings.minDepth = static_cast<int>(integer);
+            }
+            else if (flag == "-t" || flag == "--threads")
+            {
+                isValid = ParseInteger(value, 0, 4096, integer);
+                settings.threadCount = static_cast<int>(integer);
+            }
+            else if (flag == "--seed")
+            {
+                isValid = ParseUnsigned(value, settings.seed);
+            }
+            else if (flag == "--sampler")
+            {
+                isValid = ParseSamplerType(value, settings.sampler);
+            }
+            else if (flag == "-o" || flag == "--output")
+            {
+                settings.outputPath = value;
+                isValid = !settings.outputPath.empty();
+            }
+            else if (flag == "-f" || flag == "--format")
+            {
+                settings.outputFormat = value;
+                isValid = settings.outputFormat == "ppm" || settings.outputFormat == "pfm" || settings.outputFormat == "png";
+            }
+            else if (flag == "--tile")
+            {
+                isValid = ParseSize(value, settings.tileWidth, settings.tileHeight);
+            }
+            else if (flag == "--min-spp")
+            {
+                isValid = ParseInteger(value, 2, 65535, integer);
+                settings.minSamplesPerPixel = static_cast<int>(integer);
+            }
+            else if (flag == "--target-error")
+            {
+                isValid = ParseDouble(value, 0.0, settings.targetError);
+            }
+            else if (flag == "--heatmap")
+            {
+                settings.sampleHeatmapPath = value;
+            }
+            else if (flag == "--batch")
+            {
+                isValid = ParseInteger(value, 1, intMax, integer);
+                settings.wavefrontBatchSize = static_cast<int>(integer);
+            }
+            else if (flag == "--ao")
+            {
+                isValid = ParseInteger(value, 0, 1024, integer);
+                settings.ambientOcclusionRays = static_cast<int>(integer);
+            }
+            else if (flag == "--ao-distance")
+            {
+                isValid = ParseDouble(value, 0.0, settings.ambientOcclusionDistance) && settings.ambientOcclusionDistance > 0.0;
+            }
+            else if (flag == "--band-rows")
+            {
+                isValid = ParseInteger(value, 0, intMax, integer);
+                settings.bandRows = static_cast<int>(integer);
+            }
+            else if (flag == "--checkpoint")
+            {
+                settings.checkpointPath = value;
+                isValid = !settings.checkpointPath.empty();
+            }
+            else if (flag == "--checkpoint-interval")
+            {
+                isValid = ParseDouble(value, 0.0, settings.checkpointSeconds);
+            }
+            else if (flag == "--pass-spp")
+            {
+                isValid = ParseInteger(value, 1, 65535, integer);
+                settings.passSamples = static_cast<int>(integer);
+            }
+            else if (flag == "--denoise-iterations")
+            {
+                isValid = ParseInteger(value, 1, 10, integer);
+                settings.denoiseIterations = static_cast<int>(integer);
+            }
+            else if (flag == "--preview")
+            {
+                settings.previewPath = value;
+                isValid = !settings.previewPath.empty();
+            }
+            else if (flag == "--preview-port")
+            {
+                isValid = ParseInteger(value, 0, 65535, integer);
+                settings.previewPort = static_cast<int>(integer);
+            }
+            else if (flag == "--preview-levels")
+            {
+                isValid = ParseInteger(value, 0, 8, integer);
+                settings.previewLevels = static_cast<int>(integer);
+            }
+            else if (flag == "--scene")
+            {
+                settings.scenePath = value;
+                isValid = !settings.scenePath.empty();
+            }
+            else if (flag == "--export-scene")
+            {
+                settings.exportScenePath = value;
+                isValid = !settings.exportScenePath.empty();
+            }
+            else if (flag == "--scene-extent")
+            {
+                isValid = ParseInteger(value, 0, 100000, integer);
+                settings.sceneExtent = static_cast<int>(integer);
+            }
+            else if (flag == "--cluster-extent")
+            {
+                isValid = ParseInteger(value, 0, 1000, integer);
+                settings.clusterExtent = static_cast<int>(integer);
+            }
+            else if (flag == "--group")
+            {
+                isValid = ParseInteger(value, 1, 64, integer);
+                settings.sphereGroupSize = static_cast<int>(integer);
+            }
+            else if (flag == "--stats-json")
+            {
+                settings.statsJsonPath = value;
+            }
+            else if (flag == "--frames")
+            {
+                isValid = ParseInteger(value, 0, 1000000, integer);
+                settings.frameCount = static_cast<int>(integer);
+            }
+            else if (flag == "--camera-path")
+            {
+                settings.cameraPathPath = value;
+                isValid = !settings.cameraPathPath.empty();
+            }
+            else if (flag == "--listen")
+            {
+                isValid = ParseInteger(value, 0, 65535, integer);
+                settings.listenPort = static_cast<int>(integer);
+            }
+            else if (flag == "--spawn")
+            {
+                isValid = ParseInteger(value, 0, 1024, integer);
+                settings.spawnWorkers = static_cast<int>(integer);
+            }
+            else if (flag == "--connect")
+            {
+                std::string host;
+                int port = 0;
+                settings.coordinatorAddress = value;
+                isValid = Socket::ParseAddress(settings.coordinatorAddress, host, port) && !host.empty() && port > 0;
+            }
+
+            if (!isValid)
+            {
+                errorOut << "Invalid value '" << value << "' for " << flag << ".\n";
+                return CommandLineResult::Error;
+            }
+        }
+
+        // Keep the default aspect ratio when only one side is given
+        if (isWidthSet && !isHeightSet)
+        {
+            settings.imageHeight = std::max(2, static_cast<int>(settings.imageWidth / RT::aspectRatio));
+        }
+        else if (isHeightSet && !isWidthSet)
+        {
+            settings.imageWidth = std::max(2, static_cast<int>(settings.imageHeight * RT::aspectRatio));
+        }
+
+        return CommandLineResult::Run;
+    }
+
+    void PrintUsage(const char* programName, std::ostream& out)
+    {
+        const Settings defaults;
+        out << "Usage: " << programName << " [options]\n"
+            << "  -W, --width N          image width (" << defaults.imageWidth << ")\n"
+            << "  -H, --height N         image height (" << defaults.imageHeight << "), one side alone keeps 16:9\n"
+            << "  -s, --spp N            samples per pixel, the maximum with --adaptive (" << defaults.samplesPerPixel << ")\n"
+            << "  -d, --max-depth N      bounce limit (" << defaults.maxDepth << ")\n"
+            << "      --min-depth N      bounces before Russian roulette (" << defaults.minDepth << ")\n"
+            << "  -t, --threads N        worker threads, 0 is one per CPU this process may run on (" << defaults.threadCount << ")\n"
+            << "      --pin              pin workers to cores, NUMA nodes in turn, and place image rows on their nodes\n"
+            << "      --oversubscribe    keep more threads than CPUs instead of cutting them down\n"
+            << "      --seed N           scene and sample seed (" << defaults.seed << ")\n"
+            << "      --sampler NAME     sobol, bluenoise or random pixel, lens and bounce samples (" << SamplerTypeName(defaults.sampler) << ")\n"
+            << "  -o, --output PATH      output image, - is standard output (" << defaults.outputPath << ")\n"
+            << "  -f, --format FORMAT    ppm, pfm or png (from the output extension)\n"
+            << "      --tile WxH         tile size (" << defaults.tileWidth << "x" << defaults.tileHeight << ")\n"
+            << "      --no-steal         disable tile work stealing\n"
+            << "      --adaptive         variance-driven adaptive sampling\n"
+            << "      --min-spp N        samples per pixel before adaptive sampling may stop (" << defaults.minSamplesPerPixel << ")\n"
+            << "      --target-error E   adaptive sampling error target (" << defaults.targetError << ")\n"
+            << "      --heatmap PATH     samples per pixel image in adaptive mode, empty writes none (" << defaults.sampleHeatmapPath << ")\n"
+            << "      --wavefront        trace batches of paths bounce by bounce\n"
+            << "      --batch N          wavefront paths per batch (" << defaults.wavefrontBatchSize << ")\n"
+            << "      --ao N             ambient occlusion with N rays per camera sample instead of path tracing, 0 is off (" << defaults.ambientOcclusionRays << ")\n"
+            << "      --ao-distance D    distance within which ambient occlusion rays count as blocked (" << defaults.ambientOcclusionDistance << ")\n"
+            << "      --band-rows N      image rows held in memory and written out at a time, 0 is all (" << defaults.bandRows << ")\n"
+            << "      --checkpoint PATH  save the render to PATH as it goes and resume from it when it exists\n"
+            << "      --checkpoint-interval S  seconds between checkpoints (" << defaults.checkpointSeconds << ")\n"
+            << "      --pass-spp N       samples per pixel between checkpoints (" << defaults.passSamples << ")\n"
+            << "      --denoise          filter the image with the albedo, normals and depth of the first hits\n"
+            << "      --denoise-iterations N  wavelet filter passes, each twice as wide (" << defaults.denoiseIterations << ")\n"
+            << "      --preview PATH     write coarse-to-fine PPM previews over PATH as the render refines, - streams them\n"
+            << "      --preview-port PORT  serve the latest preview to every connection on PORT of localhost, 0 picks one\n"
+            << "      --preview-levels N  coarse preview levels, the first at 1/2^N of the size (" << defaults.previewLevels << ")\n"
+            << "      --scene PATH       render a binary scene file instead of the random scene\n"
+            << "      --export-scene PATH  write the random scene as a scene file and exit\n"
+            << "      --scene-extent N   random spheres on a (2N)^2 grid (" << defaults.sceneExtent << ")\n"
+            << "      --cluster-extent N  repeat one cluster of (2N)^2 random spheres as instances over the grid, 0 places every sphere (" << defaults.clusterExtent << ")\n"
+            << "      --group N          spheres per SIMD group, 1 disables grouping (" << defaults.sphereGroupSize << ")\n"
+            << "      --frames N         render N frames along the camera path, -o frame_####.png numbers them\n"
+            << "      --camera-path PATH  keyframes of the animation: time, lookFrom, lookAt, aperture (an orbit)\n"
+            << "      --stats-json PATH  write ray and path statistics as JSON\n"
+            << "      --listen PORT      coordinate workers connecting to PORT instead of rendering here\n"
+            << "      --spawn N          start N local workers for the coordinator, each with --threads threads\n"
+            << "      --connect HOST:PORT  render as a worker for the coordinator at HOST:PORT\n"
+            << "  -h, --help             show this help\n";
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "Config.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace RT
+{
+    /*
+     * Settings of one render. Starts out with the defaults from Config.h, the command line overrides them,
+     * so nodes can sweep parameters without a rebuild.
+     */
+    struct Settings
+    {
+        // Threads
+        int threadCount = RT::threadCount;
+        bool pinThreads = RT::pinThreads;
+        bool allowOversubscription = RT::allowOversubscription;
+
+        // Tiles
+        int tileWidth = RT::tileWidth;
+        int tileHeight = RT::tileHeight;
+        bool workStealing = RT::workStealing;
+
+        // Image
+        int imageWidth = RT::imageWidth;
+        int imageHeight = RT::imageHeight;
+        int samplesPerPixel = RT::samplesPerPixel;
+        int maxDepth = RT::maxDepth;
+        int minDepth = RT::minDepth;
+
+        // Adaptive sampling
+        bool adaptiveSampling = RT::adaptiveSampling;
+        int minSamplesPerPixel = RT::minSamplesPerPixel;
+        double targetError = RT::targetError;
+        std::string sampleHeatmapPath = RT::sampleHeatmapPath;
+
+        // Render mode
+        bool wavefront = RT::wavefront;
+        int wavefrontBatchSize = RT::wavefrontBatchSize;
+        int ambientOcclusionRays = RT::ambientOcclusionRays;
+        double ambientOcclusionDistance = RT::ambientOcclusionDistance;
+
+        // Framebuffer
+        int bandRows = RT::bandRows;
+
+        // Checkpoints
+        // Radiance buffer saved during the render and resumed from, empty renders without checkpoints
+        std::string checkpointPath;
+        int passSamples = RT::passSamples;
+        double checkpointSeconds = RT::checkpointSeconds;
+
+        // Denoising
+        bool denoise = RT::denoise;
+        int denoiseIterations = RT::denoiseIterations;
+
+        // Preview
+        // Binary PPM file replaced after every preview level, "-" streams the images to standard output; empty writes none
+        std::string previewPath;
+        // Serve the latest preview image to every connection on this port of localhost, 0 picks a free one, -1 serves none
+        int previewPort = -1;
+        int previewLevels = RT::previewLevels;
+
+        // Output
+        std::string outputPath = RT::outputPath;
+        // ppm, pfm or png, empty picks the format from the extension of outputPath
+        std::string outputFormat;
+
+        // Random
+        uint64_t seed = RT::seed;
+        SamplerType sampler = RT::sampler;
+
+        // Scene
+        int sceneExtent = RT::sceneExtent;
+        int clusterExtent = RT::clusterExtent;
+        // Scene file to render instead of the random scene, empty generates it
+        std::string scenePath;
+        // Write the random scene to this scene file and exit without rendering
+        std::string exportScenePath;
+
+        // Animation
+        // Frames rendered along the camera path with the scene and threads kept between frames, 0 renders one image
+        int frameCount = 0;
+        // Keyframe file of the camera path (see CameraPath::Load), empty orbits the scene once
+        std::string cameraPathPath;
+
+        // Acceleration
+        int sphereGroupSize = RT::sphereGroupSize;
+
+        // Statistics
+        // Render statistics as JSON, empty writes none
+        std::string statsJsonPath;
+
+        // Distributed rendering
+        // Coordinate workers connecting to this port instead of rendering here, -1 renders in this process
+        int listenPort = -1;
+        // Worker processes to start on this machine for the coordinator, each with threadCount threads
+        int spawnWorkers = 0;
+        // Render as a worker for the coordinator at host:port, empty is not a worker
+        std::string coordinatorAddress;
+
+        [[nodiscard]] double AspectRatio() const;
+        [[nodiscard]] size_t PixelCount() const;
+        // Rows of the frame buffer: bandRows rounded up to whole tile rows, the image height when it is 0 or larger
+        [[nodiscard]] int BandHeight() const;
+        // Output path of an animation frame: a run of '#' in outputPath becomes the zero-padded frame number, without
+        // one the number goes before the extension; "-" sends every frame to standard output
+        [[nodiscard]] std::string FramePath(int frame) const;
+        // Whether this process hands the frame out to workers rather than rendering it
+        [[nodiscard]] bool IsCoordinator() const;
+        // Whether the render publishes coarse-to-fine preview images
+        [[nodiscard]] bool IsPreview() const;
+    };
+
+    enum class CommandLineResult
+    {
+        Run,
+        Help,
+        Error
+    };
+
+    /*
+     * Override settings from command line flags, see PrintUsage. An image size given on only one side keeps
+     * the default aspect ratio. Errors are reported to errorOut.
+     */
+    CommandLineResult ParseCommandLine(int argc, const char* const* argv, Settings& settings, std::ostream& errorOut);
+
+    void PrintUsage(const char* programName, std::ostream& out);
+}
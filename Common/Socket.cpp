@@ -0,0 +1,296 @@
+#include "Socket.h"
+
+#include <cstdlib>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+    using NativeSocket = SOCKET;
+    constexpr NativeSocket invalidSocket = INVALID_SOCKET;
+
+    // Winsock has to be started once per process before the first socket
+    bool StartSockets()
+    {
+        static const bool isStarted = []()
+        {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        return isStarted;
+    }
+
+    void CloseNative(const NativeSocket socket)
+    {
+        closesocket(socket);
+    }
+#else
+    using NativeSocket = int;
+    constexpr NativeSocket invalidSocket = -1;
+
+    bool StartSockets()
+    {
+        return true;
+    }
+
+    void CloseNative(const NativeSocket socket)
+    {
+        close(socket);
+    }
+#endif
+
+    NativeSocket Native(const intptr_t handle)
+    {
+        return static_cast<NativeSocket>(handle);
+    }
+
+    void ConfigureConnection(const NativeSocket socket)
+    {
+        // Messages are written whole, waiting to fill packets only delays the small ones
+        const int isEnabled = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&isEnabled), sizeof(isEnabled));
+#ifdef SO_NOSIGPIPE
+        // Where send() has no MSG_NOSIGNAL, a peer that went away must not raise SIGPIPE either
+        setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &isEnabled, sizeof(isEnabled));
+#endif
+    }
+
+    // Addresses for a host and port, nullptr when the name does not resolve
+    addrinfo* Resolve(const std::string& host, const int port, const bool isPassive)
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = isPassive ? AI_PASSIVE : 0;
+        addrinfo* addresses = nullptr;
+        const std::string service = std::to_string(port);
+        if (getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &addresses) != 0) return nullptr;
+        return addresses;
+    }
+}
+
+namespace RT
+{
+    Socket::~Socket()
+    {
+        Close();
+    }
+
+    Socket::Socket(Socket&& other) noexcept
+        : handle(other.handle)
+    {
+        other.handle = -1;
+    }
+
+    Socket& Socket::operator=(Socket&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            handle = other.handle;
+            other.handle = -1;
+        }
+        return *this;
+    }
+
+    Socket Socket::Listen(const std::string& host, const int port)
+    {
+        Socket result;
+        if (!StartSockets()) return result;
+
+        addrinfo* addresses = Resolve(host, port, true);
+        for (const addrinfo* address = addresses; address != nullptr && !result.IsOpen(); address = address->ai_next)
+        {
+            const NativeSocket socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (socket == invalidSocket) continue;
+
+            const int isReused = 1;
+            setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&isReused), sizeof(isReused));
+            if (bind(socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0 && listen(socket, SOMAXCONN) == 0)
+            {
+                result.handle = static_cast<intptr_t>(socket);
+            }
+            else
+            {
+                CloseNative(socket);
+            }
+        }
+        if (addresses != nullptr) freeaddrinfo(addresses);
+        return result;
+    }
+
+    Socket Socket::Connect(const std::string& host, const int port)
+    {
+        Socket result;
+        if (!StartSockets()) return result;
+
+        addrinfo* addresses = Resolve(host, port, false);
+        for (const addrinfo* address = addresses; address != nullptr && !result.IsOpen(); address = address->ai_next)
+        {
+            const NativeSocket socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (socket == invalidSocket) continue;
+
+            if (connect(socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0)
+            {
+                ConfigureConnection(socket);
+                result.handle = static_cast<intptr_t>(socket);
+            }
+            else
+            {
+                CloseNative(socket);
+            }
+        }
+        if (addresses != nullptr) freeaddrinfo(addresses);
+        return result;
+    }
+
+    Socket Socket::Accept() const
+    {
+        Socket result;
+        const NativeSocket socket = accept(Native(handle), nullptr, nullptr);
+        if (socket != invalidSocket)
+        {
+            ConfigureConnection(socket);
+            result.handle = static_cast<intptr_t>(socket);
+        }
+        return result;
+    }
+
+    bool Socket::IsOpen() const
+    {
+        return handle != -1;
+    }
+
+    int Socket::LocalPort() const
+    {
+        sockaddr_storage address{};
+        socklen_t size = sizeof(address);
+        if (getsockname(Native(handle), reinterpret_cast<sockaddr*>(&address), &size) != 0) return 0;
+        if (address.ss_family == AF_INET6) return ntohs(reinterpret_cast<const sockaddr_in6*>(&address)->sin6_port);
+        return ntohs(reinterpret_cast<const sockaddr_in*>(&address)->sin_port);
+    }
+
+    bool Socket::SendAll(const void* data, size_t size) const
+    {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            // Capped so the count fits the int of Winsock
+            const int chunk = static_cast<int>(size < (1u << 30) ? size : (1u << 30));
+#ifdef MSG_NOSIGNAL
+            const auto sent = send(Native(handle), bytes, chunk, MSG_NOSIGNAL);
+#else
+            const auto sent = send(Native(handle), bytes, chunk, 0);
+#endif
+            if (sent <= 0) return false;
+            bytes += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    bool Socket::ReceiveAll(void* data, size_t size) const
+    {
+        char* bytes = static_cast<char*>(data);
+        while (size > 0)
+        {
+            const int chunk = static_cast<int>(size < (1u << 30) ? size : (1u << 30));
+            const auto received = recv(Native(handle), bytes, chunk, 0);
+            if (received <= 0) return false;
+            bytes += received;
+            size -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    bool Socket::SetSendTimeout(const int milliseconds) const
+    {
+#ifdef _WIN32
+        const DWORD timeout = static_cast<DWORD>(milliseconds);
+#else
+        timeval timeout{};
+        timeout.tv_sec = milliseconds / 1000;
+        timeout.tv_usec = (milliseconds % 1000) * 1000;
+#endif
+        return setsockopt(Native(handle), SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout)) == 0;
+    }
+
+    void Socket::Shutdown() const
+    {
+        if (handle == -1) return;
+#ifdef _WIN32
+        shutdown(Native(handle), SD_BOTH);
+#else
+        shutdown(Native(handle), SHUT_RDWR);
+#endif
+    }
+
+    void Socket::Close()
+    {
+        if (handle != -1)
+        {
+            CloseNative(Native(handle));
+            handle = -1;
+        }
+    }
+
+    bool Socket::WaitReadable(const std::vector<const Socket*>& sockets, const int timeoutMilliseconds, std::vector<char>& outIsReadable)
+    {
+#ifdef _WIN32
+        std::vector<WSAPOLLFD> descriptors(sockets.size());
+#else
+        std::vector<pollfd> descriptors(sockets.size());
+#endif
+        for (size_t index = 0; index < sockets.size(); ++index)
+        {
+            descriptors[index].fd = Native(sockets[index]->handle);
+            descriptors[index].events = POLLIN;
+        }
+#ifdef _WIN32
+        const int result = WSAPoll(descriptors.data(), static_cast<ULONG>(descriptors.size()), timeoutMilliseconds);
+#else
+        const int result = poll(descriptors.data(), descriptors.size(), timeoutMilliseconds);
+#endif
+        outIsReadable.assign(sockets.size(), 0);
+        if (result < 0) return false;
+        for (size_t index = 0; index < sockets.size(); ++index)
+        {
+            outIsReadable[index] = (descriptors[index].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+        }
+        return true;
+    }
+
+    bool Socket::ParseAddress(const std::string& address, std::string& outHost, int& outPort)
+    {
+        const size_t colon = address.find_last_of(':');
+        if (colon == std::string::npos) return false;
+
+        char* end = nullptr;
+        const long port = std::strtol(address.c_str() + colon + 1, &end, 10);
+        if (end == address.c_str() + colon + 1 || *end != '\0' || port < 0 || port > 65535) return false;
+
+        outHost = address.substr(0, colon);
+        // Brackets of an IPv6 literal, as in [::1]:7000
+        if (outHost.size() >= 2 && outHost.front() == '[' && outHost.back() == ']')
+        {
+            outHost = outHost.substr(1, outHost.size() - 2);
+        }
+        outPort = static_cast<int>(port);
+        return true;
+    }
+}
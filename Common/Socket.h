@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace RT
+{
+    /*
+     * Blocking TCP socket, either listening or connected, closed when it goes out of scope.
+     * Not open after a failed Listen(), Connect() or Accept().
+     */
+    class Socket
+    {
+    private:
+        intptr_t handle = -1;
+
+    public:
+        Socket() = default;
+        ~Socket();
+
+        Socket(Socket&& other) noexcept;
+        Socket& operator=(Socket&& other) noexcept;
+
+        Socket(const Socket&) = delete;
+        Socket& operator=(const Socket&) = delete;
+
+        // Listen on a port of the given local address, "" is every interface; port 0 picks a free one
+        static Socket Listen(const std::string& host, int port);
+        static Socket Connect(const std::string& host, int port);
+        Socket Accept() const;
+
+        [[nodiscard]] bool IsOpen() const;
+        // Port a listening socket was bound to
+        [[nodiscard]] int LocalPort() const;
+
+        // False once the connection is closed or broken
+        bool SendAll(const void* data, size_t size) const;
+        bool ReceiveAll(void* data, size_t size) const;
+
+        // A send that moves nothing for this long fails, so SendAll() gives up on a peer that stopped reading
+        bool SetSendTimeout(int milliseconds) const;
+        // Wake up a send, receive, wait or accept on this socket from another thread, which then fails; Close() still closes it
+        void Shutdown() const;
+
+        void Close();
+
+        /*
+         * Wait up to timeoutMilliseconds (negative waits forever) until any of the sockets has data or a closed
+         * connection to read. outIsReadable gets one entry per socket; false when waiting failed.
+         */
+        static bool WaitReadable(const std::vector<const Socket*>& sockets, int timeoutMilliseconds, std::vector<char>& outIsReadable);
+
+        // Split "host:port", false when there is no valid port
+        static bool ParseAddress(const std::string& address, std::string& outHost, int& outPort);
+    };
+}
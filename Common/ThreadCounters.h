@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace RT
+{
+    /*
+     * One copy of a counter struct per thread. Threads increment their own copy without any synchronization,
+     * Total() adds up the copies of all threads, running or finished. Read it while the workers are idle,
+     * for example after the worker pool returned from a job.
+     * Counters needs a default constructor that zeroes it and operator+=.
+     */
+    template <typename Counters>
+    class ThreadCounters
+    {
+    private:
+        struct Slot;
+
+        struct Registry
+        {
+            std::mutex mutex;
+            std::vector<Slot*> slots;
+            Counters retired{};
+        };
+
+        struct Slot
+        {
+            Counters counters{};
+
+            Slot()
+            {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.slots.push_back(this);
+            }
+
+            ~Slot()
+            {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.retired += counters;
+                registry.slots.erase(std::find(registry.slots.begin(), registry.slots.end(), this));
+            }
+        };
+
+        static Registry& GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+    public:
+        static Counters& Local()
+        {
+            thread_local Slot slot;
+            return slot.counters;
+        }
+
+        static Counters Total()
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            Counters total = registry.retired;
+            for (const Slot* slot : registry.slots)
+            {
+                total += slot->counters;
+            }
+            return total;
+        }
+
+        static void Reset()
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.retired = Counters{};
+            for (Slot* slot : registry.slots)
+            {
+                slot->counters = Counters{};
+            }
+        }
+    };
+}
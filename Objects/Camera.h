@@ -10,7 +10,7 @@ namespace RTObject
     private:
         RTTPoint3 origin;
         RTTVector3 w, u, v;
-        double lensRadius;
+        RT::Real lensRadius;
         RTTVector3 horizontal, vertical;
         RTTPoint3 lowerLeftCorner;
 
@@ -32,11 +32,27 @@ namespace RTObject
             lowerLeftCorner = origin - horizontal / 2 - vertical / 2 - focusDistance * w;
         }
 
-        [[nodiscard]] RTTRay GetRay(const double col, const double row) const
+        [[nodiscard]] RTTRay GetRay(const RT::Real col, const RT::Real row) const
         {
-            const RTTVector3 rd = lensRadius * RTType::RandomUnitDisk();
+            const RTTVector3 rd = lensRadius * RTType::SampleUnitDisk();
             const RTTVector3 offset = u * rd.x + v * rd.y;
             return RTTRay(origin + offset, lowerLeftCorner + col * horizontal + row * vertical - origin - offset);
         }
     };
+
+    // Placement and lens of a camera as a scene describes it, the aspect ratio comes from the image
+    struct CameraView
+    {
+        RTTPoint3 lookFrom;
+        RTTPoint3 lookAt;
+        RTTVector3 vectorUp;
+        double verticalFieldOfViewDegrees{};
+        double aperture{};
+        double focusDistance{};
+
+        [[nodiscard]] Camera ToCamera(const double aspectRatio) const
+        {
+            return Camera(lookFrom, lookAt, vectorUp, verticalFieldOfViewDegrees, aspectRatio, aperture, focusDistance);
+        }
+    };
 }
@@ -0,0 +1,158 @@
+#include "CameraPath.h"
+
+#include "Common/Common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+    // Uniform Catmull-Rom segment from p1 (u = 0) to p2 (u = 1), p0 and p3 shape the tangents
+    RTTPoint3 CatmullRom(const RTTPoint3& p0, const RTTPoint3& p1, const RTTPoint3& p2, const RTTPoint3& p3, const RT::Real u)
+    {
+        const RT::Real u2 = u * u;
+        const RT::Real u3 = u2 * u;
+        return RT::Real(0.5) * (RT::Real(2) * p1 + (p2 - p0) * u + (RT::Real(2) * p0 - RT::Real(5) * p1 + RT::Real(4) * p2 - p3) * u2
+            + (RT::Real(3) * (p1 - p2) + p3 - p0) * u3);
+    }
+}
+
+namespace RTObject
+{
+    CameraPath::CameraPath(const CameraView& inBaseView, std::vector<CameraKeyframe> inKeyframes)
+        : baseView(inBaseView), keyframes(std::move(inKeyframes))
+    {
+        std::stable_sort(keyframes.begin(), keyframes.end(), [](const CameraKeyframe& a, const CameraKeyframe& b)
+        {
+            return a.time < b.time;
+        });
+
+        const auto isSamePoint = [](const RTTPoint3& a, const RTTPoint3& b)
+        {
+            return a.x == b.x && a.y == b.y && a.z == b.z;
+        };
+        isLoop = keyframes.size() > 2 && isSamePoint(keyframes.front().lookFrom, keyframes.back().lookFrom)
+            && isSamePoint(keyframes.front().lookAt, keyframes.back().lookAt);
+    }
+
+    CameraView CameraPath::ViewAt(const double time) const
+    {
+        CameraView view = baseView;
+        if (keyframes.empty()) return view;
+
+        // Segment [k1, k2] holding the time, clamped to the first and last keyframe
+        const auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time, [](const double t, const CameraKeyframe& keyframe)
+        {
+            return t < keyframe.time;
+        });
+        const size_t k2 = std::min(static_cast<size_t>(next - keyframes.begin()), keyframes.size() - 1);
+        const size_t k1 = k2 > 0 ? k2 - 1 : 0;
+        const CameraKeyframe& a = keyframes[k1];
+        const CameraKeyframe& b = keyframes[k2];
+        const double span = b.time - a.time;
+        const double u = span > 0.0 ? RT::Clamp((time - a.time) / span, 0.0, 1.0) : (time < a.time ? 0.0 : 1.0);
+
+        // End segments reuse their end keyframe as the missing neighbour, a loop takes the one across the seam
+        const size_t last = keyframes.size() - 1;
+        const CameraKeyframe& before = keyframes[k1 > 0 ? k1 - 1 : (isLoop ? last - 1 : k1)];
+        const CameraKeyframe& after = keyframes[k2 < last ? k2 + 1 : (isLoop ? 1 : last)];
+        const auto realU = static_cast<RT::Real>(u);
+        view.lookFrom = CatmullRom(before.lookFrom, a.lookFrom, b.lookFrom, after.lookFrom, realU);
+        view.lookAt = CatmullRom(before.lookAt, a.lookAt, b.lookAt, after.lookAt, realU);
+        view.aperture = a.aperture + (b.aperture - a.aperture) * u;
+        view.focusDistance = a.focusDistance + (b.focusDistance - a.focusDistance) * u;
+        return view;
+    }
+
+    CameraView CameraPath::FrameView(const int frame, const int frameCount) const
+    {
+        if (keyframes.empty()) return baseView;
+
+        const double start = keyframes.front().time;
+        const double end = keyframes.back().time;
+        const int steps = isLoop ? frameCount : frameCount - 1;
+        const double t = steps > 0 ? static_cast<double>(frame) / steps : 0.0;
+        return ViewAt(start + (end - start) * t);
+    }
+
+    size_t CameraPath::KeyframeCount() const
+    {
+        return keyframes.size();
+    }
+
+    bool CameraPath::IsLoop() const
+    {
+        return isLoop;
+    }
+
+    bool CameraPath::Load(const std::string& path, const CameraView& inBaseView, CameraPath& outPath, std::ostream& errorOut)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            errorOut << "Cannot open camera path " << path << ".\n";
+            return false;
+        }
+
+        std::vector<CameraKeyframe> keyframes;
+        std::string line;
+        for (int lineNumber = 1; std::getline(file, line); ++lineNumber)
+        {
+            line = line.substr(0, line.find('#'));
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+            std::istringstream fields(line);
+            CameraKeyframe keyframe;
+            RT::Real from[3], at[3];
+            if (!(fields >> keyframe.time >> from[0] >> from[1] >> from[2] >> at[0] >> at[1] >> at[2] >> keyframe.aperture))
+            {
+                errorOut << path << ":" << lineNumber << ": expected time, lookFrom x y z, lookAt x y z and aperture.\n";
+                return false;
+            }
+            if (!(fields >> keyframe.focusDistance))
+            {
+                keyframe.focusDistance = inBaseView.focusDistance;
+            }
+            keyframe.lookFrom = RTTPoint3(from[0], from[1], from[2]);
+            keyframe.lookAt = RTTPoint3(at[0], at[1], at[2]);
+            keyframes.push_back(keyframe);
+        }
+        if (keyframes.empty())
+        {
+            errorOut << "Camera path " << path << " has no keyframes.\n";
+            return false;
+        }
+
+        outPath = CameraPath(inBaseView, std::move(keyframes));
+        return true;
+    }
+
+    CameraPath CameraPath::Orbit(const CameraView& view, const int keyframeCount)
+    {
+        const RTTVector3 offset = view.lookFrom - view.lookAt;
+        const RT::Real radius = std::sqrt(offset.x * offset.x + offset.z * offset.z);
+        const double startAngle = std::atan2(static_cast<double>(offset.z), static_cast<double>(offset.x));
+
+        // The last keyframe is a copy of the first, which makes the path a loop
+        std::vector<CameraKeyframe> keyframes;
+        const int count = std::max(3, keyframeCount);
+        for (int index = 0; index < count; ++index)
+        {
+            const double angle = startAngle + 2.0 * RT::pi * index / count;
+            CameraKeyframe keyframe;
+            keyframe.time = static_cast<double>(index) / count;
+            keyframe.lookFrom = view.lookAt + RTTVector3(radius * static_cast<RT::Real>(std::cos(angle)), offset.y, radius * static_cast<RT::Real>(std::sin(angle)));
+            keyframe.lookAt = view.lookAt;
+            keyframe.aperture = view.aperture;
+            keyframe.focusDistance = view.focusDistance;
+            keyframes.push_back(keyframe);
+        }
+        CameraKeyframe closing = keyframes.front();
+        closing.time = 1.0;
+        keyframes.push_back(closing);
+        return CameraPath(view, std::move(keyframes));
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Camera.h"
+
+#include "Types/RTTypes.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace RTObject
+{
+    // Placement and lens of the camera at one time of a camera path
+    struct CameraKeyframe
+    {
+        double time{};
+        RTTPoint3 lookFrom;
+        RTTPoint3 lookAt;
+        double aperture{};
+        double focusDistance{};
+    };
+
+    /*
+     * Camera fly-through: keyframed lookFrom, lookAt, aperture and focus distance over a base view, which keeps the up
+     * vector and field of view. Positions follow a Catmull-Rom spline through the keyframes, so the camera passes every
+     * keyframe without a kink; aperture and focus distance change linearly between them. A path whose last keyframe is
+     * back at the lookFrom and lookAt of the first is a loop: the spline runs on through the seam, and frames stop one
+     * step short of the end, so a looped animation does not show the first frame twice.
+     */
+    class CameraPath
+    {
+    private:
+        CameraView baseView;
+        std::vector<CameraKeyframe> keyframes;
+        bool isLoop = false;
+
+    public:
+        CameraPath() = default;
+        // Keyframes are sorted by time, at least one is needed
+        CameraPath(const CameraView& inBaseView, std::vector<CameraKeyframe> inKeyframes);
+
+        [[nodiscard]] CameraView ViewAt(double time) const;
+        // View of frame `frame` of frameCount, spread evenly from the first keyframe to the last, or up to it for a loop
+        [[nodiscard]] CameraView FrameView(int frame, int frameCount) const;
+
+        [[nodiscard]] size_t KeyframeCount() const;
+        [[nodiscard]] bool IsLoop() const;
+
+        /*
+         * Text file of one keyframe per line: time, lookFrom x y z, lookAt x y z, aperture and, optionally, the focus
+         * distance, which is the base view's otherwise; '#' starts a comment. Fails with a message on errorOut when
+         * the file is missing, a line does not parse or there is no keyframe.
+         */
+        static bool Load(const std::string& path, const CameraView& inBaseView, CameraPath& outPath, std::ostream& errorOut);
+
+        // One circle around the lookAt point of the view, at the height and distance of its lookFrom
+        static CameraPath Orbit(const CameraView& view, int keyframeCount = 16);
+    };
+}
@@ -0,0 +1,37 @@
+#include "Instance.h"
+
+namespace RTObject
+{
+    Instance::Instance(const RTTHittable* inObject, const RTTTransform& objectToWorld)
+        : object(inObject), worldToObject(objectToWorld.Inverse())
+    {
+    }
+
+    bool Instance::Hit(const RTTRay& ray, const RT::Real tMin, const RT::Real tMax, RTTHitResult& hitResult) const
+    {
+        if (!object->Hit(worldToObject.ApplyToRay(ray), tMin, tMax, hitResult)) return false;
+
+        // The object already turned its normal against the object-space ray, which the transposed inverse keeps
+        hitResult.point = ray.At(hitResult.t);
+        hitResult.normal = UnitVector(worldToObject.ApplyTransposed(hitResult.normal));
+        return true;
+    }
+
+    bool Instance::BoundingBox(RTTAABB& outBox) const
+    {
+        RTTAABB objectBox;
+        if (!object->BoundingBox(objectBox)) return false;
+        outBox = worldToObject.Inverse().ApplyToBox(objectBox);
+        return true;
+    }
+
+    bool Instance::Occluded(const RTTRay& ray, const RT::Real tMin, const RT::Real tMax) const
+    {
+        return object->Occluded(worldToObject.ApplyToRay(ray), tMin, tMax);
+    }
+
+    const RTTHittable* Instance::GetObject() const
+    {
+        return object;
+    }
+}
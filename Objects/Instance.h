@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Types/RTTypes.h"
+
+namespace RTObject
+{
+    /*
+     * Placement of a shared object, usually the BVH of a sub-scene, under an affine transform. Rays are taken into
+     * object space and the object is tested there; the direction is not normalized on the way, so the distance t of
+     * the hit is the same in both spaces and the world point is found on the original ray. Only the object pointer
+     * and the world-to-object transform are stored, a million instances of one cluster cost a million transforms.
+     */
+    class Instance : public RTTHittable
+    {
+    private:
+        const RTTHittable* object = nullptr;
+        RTTTransform worldToObject;
+
+    public:
+        // The object belongs to the scene, objectToWorld must be invertible
+        Instance(const RTTHittable* inObject, const RTTTransform& objectToWorld);
+
+        bool Hit(const RTTRay& ray, RT::Real tMin, RT::Real tMax, RTTHitResult& hitResult) const override;
+        bool BoundingBox(RTTAABB& outBox) const override;
+        bool Occluded(const RTTRay& ray, RT::Real tMin, RT::Real tMax) const override;
+
+        [[nodiscard]] const RTTHittable* GetObject() const;
+    };
+}
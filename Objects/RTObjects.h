@@ -1,7 +1,18 @@
 ﻿#pragma once
 
 #include "Camera.h"
+#include "CameraPath.h"
+#include "Instance.h"
+#include "RandomScene.h"
+#include "Scene.h"
+#include "SceneFile.h"
 #include "Sphere.h"
+#include "SphereGroup.h"
 
 using RTOCamera = RTObject::Camera;
+using RTOCameraPath = RTObject::CameraPath;
+using RTOCameraView = RTObject::CameraView;
+using RTOInstance = RTObject::Instance;
+using RTOScene = RTObject::Scene;
 using RTOSphere = RTObject::Sphere;
+using RTOSphereGroup = RTObject::SphereGroup;
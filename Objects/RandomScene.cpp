@@ -0,0 +1,157 @@
+#include "RandomScene.h"
+
+#include "Common/Common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // The three large spheres, of radius 1 on the ground
+    const RTTPoint3 largeSphereCenters[] = {RTTPoint3(0.0, 1.0, 0.0), RTTPoint3(-4.0, 1.0, 0.0), RTTPoint3(4.0, 1.0, 0.0)};
+
+    /*
+     * Small spheres of random materials on the (2 * extent)^2 grid around the origin, none within 0.9 of a point of
+     * keepClear. A point at the height of the small spheres under the center of a large sphere keeps them off it.
+     */
+    void AddSmallSpheres(RTObject::Scene& scene, const int extent, const RTTMaterial* materialGlass, const std::vector<RTTPoint3>& keepClear)
+    {
+        for (int a = -extent; a < extent; ++a)
+        {
+            for (int b = -extent; b < extent; ++b)
+            {
+                const double randomMaterial = RT::RandomDouble();
+                RTTPoint3 center(a + 0.9 * RT::RandomDouble(), 0.2, b + 0.9 * RT::RandomDouble());
+
+                const bool isClear = std::all_of(keepClear.begin(), keepClear.end(), [&](const RTTPoint3& point)
+                {
+                    return (center - point).Length() > 0.9;
+                });
+                if (isClear)
+                {
+                    if (randomMaterial < 0.75)
+                    {
+                        // Diffuse material
+                        RTTColor albedo = RTTColor::Random() * RTTColor::Random();
+                        scene.AddSphere(center, 0.2, scene.AddLambertian(albedo));
+                    }
+                    else if (randomMaterial < 0.95)
+                    {
+                        // Metallic material
+                        RTTColor albedo = RTTColor::Random(0.5, 1.0);
+                        double fuzziness = RT::RandomDouble(0.1, 0.9);
+                        scene.AddSphere(center, 0.2, scene.AddMetal(albedo, fuzziness));
+                    }
+                    else
+                    {
+                        scene.AddSphere(center, 0.2, materialGlass);
+                    }
+                }
+            }
+        }
+    }
+
+    void AddLargeSpheres(RTObject::Scene& scene, const RTTMaterial* materialGlass)
+    {
+        const RTTMaterial* materialMatte = scene.AddLambertian(RTTColor(1.0, 0.75, 0.8));
+        scene.AddSphere(largeSphereCenters[0], 1.0, materialMatte);
+
+        const RTTMaterial* materialMetal = scene.AddMetal(RTTColor(1.0, 0.85, 0.0), 0.3);
+        scene.AddSphere(largeSphereCenters[1], 1.0, materialMetal);
+
+        scene.AddSphere(largeSphereCenters[2], 1.0, materialGlass);
+    }
+}
+
+namespace RTObject
+{
+    Scene RandomScene(const int sceneExtent)
+    {
+        Scene scene;
+        const int gridSize = 2 * sceneExtent;
+        scene.spheres.reserve(static_cast<size_t>(gridSize) * gridSize + 4);
+
+        // Ground
+        const RTTMaterial* materialGround = scene.AddLambertian(RTTColor(0.5, 0.5, 0.5));
+        scene.AddSphere(RTTPoint3(0.0, -1000.0, 0.0), 1000.0, materialGround);
+
+        const RTTMaterial* materialGlass = scene.AddDielectric(1.5);
+
+        AddSmallSpheres(scene, sceneExtent, materialGlass, {RTTPoint3(4.0, 0.2, 0.0)});
+
+        AddLargeSpheres(scene, materialGlass);
+        return scene;
+    }
+
+    Scene InstancedRandomScene(const int sceneExtent, const int clusterExtent, const int groupSize)
+    {
+        Scene scene;
+
+        // Ground
+        const RTTMaterial* materialGround = scene.AddLambertian(RTTColor(0.5, 0.5, 0.5));
+        scene.AddSphere(RTTPoint3(0.0, -1000.0, 0.0), 1000.0, materialGround);
+
+        const RTTMaterial* materialGlass = scene.AddDielectric(1.5);
+
+        // One cluster of small spheres, with materials of its own
+        Scene cluster;
+        const int clusterSize = 2 * clusterExtent;
+        cluster.spheres.reserve(static_cast<size_t>(clusterSize) * clusterSize);
+        AddSmallSpheres(cluster, clusterExtent, cluster.AddDielectric(1.5), {});
+        const RTTHittable* prototype = scene.AddPrototype(std::move(cluster), groupSize);
+
+        // Tiles of the grid, each a quarter turn of the cluster: grid cells turn into grid cells, so no two spheres meet
+        const int tileCount = (2 * sceneExtent + clusterSize - 1) / clusterSize;
+        scene.instances.reserve(static_cast<size_t>(tileCount) * tileCount);
+        for (int tileX = 0; tileX < tileCount; ++tileX)
+        {
+            for (int tileZ = 0; tileZ < tileCount; ++tileZ)
+            {
+                const RTTVector3 tileCenter(-sceneExtent + (tileX + 0.5) * clusterSize, 0.0, -sceneExtent + (tileZ + 0.5) * clusterSize);
+
+                // Large spheres reaching into the tile, under their centers in the coordinates of the tile
+                std::vector<RTTPoint3> keepClear;
+                for (const RTTPoint3& center : largeSphereCenters)
+                {
+                    const RTTPoint3 point(center.x - tileCenter.x, 0.2, center.z - tileCenter.z);
+                    if (std::fabs(point.x) < clusterExtent + 1 && std::fabs(point.z) < clusterExtent + 1) keepClear.push_back(point);
+                }
+
+                if (keepClear.empty())
+                {
+                    const auto quarterTurns = static_cast<int>(4.0 * RT::RandomDouble());
+                    scene.AddInstance(prototype, RTTTransform::Translation(tileCenter) * RTTTransform::RotationY(quarterTurns * RT::pi / 2.0));
+                }
+                else
+                {
+                    // A cluster of its own that leaves room for them, as the plain scene does around the glass sphere
+                    Scene clearCluster;
+                    clearCluster.spheres.reserve(static_cast<size_t>(clusterSize) * clusterSize);
+                    AddSmallSpheres(clearCluster, clusterExtent, clearCluster.AddDielectric(1.5), keepClear);
+                    scene.AddInstance(scene.AddPrototype(std::move(clearCluster), groupSize), RTTTransform::Translation(tileCenter));
+                }
+            }
+        }
+
+        AddLargeSpheres(scene, materialGlass);
+        return scene;
+    }
+
+    CameraView RandomSceneView()
+    {
+        CameraView view;
+        view.lookFrom = RTTPoint3(13.0, 2.0, 3.0);
+        view.lookAt = RTTPoint3(0.0, 0.0, 0.0);
+        view.vectorUp = RTTVector3(0.0, 1.0, 0.0);
+        view.verticalFieldOfViewDegrees = 20.0;
+        view.aperture = 0.1;
+        view.focusDistance = 10.0;
+        return view;
+    }
+
+    Camera RandomSceneCamera(const double aspectRatio)
+    {
+        return RandomSceneView().ToCamera(aspectRatio);
+    }
+}
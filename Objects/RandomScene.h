@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Camera.h"
+#include "Scene.h"
+
+namespace RTObject
+{
+    /*
+     * Final scene of the book: a ground sphere, small random spheres on a (2 * sceneExtent)^2 grid and three large
+     * spheres. Draws from the calling thread's generator, seed it first to get the same scene every time.
+     */
+    Scene RandomScene(int sceneExtent);
+
+    /*
+     * The random scene with its small spheres generated once, as a cluster on a (2 * clusterExtent)^2 grid, and
+     * placed as instances, each turned by a random quarter turn, on the tiles of the (2 * sceneExtent)^2 grid. The
+     * cluster is traced through its own BVH of groupSize sphere groups; the scene holds one transform per tile.
+     */
+    Scene InstancedRandomScene(int sceneExtent, int clusterExtent, int groupSize);
+
+    // Camera looking at the random scene
+    CameraView RandomSceneView();
+    Camera RandomSceneCamera(double aspectRatio);
+}
@@ -0,0 +1,153 @@
+#include "Scene.h"
+
+#include <unordered_map>
+
+namespace RTObject
+{
+    Scene::Scene() = default;
+    Scene::Scene(Scene&&) noexcept = default;
+    Scene& Scene::operator=(Scene&&) noexcept = default;
+    Scene::~Scene() = default;
+
+    const RTTMaterial* Scene::AddLambertian(const RTTColor& albedo)
+    {
+        return &lambertians.emplace_back(albedo);
+    }
+
+    const RTTMaterial* Scene::AddMetal(const RTTColor& albedo, const RT::Real fuzziness)
+    {
+        return &metals.emplace_back(albedo, fuzziness);
+    }
+
+    const RTTMaterial* Scene::AddDielectric(const RT::Real refraction)
+    {
+        return &dielectrics.emplace_back(refraction);
+    }
+
+    void Scene::AddSphere(const RTTPoint3& center, const RT::Real radius, const RTTMaterial* material)
+    {
+        spheres.emplace_back(center, radius, material);
+    }
+
+    const RTTHittable* Scene::AddPrototype(Scene&& prototype, const int groupSize)
+    {
+        return &prototypes.emplace_back(std::make_unique<Prototype>(std::move(prototype), groupSize))->hierarchy;
+    }
+
+    void Scene::AddInstance(const RTTHittable* object, const RTTTransform& objectToWorld)
+    {
+        instances.emplace_back(object, objectToWorld);
+    }
+
+    size_t Scene::MaterialCount() const
+    {
+        size_t count = lambertians.size() + metals.size() + dielectrics.size();
+        for (const std::unique_ptr<Prototype>& prototype : prototypes)
+        {
+            count += prototype->scene.MaterialCount();
+        }
+        return count;
+    }
+
+    size_t Scene::RenderedSphereCount() const
+    {
+        // Spheres of every prototype once, by the hierarchy its instances point at
+        std::unordered_map<const RTTHittable*, size_t> prototypeCounts;
+        prototypeCounts.reserve(prototypes.size());
+        for (const std::unique_ptr<Prototype>& prototype : prototypes)
+        {
+            prototypeCounts.emplace(&prototype->hierarchy, prototype->scene.RenderedSphereCount());
+        }
+
+        size_t count = spheres.size();
+        for (const Instance& instance : instances)
+        {
+            const auto entry = prototypeCounts.find(instance.GetObject());
+            if (entry != prototypeCounts.end()) count += entry->second;
+        }
+        return count;
+    }
+
+    size_t Scene::MemorySize() const
+    {
+        size_t size = sizeof(Scene) + spheres.capacity() * sizeof(Sphere) + instances.capacity() * sizeof(Instance)
+            + lambertians.size() * sizeof(RTType::Lambertian) + metals.size() * sizeof(RTType::Metal) + dielectrics.size() * sizeof(RTType::Dielectric);
+        for (const SphereGroup& group : sphereGroups)
+        {
+            size += group.MemorySize();
+        }
+        for (const std::unique_ptr<Prototype>& prototype : prototypes)
+        {
+            size += prototype->scene.MemorySize() + prototype->hierarchy.MemorySize();
+        }
+        return size;
+    }
+
+    RTTHittableList Scene::Objects() const
+    {
+        RTTHittableList list;
+        list.objects.reserve(spheres.size());
+        for (const Sphere& sphere : spheres)
+        {
+            list.Add(&sphere);
+        }
+        return list;
+    }
+
+    RTTHittableList Scene::PackSpheres(const int groupSize)
+    {
+        RTTHittableList packed;
+        if (spheres.empty()) return packed;
+
+        const RTTBVH clusters(Objects(), groupSize);
+        const std::vector<RTTHittableList> leaves = clusters.GetLeafGroups();
+
+        // Groups are stored before any pointer to them is taken, the vector does not move afterwards
+        sphereGroups.clear();
+        sphereGroups.reserve(leaves.size());
+        for (const RTTHittableList& leaf : leaves)
+        {
+            if (leaf.objects.size() == 1) continue;
+
+            std::vector<const Sphere*> leafSpheres;
+            leafSpheres.reserve(leaf.objects.size());
+            for (const RTTHittable* object : leaf.objects)
+            {
+                leafSpheres.push_back(static_cast<const Sphere*>(object));
+            }
+            sphereGroups.emplace_back(leafSpheres);
+        }
+
+        size_t groupIndex = 0;
+        for (const RTTHittableList& leaf : leaves)
+        {
+            if (leaf.objects.size() == 1)
+            {
+                packed.Add(leaf.objects.front());
+            }
+            else
+            {
+                packed.Add(&sphereGroups[groupIndex++]);
+            }
+        }
+        return packed;
+    }
+
+    RTTBVH Scene::BuildHierarchy(const int groupSize)
+    {
+        RTTHittableList objects = groupSize > 1 ? PackSpheres(groupSize) : Objects();
+        objects.objects.reserve(objects.objects.size() + instances.size());
+        for (const Instance& instance : instances)
+        {
+            objects.Add(&instance);
+        }
+
+        // Sphere groups are already leaf-sized, so the tree over them keeps one group per leaf
+        return groupSize > 1 ? RTTBVH(objects, 1) : RTTBVH(objects);
+    }
+
+    Prototype::Prototype(Scene&& inScene, const int groupSize)
+        : scene(std::move(inScene)), hierarchy(scene.BuildHierarchy(groupSize))
+    {
+    }
+}
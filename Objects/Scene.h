@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Instance.h"
+#include "Sphere.h"
+#include "SphereGroup.h"
+
+#include "Types/RTTypes.h"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace RTObject
+{
+    struct Prototype;
+
+    /*
+     * Owns every primitive and material of a scene in per-type arrays.
+     * Hittables and hit results only point into these arrays, so tracing a ray never touches a reference count.
+     * Materials live in deques, which never move their elements, so material pointers stay valid while the scene grows.
+     * Spheres are kept in one contiguous vector; take hittable lists only after the last sphere was added.
+     * Instances place shared sub-scenes, prototypes the scene owns with their own spheres, materials and BVH.
+     */
+    class Scene
+    {
+    public:
+        std::vector<Sphere> spheres;
+        std::vector<SphereGroup> sphereGroups;
+        std::vector<Instance> instances;
+
+    private:
+        std::deque<RTType::Lambertian> lambertians;
+        std::deque<RTType::Metal> metals;
+        std::deque<RTType::Dielectric> dielectrics;
+        // Heap-allocated, so instances keep pointing at the same hierarchy while the scene moves or grows
+        std::vector<std::unique_ptr<Prototype>> prototypes;
+
+    public:
+        Scene();
+        Scene(Scene&&) noexcept;
+        Scene& operator=(Scene&&) noexcept;
+        ~Scene();
+
+        Scene(const Scene&) = delete;
+        Scene& operator=(const Scene&) = delete;
+
+        const RTTMaterial* AddLambertian(const RTTColor& albedo);
+        const RTTMaterial* AddMetal(const RTTColor& albedo, RT::Real fuzziness);
+        const RTTMaterial* AddDielectric(RT::Real refraction);
+
+        void AddSphere(const RTTPoint3& center, RT::Real radius, const RTTMaterial* material);
+
+        // Take over a sub-scene and build its hierarchy of groupSize sphere groups, which instances then refer to
+        const RTTHittable* AddPrototype(Scene&& prototype, int groupSize);
+        void AddInstance(const RTTHittable* object, const RTTTransform& objectToWorld);
+
+        [[nodiscard]] size_t MaterialCount() const;
+
+        // Spheres rendered, counted once per instance of a prototype
+        [[nodiscard]] size_t RenderedSphereCount() const;
+
+        // Bytes held by the spheres, groups, materials, instances and prototypes, BVHs of the prototypes included
+        [[nodiscard]] size_t MemorySize() const;
+
+        // Every sphere as its own hittable
+        [[nodiscard]] RTTHittableList Objects() const;
+
+        /*
+         * Group at most groupSize spatially close spheres, taken from the leaves of a BVH built over them,
+         * into SIMD sphere groups owned by the scene, and list those groups.
+         */
+        RTTHittableList PackSpheres(int groupSize);
+
+        // BVH the renderer traces: over SIMD sphere groups of at most groupSize spheres, over single spheres for 1,
+        // and over the instances
+        RTTBVH BuildHierarchy(int groupSize);
+    };
+
+    struct Prototype
+    {
+        Scene scene;
+        // Built once the scene has its final address, the hierarchy points into it
+        RTTBVH hierarchy;
+
+        Prototype(Scene&& inScene, int groupSize);
+    };
+}
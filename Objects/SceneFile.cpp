@@ -0,0 +1,245 @@
+#include "SceneFile.h"
+
+#include "RandomScene.h"
+
+#include "Common/MappedFile.h"
+#include "Common/Random.h"
+
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr char sceneMagic[8] = {'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0'};
+    constexpr uint32_t sceneVersion = 1;
+
+    struct SceneHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t materialCount;
+        uint64_t sphereCount;
+        double lookFrom[3];
+        double lookAt[3];
+        double vectorUp[3];
+        double verticalFieldOfViewDegrees;
+        double aperture;
+        double focusDistance;
+        uint64_t reserved;
+    };
+    static_assert(sizeof(SceneHeader) == 128, "scene header layout changed");
+
+    struct MaterialRecord
+    {
+        uint32_t type;
+        uint32_t reserved;
+        double albedo[3];
+        // Fuzziness of a metal, refraction index of a dielectric
+        double parameter;
+    };
+    static_assert(sizeof(MaterialRecord) == 40, "material record layout changed");
+
+    // Bytes of the sphere arrays that follow the material table
+    constexpr size_t sphereSize = 4 * sizeof(double) + sizeof(uint32_t);
+
+    void StoreVector(const RTTVector3& vector, double (&outValues)[3])
+    {
+        outValues[0] = vector.x;
+        outValues[1] = vector.y;
+        outValues[2] = vector.z;
+    }
+
+    RTTVector3 LoadVector(const double (&values)[3])
+    {
+        return RTTVector3(static_cast<RT::Real>(values[0]), static_cast<RT::Real>(values[1]), static_cast<RT::Real>(values[2]));
+    }
+
+    MaterialRecord MakeRecord(const RTTMaterial& material)
+    {
+        MaterialRecord record{};
+        record.type = static_cast<uint32_t>(material.GetType());
+        switch (material.GetType())
+        {
+        case RTType::MaterialType::Lambertian:
+            StoreVector(static_cast<const RTType::Lambertian&>(material).albedo, record.albedo);
+            break;
+        case RTType::MaterialType::Metal:
+            StoreVector(static_cast<const RTType::Metal&>(material).albedo, record.albedo);
+            record.parameter = static_cast<const RTType::Metal&>(material).fuzziness;
+            break;
+        case RTType::MaterialType::Dielectric:
+            record.parameter = static_cast<const RTType::Dielectric&>(material).refraction;
+            break;
+        }
+        return record;
+    }
+
+    template <typename T>
+    bool WriteArray(FILE* file, const std::vector<T>& values)
+    {
+        return std::fwrite(values.data(), sizeof(T), values.size(), file) == values.size();
+    }
+}
+
+namespace RTObject
+{
+    bool SaveScene(const std::string& path, const Scene& scene, const CameraView& view, std::ostream& errorOut)
+    {
+        if (!scene.instances.empty())
+        {
+            errorOut << "Scene files hold spheres only, not the instances of " << path << ".\n";
+            return false;
+        }
+
+        // Materials in the order spheres first use them, each shared one stored once
+        std::unordered_map<const RTTMaterial*, uint32_t> materialIndices;
+        std::vector<MaterialRecord> materials;
+        std::vector<uint32_t> sphereMaterials;
+        sphereMaterials.reserve(scene.spheres.size());
+        for (const Sphere& sphere : scene.spheres)
+        {
+            const auto [entry, isNew] = materialIndices.emplace(sphere.material, static_cast<uint32_t>(materials.size()));
+            if (isNew) materials.push_back(MakeRecord(*sphere.material));
+            sphereMaterials.push_back(entry->second);
+        }
+
+        const size_t sphereCount = scene.spheres.size();
+        std::vector<double> centerX(sphereCount), centerY(sphereCount), centerZ(sphereCount), radius(sphereCount);
+        for (size_t index = 0; index < sphereCount; ++index)
+        {
+            const Sphere& sphere = scene.spheres[index];
+            centerX[index] = sphere.center.x;
+            centerY[index] = sphere.center.y;
+            centerZ[index] = sphere.center.z;
+            radius[index] = sphere.radius;
+        }
+
+        SceneHeader header{};
+        std::memcpy(header.magic, sceneMagic, sizeof(sceneMagic));
+        header.version = sceneVersion;
+        header.materialCount = static_cast<uint32_t>(materials.size());
+        header.sphereCount = sphereCount;
+        StoreVector(view.lookFrom, header.lookFrom);
+        StoreVector(view.lookAt, header.lookAt);
+        StoreVector(view.vectorUp, header.vectorUp);
+        header.verticalFieldOfViewDegrees = view.verticalFieldOfViewDegrees;
+        header.aperture = view.aperture;
+        header.focusDistance = view.focusDistance;
+
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            errorOut << "Cannot open " << path << " for writing.\n";
+            return false;
+        }
+        bool isWritten = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        isWritten &= WriteArray(file, materials);
+        isWritten &= WriteArray(file, centerX) && WriteArray(file, centerY) && WriteArray(file, centerZ) && WriteArray(file, radius);
+        isWritten &= WriteArray(file, sphereMaterials);
+        isWritten &= std::fclose(file) == 0;
+        if (!isWritten)
+        {
+            errorOut << "Failed to write " << path << ".\n";
+        }
+        return isWritten;
+    }
+
+    bool LoadScene(const std::string& path, Scene& outScene, CameraView& outView, std::ostream& errorOut)
+    {
+        const RT::MappedFile file(path);
+        if (!file.IsOpen())
+        {
+            errorOut << "Cannot open scene " << path << ".\n";
+            return false;
+        }
+
+        SceneHeader header{};
+        if (file.Size() < sizeof(header))
+        {
+            errorOut << path << " is too short for a scene file.\n";
+            return false;
+        }
+        std::memcpy(&header, file.Data(), sizeof(header));
+        if (std::memcmp(header.magic, sceneMagic, sizeof(sceneMagic)) != 0 || header.version != sceneVersion)
+        {
+            errorOut << path << " is not a version " << sceneVersion << " scene file.\n";
+            return false;
+        }
+
+        // Sizes are checked one part at a time, so a corrupt count cannot overflow the total
+        const size_t materialBytes = static_cast<size_t>(header.materialCount) * sizeof(MaterialRecord);
+        if (file.Size() - sizeof(header) < materialBytes || (file.Size() - sizeof(header) - materialBytes) / sphereSize < header.sphereCount)
+        {
+            errorOut << path << " is truncated.\n";
+            return false;
+        }
+
+        // The mapping is page aligned and every array starts at a multiple of its element size
+        const auto* materials = reinterpret_cast<const MaterialRecord*>(file.Data() + sizeof(header));
+        const auto sphereCount = static_cast<size_t>(header.sphereCount);
+        const auto* centerX = reinterpret_cast<const double*>(file.Data() + sizeof(header) + materialBytes);
+        const double* centerY = centerX + sphereCount;
+        const double* centerZ = centerY + sphereCount;
+        const double* radius = centerZ + sphereCount;
+        const auto* sphereMaterials = reinterpret_cast<const uint32_t*>(radius + sphereCount);
+
+        Scene scene;
+        std::vector<const RTTMaterial*> materialPointers(header.materialCount);
+        for (uint32_t index = 0; index < header.materialCount; ++index)
+        {
+            const MaterialRecord& record = materials[index];
+            const RTTColor albedo = LoadVector(record.albedo);
+            const auto parameter = static_cast<RT::Real>(record.parameter);
+            switch (static_cast<RTType::MaterialType>(record.type))
+            {
+            case RTType::MaterialType::Lambertian:
+                materialPointers[index] = scene.AddLambertian(albedo);
+                break;
+            case RTType::MaterialType::Metal:
+                materialPointers[index] = scene.AddMetal(albedo, parameter);
+                break;
+            case RTType::MaterialType::Dielectric:
+                materialPointers[index] = scene.AddDielectric(parameter);
+                break;
+            default:
+                errorOut << path << ": material " << index << " has unknown type " << record.type << ".\n";
+                return false;
+            }
+        }
+
+        scene.spheres.reserve(sphereCount);
+        for (size_t index = 0; index < sphereCount; ++index)
+        {
+            if (sphereMaterials[index] >= header.materialCount)
+            {
+                errorOut << path << ": sphere " << index << " uses missing material " << sphereMaterials[index] << ".\n";
+                return false;
+            }
+            const RTTPoint3 center(static_cast<RT::Real>(centerX[index]), static_cast<RT::Real>(centerY[index]), static_cast<RT::Real>(centerZ[index]));
+            scene.AddSphere(center, static_cast<RT::Real>(radius[index]), materialPointers[sphereMaterials[index]]);
+        }
+
+        outView.lookFrom = LoadVector(header.lookFrom);
+        outView.lookAt = LoadVector(header.lookAt);
+        outView.vectorUp = LoadVector(header.vectorUp);
+        outView.verticalFieldOfViewDegrees = header.verticalFieldOfViewDegrees;
+        outView.aperture = header.aperture;
+        outView.focusDistance = header.focusDistance;
+        outScene = std::move(scene);
+        return true;
+    }
+
+    bool MakeScene(const RT::Settings& settings, Scene& outScene, CameraView& outView, std::ostream& errorOut)
+    {
+        if (!settings.scenePath.empty()) return LoadScene(settings.scenePath, outScene, outView, errorOut);
+
+        RT::ThreadRandom().Seed(settings.seed, 0);
+        outScene = settings.clusterExtent > 0 ? InstancedRandomScene(settings.sceneExtent, settings.clusterExtent, settings.sphereGroupSize)
+            : RandomScene(settings.sceneExtent);
+        outView = RandomSceneView();
+        return true;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Camera.h"
+#include "Scene.h"
+
+#include "Common/Settings.h"
+
+#include <ostream>
+#include <string>
+
+namespace RTObject
+{
+    /*
+     * Binary scene file, in the native little-endian layout of x86 and ARM, every array aligned to its element:
+     *	header: "RTSCENE" magic, version, material and sphere counts, and the camera view, 128 bytes;
+     *	material table: type, albedo and fuzziness or refraction index per material, 40 bytes each;
+     *	sphere arrays: center x, y and z and radius as doubles, then the material index as uint32, one array after another.
+     * Values are stored in double whatever the build traces in, so a saved scene renders exactly like the generated one.
+     */
+    bool SaveScene(const std::string& path, const Scene& scene, const CameraView& view, std::ostream& errorOut);
+
+    /*
+     * Maps a scene file and builds the scene straight from the mapped arrays, without parsing or a per-sphere
+     * allocation. Fails with a message on errorOut when the file is missing, truncated, of another version or refers
+     * to a material it does not have.
+     */
+    bool LoadScene(const std::string& path, Scene& outScene, CameraView& outView, std::ostream& errorOut);
+
+    // Scene the settings ask for: their scene file, or the random scene of their seed and extent
+    bool MakeScene(const RT::Settings& settings, Scene& outScene, CameraView& outView, std::ostream& errorOut);
+}
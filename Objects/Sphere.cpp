@@ -1,15 +1,17 @@
 ﻿#include "Sphere.h"
 
+#include <utility>
+
 namespace RTObject
 {
     Sphere::Sphere() = default;
 
-    Sphere::Sphere(RTTPoint3 inCenter, double inRadius, std::shared_ptr<RTTMaterial> inMaterial)
-        : center(inCenter), radius(inRadius), material(std::move(inMaterial))
+    Sphere::Sphere(RTTPoint3 inCenter, RT::Real inRadius, const RTTMaterial* inMaterial)
+        : center(inCenter), radius(inRadius), material(inMaterial)
     {
     }
 
-    bool Sphere::Hit(const RTTRay& ray, const double tMin, const double tMax, RTTHitResult& hitResult) const
+    bool Sphere::Hit(const RTTRay& ray, const RT::Real tMin, const RT::Real tMax, RTTHitResult& hitResult) const
     {
         /*
          * Equation for a sphere centered at C(Cx, Cy, Cz) is (X - Cx)^2 + (Y - Cy)^2 + (Z - Cz)^2 = r^2.
@@ -49,29 +51,12 @@ namespace RTObject
          * If D > 0, the ray hits sphere at two points,
          * if D = 0, the ray hits sphere at one point, and
          * if D < 0, the ray does not hit sphere at all.
+         *
+         * IntersectSphere solves it in a form that also holds up in float, see below.
          */
 
-        const RTTVector3 oc(ray.Origin() - center);
-        const double a = ray.Direction().LengthSquared();
-        const double b = 2.0 * Dot(oc, ray.Direction());
-        const double c = oc.LengthSquared() - radius * radius;
-        const double discriminant = b * b - 4 * a * c;
-
-        if (discriminant < 0) return false;
-
-        const double left = -b / (2.0 * a);
-        const double right = std::sqrt(discriminant) / (2.0 * a);
-
-        // Find the nearest root that lies between t min and t max
-        double root = left - right;
-        if (root < tMin || tMax < root)
-        {
-            root = left + right;
-            if (root < tMin || tMax < root)
-            {
-                return false;
-            }
-        }
+        RT::Real root;
+        if (!IntersectSphere(ray, center, radius, tMin, tMax, root)) return false;
 
         hitResult.t = root;
         hitResult.point = ray.At(hitResult.t);
@@ -80,4 +65,58 @@ namespace RTObject
 
         return true;
     }
+
+    bool Sphere::Occluded(const RTTRay& ray, const RT::Real tMin, const RT::Real tMax) const
+    {
+        RT::Real root;
+        return IntersectSphere(ray, center, radius, tMin, tMax, root);
+    }
+
+    bool Sphere::BoundingBox(RTTAABB& outBox) const
+    {
+        const RTTVector3 extent(radius, radius, radius);
+        outBox = RTTAABB(center - extent, center + extent);
+        return true;
+    }
+
+    template <typename T>
+    bool IntersectSphere(const RTType::TRay<T>& ray, const RTType::TVector3<T>& center, const T radius, const T tMin, const T tMax, T& t)
+    {
+        /*
+         * The textbook solution loses most of its digits in float in two places:
+         *	D = b^2 - 4 * a * c subtracts two nearly equal numbers when the sphere is small against its distance, and
+         *	(-b + sqrt(D)) / (2 * a) cancels for the root near 0, which is the one a ray leaving a surface meets.
+         * With h = b / 2 = B * (A - C), D / 4 = h^2 - a * c is rewritten with the vector l from the point of the line
+         * closest to C to A - C, whose squared length is (A - C)^2 - h^2 / a, as
+         *	D / 4 = a * (r^2 - l^2),
+         * and the roots are taken as q / a and c / q with q = -(h + sign(h) * sqrt(D / 4)), which never cancels
+         * (Haines et al., "Precision Improvements for Ray/Sphere Intersection", Ray Tracing Gems, 2019).
+         */
+        const RTType::TVector3<T>& direction = ray.Direction();
+        const RTType::TVector3<T> oc = ray.Origin() - center;
+        const T a = direction.LengthSquared();
+        const T halfB = Dot(oc, direction);
+        const T c = oc.LengthSquared() - radius * radius;
+
+        const RTType::TVector3<T> l = oc - (halfB / a) * direction;
+        const T discriminant = a * (radius * radius - l.LengthSquared());
+        if (discriminant < 0) return false;
+
+        const T q = -(halfB + std::copysign(std::sqrt(discriminant), halfB));
+        T rootNear = c / q;
+        T rootFar = q / a;
+        if (rootFar < rootNear) std::swap(rootNear, rootFar);
+
+        // Find the nearest root that lies between t min and t max, written so that a NaN root fails both tests
+        if (!(tMin <= rootNear && rootNear <= tMax))
+        {
+            rootNear = rootFar;
+            if (!(tMin <= rootNear && rootNear <= tMax)) return false;
+        }
+        t = rootNear;
+        return true;
+    }
+
+    template bool IntersectSphere<float>(const RTType::TRay<float>&, const RTType::TVector3<float>&, float, float, float, float&);
+    template bool IntersectSphere<double>(const RTType::TRay<double>&, const RTType::TVector3<double>&, double, double, double, double&);
 }
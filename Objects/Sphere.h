@@ -8,13 +8,22 @@ namespace RTObject
     {
     public:
         RTTPoint3 center;
-        double radius{};
-        std::shared_ptr<RTTMaterial> material;
+        RT::Real radius{};
+        const RTTMaterial* material = nullptr;
 
     public:
         Sphere();
-        Sphere(RTTPoint3 inCenter, double inRadius, std::shared_ptr<RTTMaterial> inMaterial);
+        Sphere(RTTPoint3 inCenter, RT::Real inRadius, const RTTMaterial* inMaterial);
 
-        bool Hit(const RTTRay& ray, double tMin, double tMax, RTTHitResult& hitResult) const override;
+        bool Hit(const RTTRay& ray, RT::Real tMin, RT::Real tMax, RTTHitResult& hitResult) const override;
+        bool BoundingBox(RTTAABB& outBox) const override;
+        bool Occluded(const RTTRay& ray, RT::Real tMin, RT::Real tMax) const override;
     };
+
+    /*
+     * Nearest distance t in [tMin, tMax] at which the ray meets the sphere, in either precision.
+     * Written to stay accurate in float, see Sphere.cpp. Returns false and leaves t alone on a miss.
+     */
+    template <typename T>
+    bool IntersectSphere(const RTType::TRay<T>& ray, const RTType::TVector3<T>& center, T radius, T tMin, T tMax, T& t);
 }
@@ -0,0 +1,380 @@
+#include "SphereGroup.h"
+
+#include "Sphere.h"
+
+#include "Common/CpuFeatures.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(RT_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    using Real = RT::Real;
+
+    struct SphereArrays
+    {
+        const Real* centerX;
+        const Real* centerY;
+        const Real* centerZ;
+        const Real* radiusSquared;
+        size_t count;
+    };
+
+    /*
+     * Every kernel solves the sphere quadratic the way IntersectSphere does, which keeps its digits in float:
+     *	a = B^2, h = B * (A - C), c = (A - C)^2 - r^2, l = (A - C) - h / a * B,
+     *	D = a * (r^2 - l^2), q = -(h + sign(h) * sqrt(D)), t = c / q or q / a,
+     * keeps the nearest root in [tMin, tClosest] per lane, and returns the index of the closest sphere or -1.
+     * The any-hit instances return the first sphere hit instead, without going on to the others.
+     */
+    using ClosestHitKernel = int (*)(const SphereArrays& spheres, const RTTRay& ray, Real tMin, Real& tClosest);
+
+    template <bool isAnyHit>
+    int ClosestHitScalar(const SphereArrays& spheres, const RTTRay& ray, const Real tMin, Real& tClosest)
+    {
+        const RTTPoint3& origin = ray.Origin();
+        const RTTVector3& direction = ray.Direction();
+        const Real a = direction.LengthSquared();
+        const Real inverseA = 1 / a;
+
+        int closestIndex = -1;
+        for (size_t i = 0; i < spheres.count; ++i)
+        {
+            const Real ocX = origin.x - spheres.centerX[i];
+            const Real ocY = origin.y - spheres.centerY[i];
+            const Real ocZ = origin.z - spheres.centerZ[i];
+            const Real halfB = ocX * direction.x + ocY * direction.y + ocZ * direction.z;
+            const Real c = ocX * ocX + ocY * ocY + ocZ * ocZ - spheres.radiusSquared[i];
+
+            const Real lineT = halfB * inverseA;
+            const Real lX = ocX - lineT * direction.x;
+            const Real lY = ocY - lineT * direction.y;
+            const Real lZ = ocZ - lineT * direction.z;
+            const Real discriminant = a * (spheres.radiusSquared[i] - (lX * lX + lY * lY + lZ * lZ));
+            if (!(discriminant >= 0)) continue;
+
+            const Real q = -(halfB + std::copysign(std::sqrt(discriminant), halfB));
+            const Real t0 = c / q;
+            const Real t1 = q * inverseA;
+            Real t = std::min(t0, t1);
+            if (!(tMin <= t && t <= tClosest))
+            {
+                t = std::max(t0, t1);
+                if (!(tMin <= t && t <= tClosest)) continue;
+            }
+            tClosest = t;
+            closestIndex = static_cast<int>(i);
+            if constexpr (isAnyHit) break;
+        }
+        return closestIndex;
+    }
+
+#if defined(RT_X86)
+    /*
+     * One register of lanes for an instruction set and precision. The kernels are written against these,
+     * so the same kernel compiles to 2 or 4 double lanes and 4 or 8 float lanes.
+     */
+    template <typename T>
+    struct Sse2Lanes;
+
+    template <>
+    struct Sse2Lanes<double>
+    {
+        using Vector = __m128d;
+        static constexpr int width = 2;
+
+        RT_TARGET_SSE2 static Vector Set(const double value) { return _mm_set1_pd(value); }
+        RT_TARGET_SSE2 static Vector Load(const double* values) { return _mm_loadu_pd(values); }
+        RT_TARGET_SSE2 static void Store(double* values, const Vector v) { _mm_storeu_pd(values, v); }
+        RT_TARGET_SSE2 static Vector Indices() { return _mm_set_pd(1.0, 0.0); }
+        RT_TARGET_SSE2 static Vector Add(const Vector a, const Vector b) { return _mm_add_pd(a, b); }
+        RT_TARGET_SSE2 static Vector Sub(const Vector a, const Vector b) { return _mm_sub_pd(a, b); }
+        RT_TARGET_SSE2 static Vector Mul(const Vector a, const Vector b) { return _mm_mul_pd(a, b); }
+        RT_TARGET_SSE2 static Vector MulAdd(const Vector a, const Vector b, const Vector c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        RT_TARGET_SSE2 static Vector Div(const Vector a, const Vector b) { return _mm_div_pd(a, b); }
+        RT_TARGET_SSE2 static Vector Sqrt(const Vector a) { return _mm_sqrt_pd(a); }
+        RT_TARGET_SSE2 static Vector Min(const Vector a, const Vector b) { return _mm_min_pd(a, b); }
+        RT_TARGET_SSE2 static Vector Max(const Vector a, const Vector b) { return _mm_max_pd(a, b); }
+        RT_TARGET_SSE2 static Vector And(const Vector a, const Vector b) { return _mm_and_pd(a, b); }
+        RT_TARGET_SSE2 static Vector Or(const Vector a, const Vector b) { return _mm_or_pd(a, b); }
+        RT_TARGET_SSE2 static Vector GreaterEqual(const Vector a, const Vector b) { return _mm_cmpge_pd(a, b); }
+        RT_TARGET_SSE2 static Vector LessEqual(const Vector a, const Vector b) { return _mm_cmple_pd(a, b); }
+        RT_TARGET_SSE2 static Vector Select(const Vector mask, const Vector ifTrue, const Vector ifFalse) { return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse)); }
+        RT_TARGET_SSE2 static bool Any(const Vector mask) { return _mm_movemask_pd(mask) != 0; }
+    };
+
+    template <>
+    struct Sse2Lanes<float>
+    {
+        using Vector = __m128;
+        static constexpr int width = 4;
+
+        RT_TARGET_SSE2 static Vector Set(const float value) { return _mm_set1_ps(value); }
+        RT_TARGET_SSE2 static Vector Load(const float* values) { return _mm_loadu_ps(values); }
+        RT_TARGET_SSE2 static void Store(float* values, const Vector v) { _mm_storeu_ps(values, v); }
+        RT_TARGET_SSE2 static Vector Indices() { return _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f); }
+        RT_TARGET_SSE2 static Vector Add(const Vector a, const Vector b) { return _mm_add_ps(a, b); }
+        RT_TARGET_SSE2 static Vector Sub(const Vector a, const Vector b) { return _mm_sub_ps(a, b); }
+        RT_TARGET_SSE2 static Vector Mul(const Vector a, const Vector b) { return _mm_mul_ps(a, b); }
+        RT_TARGET_SSE2 static Vector MulAdd(const Vector a, const Vector b, const Vector c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        RT_TARGET_SSE2 static Vector Div(const Vector a, const Vector b) { return _mm_div_ps(a, b); }
+        RT_TARGET_SSE2 static Vector Sqrt(const Vector a) { return _mm_sqrt_ps(a); }
+        RT_TARGET_SSE2 static Vector Min(const Vector a, const Vector b) { return _mm_min_ps(a, b); }
+        RT_TARGET_SSE2 static Vector Max(const Vector a, const Vector b) { return _mm_max_ps(a, b); }
+        RT_TARGET_SSE2 static Vector And(const Vector a, const Vector b) { return _mm_and_ps(a, b); }
+        RT_TARGET_SSE2 static Vector Or(const Vector a, const Vector b) { return _mm_or_ps(a, b); }
+        RT_TARGET_SSE2 static Vector GreaterEqual(const Vector a, const Vector b) { return _mm_cmpge_ps(a, b); }
+        RT_TARGET_SSE2 static Vector LessEqual(const Vector a, const Vector b) { return _mm_cmple_ps(a, b); }
+        RT_TARGET_SSE2 static Vector Select(const Vector mask, const Vector ifTrue, const Vector ifFalse) { return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse)); }
+        RT_TARGET_SSE2 static bool Any(const Vector mask) { return _mm_movemask_ps(mask) != 0; }
+    };
+
+    template <typename T>
+    struct Avx2Lanes;
+
+    template <>
+    struct Avx2Lanes<double>
+    {
+        using Vector = __m256d;
+        static constexpr int width = 4;
+
+        RT_TARGET_AVX2 static Vector Set(const double value) { return _mm256_set1_pd(value); }
+        RT_TARGET_AVX2 static Vector Load(const double* values) { return _mm256_loadu_pd(values); }
+        RT_TARGET_AVX2 static void Store(double* values, const Vector v) { _mm256_storeu_pd(values, v); }
+        RT_TARGET_AVX2 static Vector Indices() { return _mm256_set_pd(3.0, 2.0, 1.0, 0.0); }
+        RT_TARGET_AVX2 static Vector Add(const Vector a, const Vector b) { return _mm256_add_pd(a, b); }
+        RT_TARGET_AVX2 static Vector Sub(const Vector a, const Vector b) { return _mm256_sub_pd(a, b); }
+        RT_TARGET_AVX2 static Vector Mul(const Vector a, const Vector b) { return _mm256_mul_pd(a, b); }
+        RT_TARGET_AVX2 static Vector MulAdd(const Vector a, const Vector b, const Vector c) { return _mm256_fmadd_pd(a, b, c); }
+        RT_TARGET_AVX2 static Vector Div(const Vector a, const Vector b) { return _mm256_div_pd(a, b); }
+        RT_TARGET_AVX2 static Vector Sqrt(const Vector a) { return _mm256_sqrt_pd(a); }
+        RT_TARGET_AVX2 static Vector Min(const Vector a, const Vector b) { return _mm256_min_pd(a, b); }
+        RT_TARGET_AVX2 static Vector Max(const Vector a, const Vector b) { return _mm256_max_pd(a, b); }
+        RT_TARGET_AVX2 static Vector And(const Vector a, const Vector b) { return _mm256_and_pd(a, b); }
+        RT_TARGET_AVX2 static Vector Or(const Vector a, const Vector b) { return _mm256_or_pd(a, b); }
+        RT_TARGET_AVX2 static Vector GreaterEqual(const Vector a, const Vector b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+        RT_TARGET_AVX2 static Vector LessEqual(const Vector a, const Vector b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+        RT_TARGET_AVX2 static Vector Select(const Vector mask, const Vector ifTrue, const Vector ifFalse) { return _mm256_blendv_pd(ifFalse, ifTrue, mask); }
+        RT_TARGET_AVX2 static bool Any(const Vector mask) { return _mm256_movemask_pd(mask) != 0; }
+    };
+
+    template <>
+    struct Avx2Lanes<float>
+    {
+        using Vector = __m256;
+        static constexpr int width = 8;
+
+        RT_TARGET_AVX2 static Vector Set(const float value) { return _mm256_set1_ps(value); }
+        RT_TARGET_AVX2 static Vector Load(const float* values) { return _mm256_loadu_ps(values); }
+        RT_TARGET_AVX2 static void Store(float* values, const Vector v) { _mm256_storeu_ps(values, v); }
+        RT_TARGET_AVX2 static Vector Indices() { return _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f); }
+        RT_TARGET_AVX2 static Vector Add(const Vector a, const Vector b) { return _mm256_add_ps(a, b); }
+        RT_TARGET_AVX2 static Vector Sub(const Vector a, const Vector b) { return _mm256_sub_ps(a, b); }
+        RT_TARGET_AVX2 static Vector Mul(const Vector a, const Vector b) { return _mm256_mul_ps(a, b); }
+        RT_TARGET_AVX2 static Vector MulAdd(const Vector a, const Vector b, const Vector c) { return _mm256_fmadd_ps(a, b, c); }
+        RT_TARGET_AVX2 static Vector Div(const Vector a, const Vector b) { return _mm256_div_ps(a, b); }
+        RT_TARGET_AVX2 static Vector Sqrt(const Vector a) { return _mm256_sqrt_ps(a); }
+        RT_TARGET_AVX2 static Vector Min(const Vector a, const Vector b) { return _mm256_min_ps(a, b); }
+        RT_TARGET_AVX2 static Vector Max(const Vector a, const Vector b) { return _mm256_max_ps(a, b); }
+        RT_TARGET_AVX2 static Vector And(const Vector a, const Vector b) { return _mm256_and_ps(a, b); }
+        RT_TARGET_AVX2 static Vector Or(const Vector a, const Vector b) { return _mm256_or_ps(a, b); }
+        RT_TARGET_AVX2 static Vector GreaterEqual(const Vector a, const Vector b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+        RT_TARGET_AVX2 static Vector LessEqual(const Vector a, const Vector b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        RT_TARGET_AVX2 static Vector Select(const Vector mask, const Vector ifTrue, const Vector ifFalse) { return _mm256_blendv_ps(ifFalse, ifTrue, mask); }
+        RT_TARGET_AVX2 static bool Any(const Vector mask) { return _mm256_movemask_ps(mask) != 0; }
+    };
+
+    /*
+     * The target attribute names the instruction set and cannot be a template parameter, so the SSE2 and AVX2 kernels
+     * are one body expanded under each attribute
+     */
+#define RT_SPHERE_GROUP_KERNEL(name, target) \
+    template <typename Lanes, bool isAnyHit> \
+    target int name(const SphereArrays& spheres, const RTTRay& ray, const Real tMin, Real& tClosest) \
+    { \
+        using Vector = typename Lanes::Vector; \
+ \
+        const RTTPoint3& origin = ray.Origin(); \
+        const RTTVector3& direction = ray.Direction(); \
+        const Real lengthSquared = direction.LengthSquared(); \
+ \
+        const Vector originX = Lanes::Set(origin.x), originY = Lanes::Set(origin.y), originZ = Lanes::Set(origin.z); \
+        const Vector directionX = Lanes::Set(direction.x), directionY = Lanes::Set(direction.y), directionZ = Lanes::Set(direction.z); \
+        const Vector a = Lanes::Set(lengthSquared); \
+        const Vector inverseA = Lanes::Set(1 / lengthSquared); \
+        const Vector minimum = Lanes::Set(tMin); \
+        const Vector zero = Lanes::Set(0); \
+        const Vector signBit = Lanes::Set(-Real(0)); \
+ \
+        Vector best = Lanes::Set(tClosest); \
+        Vector bestIndex = Lanes::Set(-1); \
+        Vector index = Lanes::Indices(); \
+        const Vector indexStep = Lanes::Set(Lanes::width); \
+ \
+        for (size_t i = 0; i < spheres.count; i += Lanes::width, index = Lanes::Add(index, indexStep)) \
+        { \
+            const Vector ocX = Lanes::Sub(originX, Lanes::Load(spheres.centerX + i)); \
+            const Vector ocY = Lanes::Sub(originY, Lanes::Load(spheres.centerY + i)); \
+            const Vector ocZ = Lanes::Sub(originZ, Lanes::Load(spheres.centerZ + i)); \
+            const Vector radiusSquared = Lanes::Load(spheres.radiusSquared + i); \
+ \
+            const Vector halfB = Lanes::MulAdd(ocZ, directionZ, Lanes::MulAdd(ocY, directionY, Lanes::Mul(ocX, directionX))); \
+            const Vector ocSquared = Lanes::MulAdd(ocZ, ocZ, Lanes::MulAdd(ocY, ocY, Lanes::Mul(ocX, ocX))); \
+            const Vector c = Lanes::Sub(ocSquared, radiusSquared); \
+ \
+            const Vector lineT = Lanes::Mul(halfB, inverseA); \
+            const Vector lX = Lanes::Sub(ocX, Lanes::Mul(lineT, directionX)); \
+            const Vector lY = Lanes::Sub(ocY, Lanes::Mul(lineT, directionY)); \
+            const Vector lZ = Lanes::Sub(ocZ, Lanes::Mul(lineT, directionZ)); \
+            const Vector lSquared = Lanes::MulAdd(lZ, lZ, Lanes::MulAdd(lY, lY, Lanes::Mul(lX, lX))); \
+            const Vector discriminant = Lanes::Mul(a, Lanes::Sub(radiusSquared, lSquared)); \
+ \
+            const Vector isHit = Lanes::GreaterEqual(discriminant, zero); \
+            if (!Lanes::Any(isHit)) continue; \
+ \
+            /* q = -(h + sign(h) * sqrt(D)), the square root is never negative so its sign bit is free */ \
+            const Vector root = Lanes::Sqrt(Lanes::Max(discriminant, zero)); \
+            const Vector q = Lanes::Sub(zero, Lanes::Add(halfB, Lanes::Or(root, Lanes::And(halfB, signBit)))); \
+            const Vector t0 = Lanes::Div(c, q); \
+            const Vector t1 = Lanes::Mul(q, inverseA); \
+            const Vector tNear = Lanes::Min(t0, t1); \
+            const Vector tFar = Lanes::Max(t0, t1); \
+ \
+            const Vector isNearValid = Lanes::And(Lanes::GreaterEqual(tNear, minimum), Lanes::LessEqual(tNear, best)); \
+            const Vector isFarValid = Lanes::And(Lanes::GreaterEqual(tFar, minimum), Lanes::LessEqual(tFar, best)); \
+            const Vector t = Lanes::Select(isNearValid, tNear, tFar); \
+            const Vector isCloser = Lanes::And(isHit, Lanes::Or(isNearValid, isFarValid)); \
+ \
+            /* An occlusion query only takes the lanes of the first register with a hit and stops there */ \
+            if constexpr (isAnyHit) \
+            { \
+                if (!Lanes::Any(isCloser)) continue; \
+            } \
+            best = Lanes::Select(isCloser, t, best); \
+            bestIndex = Lanes::Select(isCloser, index, bestIndex); \
+            if constexpr (isAnyHit) break; \
+        } \
+ \
+        Real bestLanes[Lanes::width], indexLanes[Lanes::width]; \
+        Lanes::Store(bestLanes, best); \
+        Lanes::Store(indexLanes, bestIndex); \
+ \
+        int closestIndex = -1; \
+        for (int lane = 0; lane < Lanes::width; ++lane) \
+        { \
+            if (indexLanes[lane] >= 0 && bestLanes[lane] <= tClosest) \
+            { \
+                tClosest = bestLanes[lane]; \
+                closestIndex = static_cast<int>(indexLanes[lane]); \
+            } \
+        } \
+        return closestIndex; \
+    }
+
+    RT_SPHERE_GROUP_KERNEL(ClosestHitSse2, RT_TARGET_SSE2)
+    RT_SPHERE_GROUP_KERNEL(ClosestHitAvx2, RT_TARGET_AVX2)
+
+#undef RT_SPHERE_GROUP_KERNEL
+#endif
+
+    struct KernelChoice
+    {
+        ClosestHitKernel kernel;
+        ClosestHitKernel anyHitKernel;
+        const char* name;
+    };
+
+    KernelChoice SelectKernel()
+    {
+#if defined(RT_X86)
+        const RT::CpuFeatures& features = RT::GetCpuFeatures();
+        if (features.avx2) return {ClosestHitAvx2<Avx2Lanes<Real>, false>, ClosestHitAvx2<Avx2Lanes<Real>, true>, "AVX2"};
+        if (features.sse2) return {ClosestHitSse2<Sse2Lanes<Real>, false>, ClosestHitSse2<Sse2Lanes<Real>, true>, "SSE2"};
+#endif
+        return {ClosestHitScalar<false>, ClosestHitScalar<true>, "scalar"};
+    }
+
+    const KernelChoice kernelChoice = SelectKernel();
+}
+
+namespace RTObject
+{
+    SphereGroup::SphereGroup(const std::vector<const Sphere*>& spheres)
+        : sphereCount(spheres.size())
+    {
+        // Padding spheres sit at NaN, every comparison against them fails and no lane ever reports them
+        const size_t paddedCount = (sphereCount + laneCount - 1) / laneCount * laneCount;
+        const Real padding = std::numeric_limits<Real>::quiet_NaN();
+        centerX.assign(paddedCount, padding);
+        centerY.assign(paddedCount, padding);
+        centerZ.assign(paddedCount, padding);
+        radiusSquared.assign(paddedCount, padding);
+        radius.reserve(sphereCount);
+        materials.reserve(sphereCount);
+
+        for (size_t i = 0; i < sphereCount; ++i)
+        {
+            const Sphere& sphere = *spheres[i];
+            centerX[i] = sphere.center.x;
+            centerY[i] = sphere.center.y;
+            centerZ[i] = sphere.center.z;
+            radiusSquared[i] = sphere.radius * sphere.radius;
+            radius.push_back(sphere.radius);
+            materials.push_back(sphere.material);
+
+            RTTAABB sphereBox;
+            sphere.BoundingBox(sphereBox);
+            bounds.Expand(sphereBox);
+        }
+    }
+
+    bool SphereGroup::Hit(const RTTRay& ray, const RT::Real tMin, const RT::Real tMax, RTTHitResult& hitResult) const
+    {
+        const SphereArrays arrays{centerX.data(), centerY.data(), centerZ.data(), radiusSquared.data(), centerX.size()};
+
+        Real tClosest = tMax;
+        const int index = kernelChoice.kernel(arrays, ray, tMin, tClosest);
+        if (index < 0) return false;
+
+        const RTTPoint3 center(centerX[index], centerY[index], centerZ[index]);
+        hitResult.t = tClosest;
+        hitResult.point = ray.At(tClosest);
+        hitResult.SetFaceNormal(ray, (hitResult.point - center) / radius[index]);
+        hitResult.material = materials[index];
+        return true;
+    }
+
+    bool SphereGroup::Occluded(const RTTRay& ray, const RT::Real tMin, const RT::Real tMax) const
+    {
+        const SphereArrays arrays{centerX.data(), centerY.data(), centerZ.data(), radiusSquared.data(), centerX.size()};
+
+        Real tClosest = tMax;
+        return kernelChoice.anyHitKernel(arrays, ray, tMin, tClosest) >= 0;
+    }
+
+    bool SphereGroup::BoundingBox(RTTAABB& outBox) const
+    {
+        outBox = bounds;
+        return sphereCount > 0;
+    }
+
+    size_t SphereGroup::Size() const
+    {
+        return sphereCount;
+    }
+
+    size_t SphereGroup::MemorySize() const
+    {
+        return sizeof(SphereGroup) + (centerX.capacity() + centerY.capacity() + centerZ.capacity() + radius.capacity() + radiusSquared.capacity()) * sizeof(RT::Real)
+            + materials.capacity() * sizeof(const RTTMaterial*);
+    }
+
+    const char* SphereGroup::KernelName()
+    {
+        return kernelChoice.name;
+    }
+}
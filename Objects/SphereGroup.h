@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Types/RTTypes.h"
+
+#include <vector>
+
+namespace RTObject
+{
+    class Sphere;
+
+    /*
+     * Small set of spheres stored as structure of arrays, so one ray is tested against several spheres per instruction.
+     * The kernel (AVX2, SSE2 or scalar; 4 and 2 lanes in double, 8 and 4 in float) is picked once at run time from the CPU features,
+     * and the full hit result is built only for the closest sphere. Occlusion queries run the same kernel, stopped at the
+     * first sphere, or register of lanes, that is hit.
+     */
+    class SphereGroup : public RTTHittable
+    {
+    public:
+        // Arrays are padded to a multiple of this, one AVX2 register, with spheres no ray can hit
+        static constexpr int laneCount = static_cast<int>(32 / sizeof(RT::Real));
+
+    private:
+        std::vector<RT::Real> centerX, centerY, centerZ;
+        std::vector<RT::Real> radius;
+        std::vector<RT::Real> radiusSquared;
+        std::vector<const RTTMaterial*> materials;
+        RTTAABB bounds;
+        size_t sphereCount = 0;
+
+    public:
+        explicit SphereGroup(const std::vector<const Sphere*>& spheres);
+
+        bool Hit(const RTTRay& ray, RT::Real tMin, RT::Real tMax, RTTHitResult& hitResult) const override;
+        bool BoundingBox(RTTAABB& outBox) const override;
+        bool Occluded(const RTTRay& ray, RT::Real tMin, RT::Real tMax) const override;
+
+        [[nodiscard]] size_t Size() const;
+        // Bytes of the group and its arrays
+        [[nodiscard]] size_t MemorySize() const;
+
+        // Name of the intersection kernel this CPU runs
+        static const char* KernelName();
+    };
+}
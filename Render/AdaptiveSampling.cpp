@@ -0,0 +1,132 @@
+#include "AdaptiveSampling.h"
+
+#include "Common/Common.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Pixels darker than this are judged as if they were this bright, the gamma curve is too steep near black
+    constexpr double darkLuminance = 0.02;
+}
+
+namespace RTRender
+{
+    AdaptiveSampler::AdaptiveSampler(const int inMinSamples, const int inMaxSamples, const double inTargetError)
+        : minSamples(std::max(1, std::min(inMinSamples, inMaxSamples)))
+          , maxSamples(std::max(1, inMaxSamples))
+          , targetError(inTargetError)
+    {
+    }
+
+    int AdaptiveSampler::GetMinSamples() const
+    {
+        return minSamples;
+    }
+
+    int AdaptiveSampler::GetMaxSamples() const
+    {
+        return maxSamples;
+    }
+
+    bool AdaptiveSampler::IsConverged(const PixelEstimate& estimate) const
+    {
+        if (estimate.sampleCount < minSamples) return false;
+        if (estimate.sampleCount >= maxSamples) return true;
+        if (estimate.sampleCount < 2) return false;
+
+        // Variance of the mean is the sample variance over the sample count
+        const double n = estimate.sampleCount;
+        const double varianceOfMean = estimate.squaredDeviations / ((n - 1.0) * n);
+
+        // Error as it shows after gamma 2: d(sqrt(L)) = dL / (2 sqrt(L))
+        const double displayVariance = varianceOfMean / (4.0 * std::max(estimate.mean, darkLuminance));
+        return displayVariance <= targetError * targetError;
+    }
+
+    void AdaptiveSampler::RenderTile(const Tile& tile, const SampleFunction& renderSample, FrameBuffer& image) const
+    {
+        const int tileWidth = tile.x1 - tile.x0;
+        const int tileHeight = tile.y1 - tile.y0;
+        const size_t pixelCount = static_cast<size_t>(tileWidth) * tileHeight;
+
+        std::vector<RTTColor> sums(pixelCount, RTType::colorBlack);
+        std::vector<PixelEstimate> estimates(pixelCount);
+        std::vector<char> isConverged(pixelCount, 0);
+        std::vector<char> isActive(pixelCount, 1);
+
+        // Rounds of minSamples more samples for every pixel that is still active
+        bool isAnyActive = true;
+        while (isAnyActive)
+        {
+            for (int ty = 0; ty < tileHeight; ++ty)
+            {
+                for (int tx = 0; tx < tileWidth; ++tx)
+                {
+                    const size_t local = static_cast<size_t>(ty) * tileWidth + tx;
+                    if (!isActive[local]) continue;
+
+                    PixelEstimate& estimate = estimates[local];
+                    const int end = std::min(maxSamples, estimate.sampleCount + minSamples);
+                    while (estimate.sampleCount < end)
+                    {
+                        const RTTColor sample = renderSample(tile.x0 + tx, tile.y0 + ty, estimate.sampleCount);
+                        sums[local] += sample;
+                        estimate.Add(sample);
+                    }
+                    isConverged[local] = IsConverged(estimate);
+                }
+            }
+
+            // A pixel keeps sampling while any neighbour is noisy, single lucky estimates do not stop a noisy region
+            isAnyActive = false;
+            for (int ty = 0; ty < tileHeight; ++ty)
+            {
+                for (int tx = 0; tx < tileWidth; ++tx)
+                {
+                    const size_t local = static_cast<size_t>(ty) * tileWidth + tx;
+                    bool isNoisy = false;
+                    for (int ny = std::max(0, ty - 1); ny <= std::min(tileHeight - 1, ty + 1); ++ny)
+                    {
+                        for (int nx = std::max(0, tx - 1); nx <= std::min(tileWidth - 1, tx + 1); ++nx)
+                        {
+                            isNoisy |= !isConverged[static_cast<size_t>(ny) * tileWidth + nx];
+                        }
+                    }
+                    isActive[local] = isNoisy && estimates[local].sampleCount < maxSamples;
+                    isAnyActive |= isActive[local];
+                }
+            }
+        }
+
+        for (int ty = 0; ty < tileHeight; ++ty)
+        {
+            for (int tx = 0; tx < tileWidth; ++tx)
+            {
+                const size_t local = static_cast<size_t>(ty) * tileWidth + tx;
+                const int i = tile.x0 + tx, y = tile.y0 + ty;
+                RTType::WriteColor(image.Pixel(i, y), sums[local], estimates[local].sampleCount);
+                image.SampleCount(i, y) = static_cast<uint16_t>(estimates[local].sampleCount);
+            }
+        }
+    }
+
+    void AdaptiveSampler::SampleHeatmap(const FrameBuffer& image, FrameBuffer& outHeatmap) const
+    {
+        const double range = std::max(1, maxSamples - minSamples);
+        for (int y = image.GetFirstRow(); y < image.GetEndRow(); ++y)
+        {
+            for (int i = 0; i < image.GetWidth(); ++i)
+            {
+                const double t = (image.SampleCount(i, y) - minSamples) / range;
+                const double r = RT::Clamp(3.0 * t, 0.0, 1.0);
+                const double g = RT::Clamp(3.0 * t - 1.0, 0.0, 1.0);
+                const double b = RT::Clamp(3.0 * t - 2.0, 0.0, 1.0);
+                float* pixel = outHeatmap.Pixel(i, y);
+                pixel[0] = static_cast<float>(r * r);
+                pixel[1] = static_cast<float>(g * g);
+                pixel[2] = static_cast<float>(b * b);
+            }
+        }
+    }
+}
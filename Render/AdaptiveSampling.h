@@ -0,0 +1,69 @@
+#pragma once
+
+#include "FrameBuffer.h"
+#include "TileScheduler.h"
+
+#include "Types/RTTypes.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace RTRender
+{
+    // Running mean and variance of the luminance of one pixel's samples (Welford's algorithm)
+    struct PixelEstimate
+    {
+        int sampleCount{};
+        double mean{};
+        double squaredDeviations{};
+
+        void Add(const RTTColor& sample)
+        {
+            const double luminance = 0.2126 * sample.x + 0.7152 * sample.y + 0.0722 * sample.z;
+            ++sampleCount;
+            const double delta = luminance - mean;
+            mean += delta / sampleCount;
+            squaredDeviations += delta * (luminance - mean);
+        }
+    };
+
+    /*
+     * Stopping rule for per-pixel adaptive sampling. Every pixel takes at least minSamples samples, then keeps
+     * sampling until the standard error of its mean luminance, after gamma correction, drops below targetError
+     * (on a 0..1 display scale) or maxSamples is reached. Flat pixels stop early and the budget goes to the noisy ones.
+     */
+    class AdaptiveSampler
+    {
+    public:
+        // Color of one sample of pixel (i, y), rows counted from the top of the image
+        using SampleFunction = std::function<RTTColor(int i, int y, int sample)>;
+
+    private:
+        int minSamples;
+        int maxSamples;
+        double targetError;
+
+    public:
+        AdaptiveSampler(int inMinSamples, int inMaxSamples, double inTargetError);
+
+        [[nodiscard]] int GetMinSamples() const;
+        [[nodiscard]] int GetMaxSamples() const;
+
+        [[nodiscard]] bool IsConverged(const PixelEstimate& estimate) const;
+
+        /*
+         * Sample a tile in rounds of minSamples samples per pixel. After each round a pixel stays active while it
+         * or one of its eight neighbours has not converged, so a pixel that got a few lucky samples in a noisy
+         * region keeps sampling. Writes the average color and the sample count of every pixel.
+         */
+        void RenderTile(const Tile& tile, const SampleFunction& renderSample, FrameBuffer& image) const;
+
+        /*
+         * Linear RGB image of samples per pixel, from black at minSamples through red and yellow to white at maxSamples.
+         * Values are squared so the gamma 2 of the image writer shows the ramp linearly. Covers the band of image,
+         * which outHeatmap must hold as well.
+         */
+        void SampleHeatmap(const FrameBuffer& image, FrameBuffer& outHeatmap) const;
+    };
+}
@@ -0,0 +1,119 @@
+#include "Animation.h"
+
+#include "Common/Common.h"
+
+#include <chrono>
+
+namespace RTRender
+{
+    FrameWriterThread::FrameWriterThread()
+        : thread(&FrameWriterThread::Loop, this)
+    {
+    }
+
+    FrameWriterThread::~FrameWriterThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping = true;
+        }
+        condition.notify_all();
+        thread.join();
+    }
+
+    double FrameWriterThread::Write(const FrameBuffer& inImage, const std::string& inPath, const ImageFormat inFormat)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return image == nullptr; });
+        const double waitSeconds = RT::SecondsSince(start);
+        image = &inImage;
+        path = inPath;
+        format = inFormat;
+        condition.notify_all();
+        return waitSeconds;
+    }
+
+    bool FrameWriterThread::Wait(std::ostream& errorOut)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return image == nullptr; });
+        if (failedPaths.empty()) return true;
+
+        errorOut << "Failed to write" << failedPaths << ".\n";
+        failedPaths.clear();
+        return false;
+    }
+
+    void FrameWriterThread::Loop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            // A frame handed over before stopping is still written
+            condition.wait(lock, [this] { return isStopping || image != nullptr; });
+            if (image == nullptr) return;
+
+            const FrameBuffer& frame = *image;
+            const std::string framePath = path;
+            const ImageFormat frameFormat = format;
+            lock.unlock();
+            ImageWriter writer(framePath, frameFormat, frame);
+            const bool isWritten = writer.IsOpen() && writer.Finish();
+            lock.lock();
+
+            if (!isWritten)
+            {
+                failedPaths += " " + framePath;
+            }
+            image = nullptr;
+            condition.notify_all();
+        }
+    }
+
+    void AnimationStats::Print(std::ostream& out) const
+    {
+        out << "Animation: " << frameCount << " frames in " << wallSeconds << " s, " << frameCount / wallSeconds << " frames/s, "
+            << primaryRays / wallSeconds / 1e6 << " M primary rays/s, " << writeWaitSeconds << " s waiting for frames to be written\n";
+        scheduler.Print(out);
+    }
+
+    bool RenderAnimation(const RT::Settings& settings, const RTObject::CameraPath& cameraPath, FrameRenderer& renderer, AnimationStats& outStats, std::ostream& log)
+    {
+        ImageFormat format = ImageWriter::FormatFromPath(settings.outputPath);
+        if (!settings.outputFormat.empty())
+        {
+            ImageWriter::FormatFromName(settings.outputFormat, format);
+        }
+
+        // Frame f is traced into one buffer while frame f - 1 is written from the other
+        const bool isAdaptive = renderer.IsAdaptive();
+        FrameBuffer frames[2] = {
+            FrameBuffer(settings.imageWidth, settings.imageHeight, 0, isAdaptive),
+            FrameBuffer(settings.imageWidth, settings.imageHeight, 0, isAdaptive)
+        };
+        FrameWriterThread writer;
+
+        outStats = AnimationStats();
+        outStats.frameCount = settings.frameCount;
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < settings.frameCount; ++frame)
+        {
+            FrameBuffer& image = frames[frame % 2];
+            const auto frameStart = std::chrono::steady_clock::now();
+            renderer.SetCamera(cameraPath.FrameView(frame, settings.frameCount).ToCamera(settings.AspectRatio()));
+            outStats.scheduler += renderer.RenderRows(image, 0, settings.imageHeight);
+            const double traceSeconds = RT::SecondsSince(frameStart);
+
+            outStats.primaryRays += isAdaptive ? static_cast<double>(image.SampleTotal())
+                : static_cast<double>(settings.PixelCount()) * settings.samplesPerPixel;
+
+            const std::string path = settings.FramePath(frame);
+            outStats.writeWaitSeconds += writer.Write(image, path, format);
+            log << "Frame " << frame + 1 << "/" << settings.frameCount << ": traced in " << traceSeconds << " s, writing " << path << "\n";
+        }
+        const bool isWritten = writer.Wait(log);
+        outStats.wallSeconds = RT::SecondsSince(start);
+        return isWritten;
+    }
+}
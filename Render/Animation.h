@@ -0,0 +1,72 @@
+#pragma once
+
+#include "FrameBuffer.h"
+#include "FrameRenderer.h"
+#include "ImageWriter.h"
+#include "TileScheduler.h"
+
+#include "Common/Settings.h"
+#include "Objects/CameraPath.h"
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace RTRender
+{
+    /*
+     * Encodes and writes whole frames on a thread of its own, so writing one frame overlaps tracing the next.
+     * Write() hands over a finished frame buffer, which must stay unchanged until the following Write() or Wait()
+     * returns: with two frame buffers used in turn, the renderer never waits for a frame that is still being written
+     * unless writing is slower than tracing.
+     */
+    class FrameWriterThread
+    {
+    private:
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable condition;
+        const FrameBuffer* image = nullptr;
+        std::string path;
+        ImageFormat format = ImageFormat::PPM;
+        bool isStopping = false;
+        std::string failedPaths;
+
+    public:
+        FrameWriterThread();
+        ~FrameWriterThread();
+
+        FrameWriterThread(const FrameWriterThread&) = delete;
+        FrameWriterThread& operator=(const FrameWriterThread&) = delete;
+
+        // Wait until the frame before is written, then start writing this one; returns the seconds spent waiting
+        double Write(const FrameBuffer& inImage, const std::string& inPath, ImageFormat inFormat);
+
+        // Wait until the last frame is written; false, with the paths on errorOut, when any frame failed to write
+        bool Wait(std::ostream& errorOut);
+
+    private:
+        void Loop();
+    };
+
+    struct AnimationStats
+    {
+        int frameCount{};
+        double wallSeconds{};
+        // Time the renderer waited for the writer thread, the part of writing that did not overlap tracing
+        double writeWaitSeconds{};
+        double primaryRays{};
+        TileScheduler::Stats scheduler;
+
+        void Print(std::ostream& out) const;
+    };
+
+    /*
+     * Render settings.frameCount frames along a camera path with the scene, BVH and worker pool of the renderer,
+     * which stay resident from frame to frame. Frame f is written to settings.FramePath(f) while frame f + 1 is traced.
+     * Frames are whole images, --band-rows and the sample heat map do not apply.
+     */
+    bool RenderAnimation(const RT::Settings& settings, const RTObject::CameraPath& cameraPath, FrameRenderer& renderer, AnimationStats& outStats, std::ostream& log);
+}
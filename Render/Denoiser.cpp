@@ -0,0 +1,276 @@
+#include "Denoiser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    // Coefficients of the B3 spline, the 5x5 kernel is their outer product
+    constexpr float splineWeights[5] = {1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f};
+    // Albedo below this is clamped before it is divided out, so black surfaces do not blow up their lighting
+    constexpr float minAlbedo = 0.01f;
+
+    /*
+     * e^x for x <= 0 to about 1e-4 relative, without branches or calls so loops over it vectorize: x / ln 2 is split
+     * into an integer, placed in the exponent bits, and a fraction in (-1, 0] whose power of two is a polynomial.
+     */
+    inline float FastExp(const float x)
+    {
+        const float exponent = std::max(x, -80.0f) * 1.44269504f;
+        const int32_t integer = static_cast<int32_t>(exponent);
+        const float t = (exponent - static_cast<float>(integer)) * 0.69314718f;
+        const float fraction = 1.0f + t * (1.0f + t * (0.5f + t * (1.0f / 6.0f + t * (1.0f / 24.0f + t * (1.0f / 120.0f)))));
+        const int32_t bits = (integer + 127) << 23;
+        float scale;
+        std::memcpy(&scale, &bits, sizeof(scale));
+        return scale * fraction;
+    }
+
+    // Run rowFunction(y, workerId) for every row, rows handed out to the workers one at a time
+    template <typename RowFunction>
+    void ForEachRow(RTRender::WorkerPool& pool, const int height, const RowFunction& rowFunction)
+    {
+        std::atomic<int> nextRow{0};
+        pool.Run([&](const int workerId)
+        {
+            for (int y = nextRow.fetch_add(1, std::memory_order_relaxed); y < height; y = nextRow.fetch_add(1, std::memory_order_relaxed))
+            {
+                rowFunction(y, workerId);
+            }
+        });
+    }
+
+    /*
+     * Planes of one image, each row padded on both sides with copies of its edge pixels, so the taps of the widest
+     * iteration can be read past the left and right edges without a test per pixel. Rows past the top and bottom
+     * are clamped per tap instead.
+     */
+    class PaddedPlanes
+    {
+    private:
+        int width;
+        int height;
+        int padding;
+        size_t stride;
+        std::vector<float> values;
+
+    public:
+        PaddedPlanes(const int inWidth, const int inHeight, const int inPadding, const int planeCount)
+            : width(inWidth), height(inHeight), padding(inPadding), stride(static_cast<size_t>(inWidth + 2 * inPadding))
+            , values(static_cast<size_t>(planeCount) * static_cast<size_t>(inHeight) * stride)
+        {
+        }
+
+        // Pixel 0 of row y of a plane, y clamped to the image
+        float* Row(const int plane, const int y)
+        {
+            const int clampedY = std::clamp(y, 0, height - 1);
+            return values.data() + (static_cast<size_t>(plane) * static_cast<size_t>(height) + static_cast<size_t>(clampedY)) * stride + static_cast<size_t>(padding);
+        }
+
+        void PadRow(const int plane, const int y)
+        {
+            float* row = Row(plane, y);
+            std::fill(row - padding, row, row[0]);
+            std::fill(row + width, row + width + padding, row[width - 1]);
+        }
+    };
+
+    // Rows of the color and feature planes, from the same pixel on
+    struct PixelRows
+    {
+        const float* red;
+        const float* green;
+        const float* blue;
+        const float* normalX;
+        const float* normalY;
+        const float* normalZ;
+        const float* depth;
+    };
+
+    /*
+     * Add one of the 25 taps to the sums of weighted color and of weights of a row of pixels: the tap of pixel i is
+     * tap[i], at the same offset from center[i] for every pixel. The sums are restrict, so the compiler needs no
+     * run-time overlap tests against the 15 rows read and the loop vectorizes.
+     */
+    void AccumulateTap(const int width, const float kernelWeight, const float colorScale, const float normalScale, const float* depthScale,
+        const PixelRows& center, const PixelRows& tap, float* __restrict sumRed, float* __restrict sumGreen, float* __restrict sumBlue,
+        float* __restrict sumWeight)
+    {
+        for (int i = 0; i < width; ++i)
+        {
+            const float deltaRed = tap.red[i] - center.red[i];
+            const float deltaGreen = tap.green[i] - center.green[i];
+            const float deltaBlue = tap.blue[i] - center.blue[i];
+            const float colorDistance = deltaRed * deltaRed + deltaGreen * deltaGreen + deltaBlue * deltaBlue;
+            const float cosine = tap.normalX[i] * center.normalX[i] + tap.normalY[i] * center.normalY[i] + tap.normalZ[i] * center.normalZ[i];
+            const float normalDistance = std::max(0.0f, 1.0f - cosine);
+            const float depthDistance = std::fabs(tap.depth[i] - center.depth[i]);
+            const float weight = kernelWeight * FastExp(colorDistance * colorScale + normalDistance * normalScale + depthDistance * depthScale[i]);
+            sumRed[i] += weight * tap.red[i];
+            sumGreen[i] += weight * tap.green[i];
+            sumBlue[i] += weight * tap.blue[i];
+            sumWeight[i] += weight;
+        }
+    }
+
+    enum ColorPlane
+    {
+        Red, Green, Blue
+    };
+    enum FeaturePlane
+    {
+        NormalX, NormalY, NormalZ, Depth, FeaturePlaneCount
+    };
+}
+
+namespace RTRender
+{
+    GuideBuffers::GuideBuffers(const int inWidth, const int inHeight)
+        : width(inWidth), height(inHeight)
+        , planes(static_cast<size_t>(PlaneCount) * static_cast<size_t>(inWidth) * static_cast<size_t>(inHeight))
+    {
+    }
+
+    int GuideBuffers::GetWidth() const
+    {
+        return width;
+    }
+
+    int GuideBuffers::GetHeight() const
+    {
+        return height;
+    }
+
+    size_t GuideBuffers::MemorySize() const
+    {
+        return planes.size() * sizeof(float);
+    }
+
+    Denoiser::Denoiser()
+        : Denoiser(Parameters())
+    {
+    }
+
+    Denoiser::Denoiser(const Parameters& inParameters)
+        : parameters(inParameters)
+    {
+    }
+
+    void Denoiser::Denoise(FrameBuffer& image, const GuideBuffers& guides, WorkerPool& pool) const
+    {
+        const int width = image.GetWidth();
+        const int height = image.GetHeight();
+        if (parameters.iterations <= 0 || width <= 0 || height <= 0) return;
+
+        // Taps of the last iteration lie 2 steps of 2^(iterations - 1) pixels from their center
+        const int padding = 1 << parameters.iterations;
+        PaddedPlanes features(width, height, padding, FeaturePlaneCount);
+        PaddedPlanes colors[2] = {PaddedPlanes(width, height, padding, 3), PaddedPlanes(width, height, padding, 3)};
+
+        ForEachRow(pool, height, [&, width](const int y, int)
+        {
+            const float* pixels = image.Row(y);
+            const float* albedo[3] = {guides.Row(GuideBuffers::AlbedoR, y), guides.Row(GuideBuffers::AlbedoG, y), guides.Row(GuideBuffers::AlbedoB, y)};
+            for (int channel = Red; channel <= Blue; ++channel)
+            {
+                float* color = colors[0].Row(channel, y);
+                for (int i = 0; i < width; ++i)
+                {
+                    color[i] = pixels[3 * i + channel] / std::max(albedo[channel][i], minAlbedo);
+                }
+                colors[0].PadRow(channel, y);
+            }
+            const GuideBuffers::Plane guidePlanes[FeaturePlaneCount] = {GuideBuffers::NormalX, GuideBuffers::NormalY, GuideBuffers::NormalZ, GuideBuffers::Depth};
+            for (int plane = NormalX; plane < FeaturePlaneCount; ++plane)
+            {
+                std::copy_n(guides.Row(guidePlanes[plane], y), width, features.Row(plane, y));
+                features.PadRow(plane, y);
+            }
+        });
+
+        // Sums of weighted color and of weights, and the depth tolerance of every pixel of a row, per worker
+        enum ScratchRow
+        {
+            SumRed, SumGreen, SumBlue, SumWeight, DepthScale, ScratchRowCount
+        };
+        std::vector<std::vector<float>> scratch(static_cast<size_t>(pool.GetThreadCount()), std::vector<float>(static_cast<size_t>(ScratchRowCount * width)));
+
+        const float normalScale = -1.0f / parameters.normalSigma;
+        for (int iteration = 0; iteration < parameters.iterations; ++iteration)
+        {
+            const int step = 1 << iteration;
+            const float colorSigma = parameters.colorSigma / (std::sqrt(static_cast<float>(std::max(1, parameters.samplesPerPixel))) * static_cast<float>(step));
+            const float colorScale = -1.0f / (colorSigma * colorSigma);
+            PaddedPlanes& source = colors[iteration % 2];
+            PaddedPlanes& target = colors[(iteration + 1) % 2];
+
+            ForEachRow(pool, height, [&](const int y, const int workerId)
+            {
+                float* sums = scratch[static_cast<size_t>(workerId)].data();
+                float* sumRed = sums + SumRed * width;
+                float* sumGreen = sums + SumGreen * width;
+                float* sumBlue = sums + SumBlue * width;
+                float* sumWeight = sums + SumWeight * width;
+                float* depthScale = sums + DepthScale * width;
+                std::fill(sums, sums + DepthScale * width, 0.0f);
+
+                const PixelRows center = {
+                    source.Row(Red, y), source.Row(Green, y), source.Row(Blue, y),
+                    features.Row(NormalX, y), features.Row(NormalY, y), features.Row(NormalZ, y), features.Row(Depth, y)};
+                for (int i = 0; i < width; ++i)
+                {
+                    depthScale[i] = -1.0f / (parameters.depthSigma * center.depth[i] + 1e-4f);
+                }
+
+                for (int tapY = 0; tapY < 5; ++tapY)
+                {
+                    const int rowY = y + (tapY - 2) * step;
+                    for (int tapX = 0; tapX < 5; ++tapX)
+                    {
+                        const int offset = (tapX - 2) * step;
+                        const PixelRows tap = {
+                            source.Row(Red, rowY) + offset, source.Row(Green, rowY) + offset, source.Row(Blue, rowY) + offset,
+                            features.Row(NormalX, rowY) + offset, features.Row(NormalY, rowY) + offset, features.Row(NormalZ, rowY) + offset,
+                            features.Row(Depth, rowY) + offset};
+                        AccumulateTap(width, splineWeights[tapY] * splineWeights[tapX], colorScale, normalScale, depthScale, center, tap,
+                            sumRed, sumGreen, sumBlue, sumWeight);
+                    }
+                }
+
+                // The center tap has weight e^0, so every sum of weights is positive
+                float* outRed = target.Row(Red, y);
+                float* outGreen = target.Row(Green, y);
+                float* outBlue = target.Row(Blue, y);
+                for (int i = 0; i < width; ++i)
+                {
+                    const float inverseWeight = 1.0f / sumWeight[i];
+                    outRed[i] = sumRed[i] * inverseWeight;
+                    outGreen[i] = sumGreen[i] * inverseWeight;
+                    outBlue[i] = sumBlue[i] * inverseWeight;
+                }
+                for (int channel = Red; channel <= Blue; ++channel)
+                {
+                    target.PadRow(channel, y);
+                }
+            });
+        }
+
+        PaddedPlanes& result = colors[parameters.iterations % 2];
+        ForEachRow(pool, height, [&, width](const int y, int)
+        {
+            for (int channel = Red; channel <= Blue; ++channel)
+            {
+                const float* color = result.Row(channel, y);
+                const float* albedo = guides.Row(static_cast<GuideBuffers::Plane>(GuideBuffers::AlbedoR + channel), y);
+                for (int i = 0; i < width; ++i)
+                {
+                    image.Pixel(i, y)[channel] = color[i] * std::max(albedo[i], minAlbedo);
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "FrameBuffer.h"
+#include "WorkerPool.h"
+
+#include "Common/Config.h"
+#include "Types/RTTypes.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace RTRender
+{
+    /*
+     * Features of the surfaces the camera sees, averaged over the samples of each pixel: albedo, normal and distance
+     * along the camera ray. They come from the first hit of every path, so they cost no rays, and they are nearly free
+     * of noise, which lets the denoiser tell edges from noise. Stored as one float plane per component.
+     */
+    class GuideBuffers
+    {
+    public:
+        // Distance recorded for camera rays that miss the scene
+        static constexpr RT::Real skyDepth = 1e6;
+
+    private:
+        int width;
+        int height;
+        std::vector<float> planes;
+
+    public:
+        enum Plane
+        {
+            AlbedoR, AlbedoG, AlbedoB, NormalX, NormalY, NormalZ, Depth, PlaneCount
+        };
+
+        GuideBuffers(int inWidth, int inHeight);
+
+        [[nodiscard]] int GetWidth() const;
+        [[nodiscard]] int GetHeight() const;
+
+        // Row y of one plane, rows counted from the top of the image
+        [[nodiscard]] const float* Row(const Plane plane, const int y) const
+        {
+            return planes.data() + (static_cast<size_t>(plane) * static_cast<size_t>(height) + static_cast<size_t>(y)) * static_cast<size_t>(width);
+        }
+
+        void Set(const int i, const int y, const RTTColor& albedo, const RTTVector3& normal, const RT::Real depth)
+        {
+            const size_t pixel = static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(i);
+            const size_t planeSize = static_cast<size_t>(width) * static_cast<size_t>(height);
+            const float values[PlaneCount] = {
+                static_cast<float>(albedo.x), static_cast<float>(albedo.y), static_cast<float>(albedo.z),
+                static_cast<float>(normal.x), static_cast<float>(normal.y), static_cast<float>(normal.z), static_cast<float>(depth)};
+            for (int plane = 0; plane < PlaneCount; ++plane)
+            {
+                planes[plane * planeSize + pixel] = values[plane];
+            }
+        }
+
+        // Bytes held for the planes
+        [[nodiscard]] size_t MemorySize() const;
+    };
+
+    /*
+     * Edge-avoiding à-trous wavelet filter of a rendered image (Dammertz et al. 2010). Each iteration blurs with a
+     * 5x5 B3-spline kernel whose taps are spread twice as far apart as in the iteration before, so a few iterations
+     * reach a wide footprint at 25 taps per pixel each. Taps are weighted down where color, normal or depth differ
+     * from the center pixel; the color tolerance halves every iteration, so the fine levels smooth noise and the
+     * coarse ones keep detail. Lighting is filtered with the albedo divided out and multiplied back afterwards, so
+     * textures are not blurred. Rows are shared between the threads of the pool; within a row every tap is one pass
+     * over contiguous floats that the compiler vectorizes.
+     */
+    class Denoiser
+    {
+    public:
+        struct Parameters
+        {
+            int iterations = RT::denoiseIterations;
+            // Samples per pixel of the image: its noise, and the color tolerance, fall with their square root
+            int samplesPerPixel = 1;
+            // Tolerance of the first iteration to differences of demodulated color, at one sample per pixel
+            float colorSigma = 1.75f;
+            // Tolerance to 1 - cos of the angle between normals
+            float normalSigma = 0.2f;
+            // Tolerance to differences of depth, relative to the depth of the center pixel
+            float depthSigma = 0.02f;
+        };
+
+    private:
+        Parameters parameters;
+
+    public:
+        Denoiser();
+        explicit Denoiser(const Parameters& inParameters);
+
+        // Filter the linear colors of the frame buffer, which must hold the whole image the guides were recorded for
+        void Denoise(FrameBuffer& image, const GuideBuffers& guides, WorkerPool& pool) const;
+    };
+}
@@ -0,0 +1,524 @@
+#include "Distributed.h"
+
+#include "AdaptiveSampling.h"
+#include "FrameBuffer.h"
+#include "FrameRenderer.h"
+#include "ImageWriter.h"
+#include "WorkerPool.h"
+
+#include "Common/Common.h"
+#include "Common/Socket.h"
+#include "Objects/SceneFile.h"
+#include "Types/BVH.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+namespace
+{
+    constexpr uint32_t protocolMagic = 0x44525452; // "RTRD"
+    constexpr uint32_t protocolVersion = 1;
+    // Units queued on a worker, so it starts the next one while the result of the last one is on its way
+    constexpr size_t unitsInFlight = 2;
+    // Without --listen, only spawned workers can connect; if none is alive for this long they have failed
+    constexpr double workerWaitSeconds = 10.0;
+
+    enum class MessageType : uint32_t
+    {
+        Hello,  // worker to coordinator: HelloMessage
+        Job,    // coordinator to worker: command line arguments, each ended by '\0'
+        Unit,   // coordinator to worker: UnitMessage
+        Result, // worker to coordinator: UnitMessage, the float RGB rows, then their uint16 sample counts when adaptive
+        Done    // coordinator to worker: no units left
+    };
+
+    struct MessageHeader
+    {
+        uint32_t type;
+        uint32_t reserved;
+        uint64_t size;
+    };
+
+    struct HelloMessage
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t threadCount;
+        uint32_t reserved;
+    };
+
+    struct UnitMessage
+    {
+        uint32_t id;
+        int32_t y0;
+        int32_t y1;
+        // Result only: seconds the worker spent rendering the unit
+        float busySeconds;
+    };
+
+    bool SendMessage(const RT::Socket& socket, const MessageType type, const void* payload, const size_t size)
+    {
+        const MessageHeader header{static_cast<uint32_t>(type), 0, size};
+        return socket.SendAll(&header, sizeof(header)) && (size == 0 || socket.SendAll(payload, size));
+    }
+
+    // Header of the next message, false when the connection is closed
+    bool ReceiveHeader(const RT::Socket& socket, MessageHeader& header)
+    {
+        return socket.ReceiveAll(&header, sizeof(header));
+    }
+
+    // Worker process started on this machine, waited for when the render is over
+    struct SpawnedWorker
+    {
+#ifdef _WIN32
+        HANDLE process = nullptr;
+#else
+        pid_t process = 0;
+#endif
+    };
+
+    bool SpawnWorker(const std::string& programPath, const std::vector<std::string>& arguments, SpawnedWorker& outWorker)
+    {
+#ifdef _WIN32
+        std::string commandLine = "\"" + programPath + "\"";
+        for (const std::string& argument : arguments)
+        {
+            commandLine += " \"" + argument + "\"";
+        }
+        STARTUPINFOA startup{};
+        startup.cb = sizeof(startup);
+        PROCESS_INFORMATION information{};
+        if (!CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &information)) return false;
+        CloseHandle(information.hThread);
+        outWorker.process = information.hProcess;
+        return true;
+#else
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(programPath.c_str()));
+        for (const std::string& argument : arguments)
+        {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+        return posix_spawnp(&outWorker.process, programPath.c_str(), nullptr, nullptr, argv.data(), environ) == 0;
+#endif
+    }
+
+    void WaitForWorker(const SpawnedWorker& worker)
+    {
+#ifdef _WIN32
+        WaitForSingleObject(worker.process, INFINITE);
+        CloseHandle(worker.process);
+#else
+        int status = 0;
+        waitpid(worker.process, &status, 0);
+#endif
+    }
+
+    // Rows [y0, y1) of the image, one row of tiles each
+    struct WorkUnit
+    {
+        int y0;
+        int y1;
+        bool isDone = false;
+    };
+
+    struct WorkerConnection
+    {
+        RT::Socket socket;
+        size_t statsIndex = 0;
+        bool isReady = false;
+        std::vector<uint32_t> units;
+    };
+
+    struct WorkerStats
+    {
+        uint32_t threadCount = 0;
+        int unitsRendered = 0;
+        double busySeconds = 0.0;
+        bool isLost = false;
+    };
+
+    // Coordinator of one frame: the unit queue, the connected workers and the image their results go into
+    class Coordinator
+    {
+    private:
+        const RT::Settings& settings;
+        RTRender::FrameBuffer& image;
+        RTRender::ImageWriter& writer;
+        std::ostream& log;
+        std::vector<char> job;
+        std::vector<WorkUnit> units;
+        std::deque<uint32_t> pendingUnits;
+        std::vector<std::unique_ptr<WorkerConnection>> connections;
+        std::vector<WorkerStats> workerStats;
+        size_t finishedCount = 0;
+        int reassignedCount = 0;
+
+    public:
+        Coordinator(const RT::Settings& inSettings, const std::vector<std::string>& jobArguments, RTRender::FrameBuffer& inImage, RTRender::ImageWriter& inWriter, std::ostream& inLog)
+            : settings(inSettings), image(inImage), writer(inWriter), log(inLog)
+        {
+            for (const std::string& argument : jobArguments)
+            {
+                job.insert(job.end(), argument.begin(), argument.end());
+                job.push_back('\0');
+            }
+            for (int y = 0; y < settings.imageHeight; y += settings.tileHeight)
+            {
+                pendingUnits.push_back(static_cast<uint32_t>(units.size()));
+                units.push_back({y, std::min(settings.imageHeight, y + settings.tileHeight)});
+            }
+        }
+
+        [[nodiscard]] size_t GetUnitCount() const
+        {
+            return units.size();
+        }
+
+        bool Render(const RT::Socket& listener)
+        {
+            std::vector<const RT::Socket*> sockets;
+            std::vector<char> isReadable;
+            auto lastWorkerSeen = std::chrono::steady_clock::now();
+            while (finishedCount < units.size())
+            {
+                sockets.assign(1, &listener);
+                for (const auto& connection : connections)
+                {
+                    sockets.push_back(&connection->socket);
+                }
+                if (!RT::Socket::WaitReadable(sockets, 1000, isReadable))
+                {
+                    log << "Waiting for workers failed.\n";
+                    return false;
+                }
+
+                for (size_t index = 0; index < connections.size(); ++index)
+                {
+                    if (isReadable[index + 1] && !Receive(*connections[index]))
+                    {
+                        LoseWorker(*connections[index]);
+                    }
+                }
+                if (isReadable[0])
+                {
+                    Accept(listener);
+                }
+                for (const auto& connection : connections)
+                {
+                    if (!Assign(*connection))
+                    {
+                        LoseWorker(*connection);
+                    }
+                }
+                connections.erase(std::remove_if(connections.begin(), connections.end(), [](const auto& connection)
+                {
+                    return !connection->socket.IsOpen();
+                }), connections.end());
+
+                if (!connections.empty())
+                {
+                    lastWorkerSeen = std::chrono::steady_clock::now();
+                }
+                else if (settings.listenPort < 0 && RT::SecondsSince(lastWorkerSeen) > workerWaitSeconds)
+                {
+                    log << "No worker connected for " << workerWaitSeconds << " s, " << units.size() - finishedCount << " units are not rendered.\n";
+                    return false;
+                }
+            }
+
+            for (const auto& connection : connections)
+            {
+                SendMessage(connection->socket, MessageType::Done, nullptr, 0);
+                connection->socket.Close();
+            }
+            return true;
+        }
+
+        void PrintStats(std::ostream& out) const
+        {
+            out << "Workers: " << workerStats.size() << " connected, " << units.size() << " units of " << settings.tileHeight
+                << " rows, " << reassignedCount << " reassigned\n";
+            for (size_t index = 0; index < workerStats.size(); ++index)
+            {
+                const WorkerStats& stats = workerStats[index];
+                out << "  worker " << index << ": " << stats.threadCount << " threads, " << stats.unitsRendered << " units, "
+                    << stats.busySeconds << " s busy" << (stats.isLost ? ", lost" : "") << "\n";
+            }
+        }
+
+    private:
+        void Accept(const RT::Socket& listener)
+        {
+            RT::Socket socket = listener.Accept();
+            if (!socket.IsOpen()) return;
+
+            auto connection = std::make_unique<WorkerConnection>();
+            connection->socket = std::move(socket);
+            connection->statsIndex = workerStats.size();
+            workerStats.emplace_back();
+            connections.push_back(std::move(connection));
+        }
+
+        // Handle the next message of a worker, false when it broke the protocol or went away
+        bool Receive(WorkerConnection& connection)
+        {
+            MessageHeader header{};
+            if (!ReceiveHeader(connection.socket, header)) return false;
+
+            WorkerStats& stats = workerStats[connection.statsIndex];
+            if (header.type == static_cast<uint32_t>(MessageType::Hello) && !connection.isReady)
+            {
+                HelloMessage hello{};
+                if (header.size != sizeof(hello) || !connection.socket.ReceiveAll(&hello, sizeof(hello))) return false;
+                if (hello.magic != protocolMagic || hello.version != protocolVersion)
+                {
+                    log << "Worker " << connection.statsIndex << " speaks another protocol version.\n";
+                    return false;
+                }
+                stats.threadCount = hello.threadCount;
+                connection.isReady = true;
+                return SendMessage(connection.socket, MessageType::Job, job.data(), job.size());
+            }
+            if (header.type != static_cast<uint32_t>(MessageType::Result) || !connection.isReady) return false;
+
+            UnitMessage result{};
+            if (header.size < sizeof(result) || !connection.socket.ReceiveAll(&result, sizeof(result))) return false;
+            const auto unit = std::find(connection.units.begin(), connection.units.end(), result.id);
+            if (unit == connection.units.end() || units[result.id].y0 != result.y0 || units[result.id].y1 != result.y1) return false;
+
+            const size_t pixelCount = static_cast<size_t>(result.y1 - result.y0) * static_cast<size_t>(settings.imageWidth);
+            const size_t pixelBytes = pixelCount * 3 * sizeof(float);
+            const size_t countBytes = image.HasSampleCounts() ? pixelCount * sizeof(uint16_t) : 0;
+            if (header.size != sizeof(result) + pixelBytes + countBytes) return false;
+            // A unit is only handed out again once its worker is gone, so each arrives once and goes straight into place
+            if (!connection.socket.ReceiveAll(image.Pixel(0, result.y0), pixelBytes)) return false;
+            if (countBytes > 0 && !connection.socket.ReceiveAll(&image.SampleCount(0, result.y0), countBytes)) return false;
+
+            connection.units.erase(unit);
+            units[result.id].isDone = true;
+            ++finishedCount;
+            ++stats.unitsRendered;
+            stats.busySeconds += result.busySeconds;
+            writer.RowsFinished(result.y0, result.y1);
+            return true;
+        }
+
+        // Top up the units queued on a worker, false when sending failed
+        bool Assign(WorkerConnection& connection)
+        {
+            while (connection.isReady && connection.socket.IsOpen() && connection.units.size() < unitsInFlight && !pendingUnits.empty())
+            {
+                const uint32_t id = pendingUnits.front();
+                pendingUnits.pop_front();
+                connection.units.push_back(id);
+                const UnitMessage message{id, units[id].y0, units[id].y1, 0.0f};
+                if (!SendMessage(connection.socket, MessageType::Unit, &message, sizeof(message))) return false;
+            }
+            return true;
+        }
+
+        // Put the unfinished units of a worker back at the front of the queue and drop it
+        void LoseWorker(WorkerConnection& connection)
+        {
+            if (!connection.socket.IsOpen()) return;
+
+            for (auto unit = connection.units.rbegin(); unit != connection.units.rend(); ++unit)
+            {
+                pendingUnits.push_front(*unit);
+            }
+            reassignedCount += static_cast<int>(connection.units.size());
+            if (connection.isReady)
+            {
+                log << "Worker " << connection.statsIndex << " lost, " << connection.units.size() << " units reassigned.\n";
+            }
+            connection.units.clear();
+            workerStats[connection.statsIndex].isLost = true;
+            connection.socket.Close();
+        }
+    };
+}
+
+namespace RTRender
+{
+    bool RunRenderCoordinator(const RT::Settings& settings, const std::string& programPath, const std::vector<std::string>& jobArguments, std::ostream& log)
+    {
+        ImageFormat format = ImageWriter::FormatFromPath(settings.outputPath);
+        if (!settings.outputFormat.empty())
+        {
+            ImageWriter::FormatFromName(settings.outputFormat, format);
+        }
+
+        // The whole frame stays in memory, results arrive in any order
+        const bool isAdaptive = settings.adaptiveSampling && !settings.wavefront;
+        FrameBuffer image(settings.imageWidth, settings.imageHeight, 0, isAdaptive);
+        ImageWriter writer(settings.outputPath, format, image);
+        if (!writer.IsOpen())
+        {
+            log << "Cannot open " << settings.outputPath << " for writing.\n";
+            return false;
+        }
+
+        // Spawned workers alone connect over loopback; a listen port is open to workers on other machines
+        const RT::Socket listener = RT::Socket::Listen(settings.listenPort >= 0 ? "" : "127.0.0.1", std::max(0, settings.listenPort));
+        if (!listener.IsOpen())
+        {
+            log << "Cannot listen on port " << settings.listenPort << ".\n";
+            return false;
+        }
+        const int port = listener.LocalPort();
+
+        Coordinator coordinator(settings, jobArguments, image, writer, log);
+        log << "Coordinator: listening on port " << port << ", " << settings.imageWidth << "x" << settings.imageHeight << " image in "
+            << coordinator.GetUnitCount() << " units.\n";
+
+        std::vector<SpawnedWorker> spawnedWorkers;
+        const std::vector<std::string> workerArguments{"--connect", "127.0.0.1:" + std::to_string(port), "--threads", std::to_string(settings.threadCount)};
+        for (int index = 0; index < settings.spawnWorkers; ++index)
+        {
+            SpawnedWorker worker;
+            if (!SpawnWorker(programPath, workerArguments, worker))
+            {
+                log << "Cannot start worker process " << programPath << ".\n";
+                continue;
+            }
+            spawnedWorkers.push_back(worker);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const bool isRendered = coordinator.Render(listener);
+        const double wallSeconds = RT::SecondsSince(start);
+        // Workers exit once they are told the frame is done or lose the connection
+        for (const SpawnedWorker& worker : spawnedWorkers)
+        {
+            WaitForWorker(worker);
+        }
+        if (!isRendered) return false;
+
+        const double primaryRays = isAdaptive ? static_cast<double>(image.SampleTotal())
+            : static_cast<double>(settings.PixelCount()) * settings.samplesPerPixel;
+        log << "Traced in " << wallSeconds << " s, " << primaryRays / wallSeconds / 1e6 << " M primary rays/s\n";
+        coordinator.PrintStats(log);
+        if (!settings.statsJsonPath.empty())
+        {
+            log << "Ray statistics stay with the workers, " << settings.statsJsonPath << " is not written.\n";
+        }
+
+        if (!writer.Finish())
+        {
+            log << "Failed to write " << settings.outputPath << ".\n";
+            return false;
+        }
+        if (isAdaptive && !settings.sampleHeatmapPath.empty())
+        {
+            const AdaptiveSampler sampler(settings.minSamplesPerPixel, settings.samplesPerPixel, settings.targetError);
+            FrameBuffer heatmap(settings.imageWidth, settings.imageHeight);
+            sampler.SampleHeatmap(image, heatmap);
+            ImageWriter heatmapWriter(settings.sampleHeatmapPath, ImageWriter::FormatFromPath(settings.sampleHeatmapPath), heatmap);
+            if (!heatmapWriter.IsOpen() || !heatmapWriter.Finish())
+            {
+                log << "Failed to write " << settings.sampleHeatmapPath << ".\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool RunRenderWorker(const RT::Settings& settings, std::ostream& log)
+    {
+        std::string host;
+        int port = 0;
+        RT::Socket::ParseAddress(settings.coordinatorAddress, host, port);
+        const RT::Socket coordinator = RT::Socket::Connect(host, port);
+        if (!coordinator.IsOpen())
+        {
+            log << "Cannot connect to the coordinator at " << settings.coordinatorAddress << ".\n";
+            return false;
+        }
+
+        // The coordinator sizes units by the threads the pool really keeps, after the oversubscription guard
+        const WorkerPoolOptions poolOptions = WorkerPoolOptions::FromSettings(settings);
+        const int requestedThreadCount = settings.threadCount > 0 ? settings.threadCount : WorkerPool::HardwareThreadCount();
+        const int threadCount = poolOptions.allowOversubscription ? requestedThreadCount : std::min(requestedThreadCount, WorkerPool::HardwareThreadCount());
+        const HelloMessage hello{protocolMagic, protocolVersion, static_cast<uint32_t>(threadCount), 0};
+        MessageHeader header{};
+        if (!SendMessage(coordinator, MessageType::Hello, &hello, sizeof(hello)) || !ReceiveHeader(coordinator, header)
+            || header.type != static_cast<uint32_t>(MessageType::Job))
+        {
+            log << "The coordinator at " << settings.coordinatorAddress << " did not send a job.\n";
+            return false;
+        }
+
+        // The job is the command line of the coordinator, parsed here as if this process had been started with it
+        std::vector<char> job(header.size);
+        if (!coordinator.ReceiveAll(job.data(), job.size()) || (!job.empty() && job.back() != '\0')) return false;
+        std::vector<const char*> jobArgv{"worker"};
+        for (size_t offset = 0; offset < job.size(); offset += std::char_traits<char>::length(job.data() + offset) + 1)
+        {
+            jobArgv.push_back(job.data() + offset);
+        }
+        RT::Settings jobSettings;
+        if (RT::ParseCommandLine(static_cast<int>(jobArgv.size()), jobArgv.data(), jobSettings, log) != RT::CommandLineResult::Run) return false;
+        jobSettings.threadCount = threadCount;
+
+        // Same scene, camera and renderer as a single process rendering the job
+        RTObject::Scene scene;
+        RTObject::CameraView view;
+        if (!RTObject::MakeScene(jobSettings, scene, view, log)) return false;
+        const RTType::BVH world = scene.BuildHierarchy(jobSettings.sphereGroupSize);
+        const RTObject::Camera camera = view.ToCamera(jobSettings.AspectRatio());
+        WorkerPool pool(jobSettings.threadCount, poolOptions);
+        FrameRenderer renderer(jobSettings, camera, world, pool);
+        FrameBuffer image(jobSettings.imageWidth, jobSettings.imageHeight, jobSettings.tileHeight, renderer.IsAdaptive());
+        log << "Worker: " << scene.spheres.size() << " spheres, " << pool.GetThreadCount() << " threads, rendering for "
+            << settings.coordinatorAddress << ".\n";
+
+        int unitCount = 0;
+        while (ReceiveHeader(coordinator, header))
+        {
+            if (header.type == static_cast<uint32_t>(MessageType::Done))
+            {
+                log << "Worker: rendered " << unitCount << " units.\n";
+                return true;
+            }
+
+            UnitMessage unit{};
+            if (header.type != static_cast<uint32_t>(MessageType::Unit) || header.size != sizeof(unit) || !coordinator.ReceiveAll(&unit, sizeof(unit))) break;
+            if (unit.y0 < 0 || unit.y0 >= unit.y1 || unit.y1 > jobSettings.imageHeight || unit.y1 - unit.y0 > image.GetBandHeight()) break;
+
+            const auto start = std::chrono::steady_clock::now();
+            image.SetBand(unit.y0);
+            renderer.RenderRows(image, unit.y0, unit.y1);
+            unit.busySeconds = static_cast<float>(RT::SecondsSince(start));
+
+            const size_t pixelCount = static_cast<size_t>(unit.y1 - unit.y0) * static_cast<size_t>(jobSettings.imageWidth);
+            const size_t pixelBytes = pixelCount * 3 * sizeof(float);
+            const size_t countBytes = image.HasSampleCounts() ? pixelCount * sizeof(uint16_t) : 0;
+            const MessageHeader resultHeader{static_cast<uint32_t>(MessageType::Result), 0, sizeof(unit) + pixelBytes + countBytes};
+            if (!coordinator.SendAll(&resultHeader, sizeof(resultHeader)) || !coordinator.SendAll(&unit, sizeof(unit))
+                || !coordinator.SendAll(image.Pixel(0, unit.y0), pixelBytes)
+                || (countBytes > 0 && !coordinator.SendAll(&image.SampleCount(0, unit.y0), countBytes))) break;
+            ++unitCount;
+        }
+        log << "Worker: lost the coordinator at " << settings.coordinatorAddress << " after " << unitCount << " units.\n";
+        return false;
+    }
+}
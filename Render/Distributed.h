@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Common/Settings.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace RTRender
+{
+    /*
+     * Distributed rendering over TCP. The coordinator listens for worker processes, sends each of them its command
+     * line so they build the same scene and camera, and hands out work units of one tile row. Workers trace a unit
+     * exactly as a single process would and send its finished pixels back; the coordinator copies them into place,
+     * so the image does not depend on which worker rendered what or in which order results arrive. Units of a worker
+     * that disconnects go back to the queue for the others. Pixels travel in the native byte order, so coordinator
+     * and workers must share an architecture.
+     */
+
+    /*
+     * Coordinator side: renders the frame the settings describe on workers connecting to settings.listenPort, or to a
+     * free local port with settings.spawnWorkers processes of programPath started on this machine. jobArguments are
+     * the command line arguments the workers parse. Writes the image and heatmap like a local render; false after
+     * reporting a failure on log.
+     */
+    bool RunRenderCoordinator(const RT::Settings& settings, const std::string& programPath, const std::vector<std::string>& jobArguments, std::ostream& log);
+
+    /*
+     * Worker side: connects to settings.coordinatorAddress and renders the units it is sent with settings.threadCount
+     * threads until the coordinator is done. False when the coordinator cannot be reached or goes away.
+     */
+    bool RunRenderWorker(const RT::Settings& settings, std::ostream& log);
+}
@@ -0,0 +1,103 @@
+#include "FrameBuffer.h"
+
+#include "TileScheduler.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace RTRender
+{
+    FrameBuffer::FrameBuffer(const int inWidth, const int inHeight, const int inBandHeight, const bool hasSampleCounts)
+        : width(inWidth), height(inHeight)
+        , bandHeight(inBandHeight <= 0 ? inHeight : std::min(inBandHeight, inHeight))
+    {
+        const size_t bandPixels = static_cast<size_t>(width) * static_cast<size_t>(bandHeight);
+        pixels.resize(bandPixels * 3);
+        if (hasSampleCounts) sampleCounts.resize(bandPixels);
+    }
+
+    int FrameBuffer::GetWidth() const
+    {
+        return width;
+    }
+
+    int FrameBuffer::GetHeight() const
+    {
+        return height;
+    }
+
+    int FrameBuffer::GetBandHeight() const
+    {
+        return bandHeight;
+    }
+
+    int FrameBuffer::GetFirstRow() const
+    {
+        return firstRow;
+    }
+
+    int FrameBuffer::GetEndRow() const
+    {
+        return std::min(firstRow + bandHeight, height);
+    }
+
+    bool FrameBuffer::HasRow(const int y) const
+    {
+        return y >= firstRow && y < GetEndRow();
+    }
+
+    void FrameBuffer::SetBand(const int inFirstRow)
+    {
+        // Renderers write every pixel of a band, so the old values are left in place
+        firstRow = inFirstRow;
+    }
+
+    void FrameBuffer::PlaceRows(WorkerPool& pool, const int tileHeight)
+    {
+        const int nodeCount = pool.GetNodeCount();
+        if (nodeCount <= 1 || isPlaced) return;
+
+        // The first worker of every node zeroes the rows of its node
+        std::vector<int> nodeWriters(static_cast<size_t>(nodeCount), -1);
+        for (int workerId = pool.GetThreadCount() - 1; workerId >= 0; --workerId)
+        {
+            nodeWriters[static_cast<size_t>(pool.GetWorkerNode(workerId))] = workerId;
+        }
+
+        const auto rowPixels = static_cast<size_t>(width);
+        pool.Run([&](const int workerId)
+        {
+            const int node = pool.GetWorkerNode(workerId);
+            if (nodeWriters[static_cast<size_t>(node)] != workerId) return;
+
+            for (int row = 0; row < bandHeight; ++row)
+            {
+                // Rows of a node without workers go to the next node that has some, as the scheduler deals them
+                int rowNode = TileScheduler::NodeOfRow(row, tileHeight, nodeCount);
+                while (nodeWriters[static_cast<size_t>(rowNode)] < 0) rowNode = (rowNode + 1) % nodeCount;
+                if (rowNode != node) continue;
+
+                const size_t first = static_cast<size_t>(row) * rowPixels;
+                std::fill_n(pixels.begin() + static_cast<ptrdiff_t>(3 * first), 3 * rowPixels, 0.0f);
+                if (!sampleCounts.empty())
+                {
+                    std::fill_n(sampleCounts.begin() + static_cast<ptrdiff_t>(first), rowPixels, uint16_t(0));
+                }
+            }
+        });
+        isPlaced = true;
+    }
+
+    uint64_t FrameBuffer::SampleTotal() const
+    {
+        if (sampleCounts.empty()) return 0;
+        const size_t bandPixels = static_cast<size_t>(GetEndRow() - firstRow) * static_cast<size_t>(width);
+        return std::accumulate(sampleCounts.begin(), sampleCounts.begin() + static_cast<ptrdiff_t>(bandPixels), uint64_t{0});
+    }
+
+    size_t FrameBuffer::MemorySize() const
+    {
+        return pixels.size() * sizeof(float) + sampleCounts.size() * sizeof(uint16_t);
+    }
+}
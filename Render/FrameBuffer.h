@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace RTRender
+{
+    class WorkerPool;
+
+    /*
+     * Linear RGB float pixels of a horizontal band of image rows, with the sample count of each pixel when adaptive
+     * sampling needs one. Pixels are addressed by image coordinates, so renderers do not know which band they fill.
+     * A band as tall as the image is the whole frame; a shorter one is moved down the image with SetBand() once its
+     * rows are written out, which bounds memory by the band height instead of the image height.
+     */
+    class FrameBuffer
+    {
+    private:
+        /*
+         * Allocates with calloc and leaves new elements as they are: the pixels start at zero, and a large buffer is
+         * fresh zero pages of the system that nothing has written, so PlaceRows is the first touch of every page.
+         */
+        template <typename T>
+        struct ZeroedAllocator : std::allocator<T>
+        {
+            template <typename U>
+            struct rebind
+            {
+                using other = ZeroedAllocator<U>;
+            };
+
+            ZeroedAllocator() = default;
+            template <typename U>
+            ZeroedAllocator(const ZeroedAllocator<U>&) {}
+
+            T* allocate(const size_t count)
+            {
+                void* memory = std::calloc(count, sizeof(T));
+                if (memory == nullptr) throw std::bad_alloc();
+                return static_cast<T*>(memory);
+            }
+
+            void deallocate(T* memory, size_t)
+            {
+                std::free(memory);
+            }
+
+            template <typename U>
+            void construct(U* element)
+            {
+                ::new (static_cast<void*>(element)) U;
+            }
+        };
+
+        int width;
+        int height;
+        int bandHeight;
+        int firstRow = 0;
+        bool isPlaced = false;
+        std::vector<float, ZeroedAllocator<float>> pixels;
+        std::vector<uint16_t, ZeroedAllocator<uint16_t>> sampleCounts;
+
+    public:
+        // bandHeight of 0 or more than height holds the whole image
+        FrameBuffer(int inWidth, int inHeight, int inBandHeight = 0, bool hasSampleCounts = false);
+
+        [[nodiscard]] int GetWidth() const;
+        [[nodiscard]] int GetHeight() const;
+        [[nodiscard]] int GetBandHeight() const;
+        [[nodiscard]] int GetFirstRow() const;
+        // One past the last row of the current band
+        [[nodiscard]] int GetEndRow() const;
+        [[nodiscard]] bool HasRow(int y) const;
+
+        // Rows [firstRow, firstRow + band height) of the image, clipped to its bottom
+        void SetBand(int inFirstRow);
+
+        /*
+         * Place the rows of the band on the NUMA nodes whose workers render them, as TileScheduler::NodeOfRow deals
+         * bands of tileHeight rows: one worker of each node zeroes its rows in place, and that first touch puts their
+         * pages on its node. Call it before anything is written. Does nothing on a pool of one node or once placed.
+         */
+        void PlaceRows(WorkerPool& pool, int tileHeight);
+
+        // First of the three floats of pixel (i, y), y must lie in the current band
+        float* Pixel(const int i, const int y)
+        {
+            return pixels.data() + 3 * PixelIndex(i, y);
+        }
+
+        [[nodiscard]] const float* Row(const int y) const
+        {
+            return pixels.data() + 3 * PixelIndex(0, y);
+        }
+
+        uint16_t& SampleCount(const int i, const int y)
+        {
+            return sampleCounts[PixelIndex(i, y)];
+        }
+
+        [[nodiscard]] uint16_t SampleCount(const int i, const int y) const
+        {
+            return sampleCounts[PixelIndex(i, y)];
+        }
+
+        [[nodiscard]] bool HasSampleCounts() const
+        {
+            return !sampleCounts.empty();
+        }
+
+        // Samples taken in the rows of the current band, 0 without sample counts
+        [[nodiscard]] uint64_t SampleTotal() const;
+
+        // Bytes held for pixels and sample counts
+        [[nodiscard]] size_t MemorySize() const;
+
+    private:
+        [[nodiscard]] size_t PixelIndex(const int i, const int y) const
+        {
+            return static_cast<size_t>(y - firstRow) * static_cast<size_t>(width) + static_cast<size_t>(i);
+        }
+    };
+}
@@ -0,0 +1,72 @@
+#include "FrameRenderer.h"
+
+namespace RTRender
+{
+    FrameRenderer::FrameRenderer(const RT::Settings& inSettings, const RTObject::Camera& inCamera, const RTTHittable& inWorld, WorkerPool& inPool)
+        : settings(inSettings), camera(inCamera), world(inWorld), pool(inPool)
+        , integrator(inSettings.minDepth, inSettings.maxDepth)
+        , sampler(inSettings.minSamplesPerPixel, inSettings.samplesPerPixel, inSettings.targetError)
+        , wavefront(integrator, inSettings, inPool.GetThreadCount())
+    {
+    }
+
+    bool FrameRenderer::IsAdaptive() const
+    {
+        return settings.adaptiveSampling && !settings.wavefront;
+    }
+
+    const AdaptiveSampler& FrameRenderer::GetSampler() const
+    {
+        return sampler;
+    }
+
+    int FrameRenderer::GetThreadCount() const
+    {
+        return pool.GetThreadCount();
+    }
+
+    void FrameRenderer::SetCamera(const RTObject::Camera& inCamera)
+    {
+        camera = inCamera;
+    }
+
+    void FrameRenderer::SetGuideBuffers(GuideBuffers* inGuides)
+    {
+        guides = inGuides;
+    }
+
+    TileScheduler::Stats FrameRenderer::RenderRows(FrameBuffer& image, const int y0, const int y1, const TileScheduler::RowsFinishedFunction& onRowsFinished)
+    {
+        const bool isAdaptive = IsAdaptive();
+        image.PlaceRows(pool, settings.tileHeight);
+        const TileScheduler scheduler(Tile{0, y0, settings.imageWidth, y1}, settings.tileWidth, settings.tileHeight, settings.workStealing);
+        return scheduler.Render(pool, [&](const Tile& tile, const int workerId)
+        {
+            if (settings.wavefront)
+            {
+                wavefront.RenderTile(image, camera, world, tile, workerId);
+            }
+            else if (isAdaptive)
+            {
+                sampler.RenderTile(tile, [&](const int i, const int y, const int sample)
+                {
+                    return integrator.RenderSample(settings, camera, world, i, y, sample);
+                }, image);
+            }
+            else
+            {
+                integrator.RenderTile(image, settings, camera, world, tile, guides);
+            }
+        }, onRowsFinished);
+    }
+
+    TileScheduler::Stats FrameRenderer::AccumulateSamples(RadianceBuffer& radiance, const int sampleEnd, const std::atomic<bool>* isStopRequested)
+    {
+        const TileScheduler scheduler(settings.imageWidth, settings.imageHeight, settings.tileWidth, settings.tileHeight, settings.workStealing);
+        return scheduler.Render(pool, [&](const Tile& tile, int)
+        {
+            if (isStopRequested != nullptr && isStopRequested->load(std::memory_order_relaxed)) return;
+            integrator.AccumulateTile(radiance, settings, camera, world, tile, sampleEnd);
+        });
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "AdaptiveSampling.h"
+#include "FrameBuffer.h"
+#include "Integrator.h"
+#include "RadianceBuffer.h"
+#include "TileScheduler.h"
+#include "Wavefront.h"
+#include "WorkerPool.h"
+
+#include "Common/Settings.h"
+#include "Objects/Camera.h"
+#include "Types/RTTypes.h"
+
+#include <atomic>
+
+namespace RTRender
+{
+    /*
+     * Renders rows of the image the settings describe, in the mode they pick: depth-first, adaptive or wavefront.
+     * Rows are split into tiles that the workers of the pool render. The settings, world and pool are borrowed and
+     * must outlive the renderer; the camera is copied, so an animation can move it between frames.
+     */
+    class FrameRenderer
+    {
+    private:
+        const RT::Settings& settings;
+        RTObject::Camera camera;
+        const RTTHittable& world;
+        WorkerPool& pool;
+        PathIntegrator integrator;
+        AdaptiveSampler sampler;
+        WavefrontRenderer wavefront;
+        GuideBuffers* guides = nullptr;
+
+    public:
+        FrameRenderer(const RT::Settings& inSettings, const RTObject::Camera& inCamera, const RTTHittable& inWorld, WorkerPool& inPool);
+
+        // Adaptive sampling applies to depth-first rendering only, its frame buffers need sample counts
+        [[nodiscard]] bool IsAdaptive() const;
+        [[nodiscard]] const AdaptiveSampler& GetSampler() const;
+        [[nodiscard]] int GetThreadCount() const;
+
+        // Camera of the rows rendered from now on
+        void SetCamera(const RTObject::Camera& inCamera);
+
+        // Guide buffers of the whole image that depth-first rendering fills for the denoiser, nullptr records none
+        void SetGuideBuffers(GuideBuffers* inGuides);
+
+        // Render rows [y0, y1) of the image into the band of the frame buffer, which must hold them
+        TileScheduler::Stats RenderRows(FrameBuffer& image, int y0, int y1, const TileScheduler::RowsFinishedFunction& onRowsFinished = nullptr);
+
+        /*
+         * Bring every pixel of the radiance buffer up to sampleEnd samples, depth-first and without adaptive sampling.
+         * Once isStopRequested is set, tiles not started yet are skipped and keep the samples they had.
+         */
+        TileScheduler::Stats AccumulateSamples(RadianceBuffer& radiance, int sampleEnd, const std::atomic<bool>* isStopRequested = nullptr);
+    };
+}
@@ -0,0 +1,259 @@
+#include "ImageWriter.h"
+
+#include "Common/Common.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+    constexpr size_t fileBufferSize = 1 << 20;
+
+    // Gamma-correct for gamma = 2.0 and translate to [0, 255]
+    uint8_t ToByte(const float linear)
+    {
+        const double value = std::sqrt(std::max(0.0, static_cast<double>(linear)));
+        return static_cast<uint8_t>(256 * RT::Clamp(value, 0.0, 0.999));
+    }
+
+    bool Seek(FILE* file, const int64_t offset)
+    {
+#ifdef _WIN32
+        return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+        return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+}
+
+namespace RTRender
+{
+    ImageWriter::ImageWriter(const std::string& path, const ImageFormat inFormat, const FrameBuffer& inImage)
+        : image(inImage), format(inFormat), width(inImage.GetWidth()), height(inImage.GetHeight())
+        , isRowFinished(static_cast<size_t>(height), 0)
+    {
+        isStandardOutput = path == "-";
+        if (isStandardOutput)
+        {
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            file = stdout;
+        }
+        else
+        {
+            file = std::fopen(path.c_str(), "wb");
+        }
+        if (file == nullptr) return;
+
+        std::setvbuf(file, nullptr, _IOFBF, fileBufferSize);
+
+        // Rows of the raw formats have a fixed size, so a regular file can take them in any order
+        isRandomAccess = !isStandardOutput && format != ImageFormat::PNG;
+
+        std::string header;
+        switch (format)
+        {
+        case ImageFormat::PPM:
+            header = "P6\n" + std::to_string(width) + ' ' + std::to_string(height) + "\n255\n";
+            break;
+        case ImageFormat::PFM:
+            header = "PF\n" + std::to_string(width) + ' ' + std::to_string(height) + "\n-1.0\n";
+            break;
+        case ImageFormat::PNG:
+            pngEncoder = std::make_unique<PngEncoder>(file, width, height);
+            break;
+        }
+        std::fwrite(header.data(), 1, header.size(), file);
+        dataOffset = static_cast<int64_t>(header.size());
+    }
+
+    ImageWriter::~ImageWriter()
+    {
+        Finish();
+    }
+
+    bool ImageWriter::IsOpen() const
+    {
+        return file != nullptr;
+    }
+
+    void ImageWriter::RowsFinished(const int y0, const int y1)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (file == nullptr) return;
+
+        for (int y = y0; y < y1; ++y)
+        {
+            isRowFinished[y] = 1;
+        }
+
+        if (isRandomAccess)
+        {
+            // PFM stores rows bottom to top
+            const int firstFileRow = format == ImageFormat::PFM ? height - y1 : y0;
+            WriteFileRows(firstFileRow, y1 - y0);
+            return;
+        }
+
+        int rowCount = 0;
+        while (nextFileRow + rowCount < height && isRowFinished[ImageRowOfFileRow(nextFileRow + rowCount)])
+        {
+            ++rowCount;
+        }
+        if (rowCount > 0)
+        {
+            WriteFileRows(nextFileRow, rowCount);
+            nextFileRow += rowCount;
+        }
+    }
+
+    bool ImageWriter::Finish()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (file == nullptr) return !hasFailed;
+
+        if (isRandomAccess)
+        {
+            for (int fileRow = 0; fileRow < height; ++fileRow)
+            {
+                if (!isRowFinished[ImageRowOfFileRow(fileRow)])
+                {
+                    WriteFileRows(fileRow, 1);
+                }
+            }
+        }
+        else if (nextFileRow < height)
+        {
+            WriteFileRows(nextFileRow, height - nextFileRow);
+            nextFileRow = height;
+        }
+
+        if (pngEncoder)
+        {
+            pngEncoder->Finish();
+            pngEncoder.reset();
+        }
+
+        hasFailed |= std::fflush(file) != 0 || std::ferror(file) != 0;
+        if (!isStandardOutput)
+        {
+            hasFailed |= std::fclose(file) != 0;
+        }
+        file = nullptr;
+        return !hasFailed;
+    }
+
+    ImageFormat ImageWriter::FormatFromPath(const std::string& path)
+    {
+        const size_t dot = path.find_last_of('.');
+        std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (extension == "pfm") return ImageFormat::PFM;
+        if (extension == "png") return ImageFormat::PNG;
+        return ImageFormat::PPM;
+    }
+
+    bool ImageWriter::FormatFromName(const std::string& name, ImageFormat& outFormat)
+    {
+        if (name == "ppm") outFormat = ImageFormat::PPM;
+        else if (name == "pfm") outFormat = ImageFormat::PFM;
+        else if (name == "png") outFormat = ImageFormat::PNG;
+        else return false;
+        return true;
+    }
+
+    bool ImageWriter::NeedsWholeImage(const std::string& path, const ImageFormat format)
+    {
+        return format == ImageFormat::PFM && path == "-";
+    }
+
+    void ImageWriter::EncodePpm(const FrameBuffer& image, const int outWidth, const int outHeight, std::vector<uint8_t>& outBytes)
+    {
+        const std::string header = "P6\n" + std::to_string(outWidth) + ' ' + std::to_string(outHeight) + "\n255\n";
+        outBytes.assign(header.begin(), header.end());
+        outBytes.reserve(header.size() + static_cast<size_t>(outWidth) * static_cast<size_t>(outHeight) * 3);
+
+        // Source column of every output column, the same for all rows
+        std::vector<int> columns(static_cast<size_t>(outWidth));
+        for (int x = 0; x < outWidth; ++x)
+        {
+            columns[x] = static_cast<int>(static_cast<int64_t>(x) * image.GetWidth() / outWidth);
+        }
+        for (int y = 0; y < outHeight; ++y)
+        {
+            const float* row = image.Row(static_cast<int>(static_cast<int64_t>(y) * image.GetHeight() / outHeight));
+            for (const int column : columns)
+            {
+                for (int channel = 0; channel < 3; ++channel)
+                {
+                    outBytes.push_back(ToByte(row[3 * column + channel]));
+                }
+            }
+        }
+    }
+
+    int ImageWriter::ImageRowOfFileRow(const int fileRow) const
+    {
+        return format == ImageFormat::PFM ? height - 1 - fileRow : fileRow;
+    }
+
+    size_t ImageWriter::FileRowSize() const
+    {
+        return static_cast<size_t>(width) * 3 * (format == ImageFormat::PFM ? sizeof(float) : sizeof(uint8_t));
+    }
+
+    const float* ImageWriter::ImageRow(const int y)
+    {
+        if (image.HasRow(y)) return image.Row(y);
+
+        blackRow.resize(static_cast<size_t>(width) * 3, 0.0f);
+        return blackRow.data();
+    }
+
+    void ImageWriter::WriteFileRows(const int firstFileRow, const int rowCount)
+    {
+        if (isRandomAccess)
+        {
+            hasFailed |= !Seek(file, dataOffset + static_cast<int64_t>(firstFileRow) * static_cast<int64_t>(FileRowSize()));
+        }
+
+        const size_t rowValues = static_cast<size_t>(width) * 3;
+        if (format == ImageFormat::PFM)
+        {
+            // Floats are written as they are in memory, which matches the little-endian scale in the header on x86 and ARM
+            for (int fileRow = firstFileRow; fileRow < firstFileRow + rowCount; ++fileRow)
+            {
+                hasFailed |= std::fwrite(ImageRow(ImageRowOfFileRow(fileRow)), sizeof(float), rowValues, file) != rowValues;
+            }
+            return;
+        }
+
+        rowBytes.resize(static_cast<size_t>(rowCount) * rowValues);
+        for (int row = 0; row < rowCount; ++row)
+        {
+            const float* source = ImageRow(firstFileRow + row);
+            uint8_t* target = rowBytes.data() + static_cast<size_t>(row) * rowValues;
+            for (size_t i = 0; i < rowValues; ++i)
+            {
+                target[i] = ToByte(source[i]);
+            }
+        }
+
+        if (format == ImageFormat::PNG)
+        {
+            pngEncoder->WriteRows(rowBytes.data(), rowCount);
+        }
+        else
+        {
+            hasFailed |= std::fwrite(rowBytes.data(), 1, rowBytes.size(), file) != rowBytes.size();
+        }
+    }
+}
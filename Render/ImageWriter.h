@@ -0,0 +1,83 @@
+#pragma once
+
+#include "FrameBuffer.h"
+#include "PngEncoder.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace RTRender
+{
+    enum class ImageFormat
+    {
+        PPM,    // Binary P6, 8 bits per channel, gamma 2
+        PFM,    // Little-endian float RGB, linear radiance
+        PNG     // 8 bits per channel, gamma 2
+    };
+
+    /*
+     * Writes the linear RGB float image of a frame buffer to a file path ("-" is standard output) while it is being rendered.
+     * Report finished rows with RowsFinished() from any thread; they are encoded right away, in whatever order the
+     * format allows: binary PPM and PFM rows go straight to their offset in the file, PNG rows and anything written
+     * to a pipe go out as soon as all rows before them are done. Rows are read from the band the frame buffer holds
+     * at that moment, so it may only move on once all rows above its next band are reported. PFM on a pipe starts
+     * with the bottom row, so it needs a frame buffer holding the whole image (see NeedsWholeImage).
+     * Finish() writes whatever was not reported, black where the frame buffer no longer holds it.
+     */
+    class ImageWriter
+    {
+    private:
+        const FrameBuffer& image;
+        ImageFormat format;
+        int width;
+        int height;
+
+        FILE* file = nullptr;
+        bool isStandardOutput = false;
+        bool isRandomAccess = false;
+        bool hasFailed = false;
+        int64_t dataOffset = 0;
+
+        std::mutex mutex;
+        std::vector<char> isRowFinished;
+        int nextFileRow = 0;
+        std::vector<uint8_t> rowBytes;
+        std::vector<float> blackRow;
+        std::unique_ptr<PngEncoder> pngEncoder;
+
+    public:
+        ImageWriter(const std::string& path, ImageFormat inFormat, const FrameBuffer& inImage);
+        ~ImageWriter();
+
+        ImageWriter(const ImageWriter&) = delete;
+        ImageWriter& operator=(const ImageWriter&) = delete;
+
+        [[nodiscard]] bool IsOpen() const;
+
+        // Rows [y0, y1) of the image, counted from the top, are final
+        void RowsFinished(int y0, int y1);
+
+        // Writes all remaining rows and closes the file, false if any write failed
+        bool Finish();
+
+        // Format by file extension, binary PPM when it is not recognized
+        static ImageFormat FormatFromPath(const std::string& path);
+        // Format by name (ppm, pfm or png), false when the name is not recognized
+        static bool FormatFromName(const std::string& name, ImageFormat& outFormat);
+        // Whether no row can go out before the last one is rendered: PFM stores rows bottom to top and standard output cannot seek
+        static bool NeedsWholeImage(const std::string& path, ImageFormat format);
+
+        // Binary PPM in memory of a frame buffer holding the whole image, scaled to outWidth x outHeight by nearest pixel
+        static void EncodePpm(const FrameBuffer& image, int outWidth, int outHeight, std::vector<uint8_t>& outBytes);
+
+    private:
+        [[nodiscard]] int ImageRowOfFileRow(int fileRow) const;
+        [[nodiscard]] size_t FileRowSize() const;
+        const float* ImageRow(int y);
+        void WriteFileRows(int firstFileRow, int rowCount);
+    };
+}
@@ -0,0 +1,223 @@
+#include "Integrator.h"
+#include "RenderStats.h"
+
+#include "Common/Common.h"
+
+#include <algorithm>
+
+namespace RTRender
+{
+    PathIntegrator::PathIntegrator(const int inMinDepth, const int inMaxDepth)
+        : minDepth(std::max(0, inMinDepth)), maxDepth(std::max(0, inMaxDepth))
+    {
+    }
+
+    RTTColor PathIntegrator::RayColor(const RTTRay& ray, const RTTHittable& world, FirstHit* outFirstHit) const
+    {
+        RenderStats* stats = nullptr;
+        if constexpr (RT::renderStats)
+        {
+            stats = &RenderStats::Local();
+            ++stats->primaryRays;
+        }
+
+        RTTColor throughput(1.0, 1.0, 1.0);
+        RTTRay currentRay = ray;
+        RTTHitResult hitRecord;
+
+        for (int depth = 0; depth < maxDepth; ++depth)
+        {
+            if (!world.Hit(currentRay, 0.001, RT::infinity, hitRecord))
+            {
+                if constexpr (RT::renderStats) ++stats->skyMisses;
+                const RTTColor skyColor = SkyColor(currentRay.Direction());
+                if (depth == 0 && outFirstHit != nullptr)
+                {
+                    *outFirstHit = {skyColor, -UnitVector(currentRay.Direction()), GuideBuffers::skyDepth};
+                }
+                return throughput * skyColor;
+            }
+            if constexpr (RT::renderStats) ++stats->surfaceHits;
+
+            RTTColor attenuation;
+            RTTRay scattered;
+            RT::ThreadSampler().StartBounce(depth);
+            const bool isScattered = hitRecord.material->Scatter(currentRay, hitRecord, attenuation, scattered);
+            if (depth == 0 && outFirstHit != nullptr)
+            {
+                // Camera rays are not normalized, the distance is t in units of their direction
+                *outFirstHit = {attenuation, hitRecord.normal, hitRecord.t * currentRay.Direction().Length()};
+            }
+            if (!isScattered)
+            {
+                if constexpr (RT::renderStats) ++stats->absorbed;
+                return RTType::colorBlack;
+            }
+            throughput *= attenuation;
+
+            if (!Survives(depth, throughput))
+            {
+                if constexpr (RT::renderStats) ++stats->terminatedByRoulette;
+                return RTType::colorBlack;
+            }
+            if (depth + 1 == maxDepth) break;
+
+            if constexpr (RT::renderStats) ++stats->secondaryRays[static_cast<int>(hitRecord.material->GetType())];
+            currentRay = scattered;
+        }
+
+        // We've exceeded the ray bounce limit, no more light is gathered
+        if constexpr (RT::renderStats) ++stats->terminatedByDepth;
+        return RTType::colorBlack;
+    }
+
+    RTTColor PathIntegrator::AmbientOcclusion(const RTTRay& ray, const RTTHittable& world, const int rayCount, const RT::Real distance,
+        FirstHit* outFirstHit) const
+    {
+        RenderStats* stats = nullptr;
+        if constexpr (RT::renderStats)
+        {
+            stats = &RenderStats::Local();
+            ++stats->primaryRays;
+        }
+
+        RTTHitResult hitRecord;
+        if (!world.Hit(ray, 0.001, RT::infinity, hitRecord))
+        {
+            if constexpr (RT::renderStats) ++stats->skyMisses;
+            if (outFirstHit != nullptr) *outFirstHit = {RTType::colorWhite, -UnitVector(ray.Direction()), GuideBuffers::skyDepth};
+            return RTType::colorWhite;
+        }
+        if constexpr (RT::renderStats) ++stats->surfaceHits;
+        if (outFirstHit != nullptr) *outFirstHit = {RTType::colorWhite, hitRecord.normal, hitRecord.t * ray.Direction().Length()};
+
+        // Each occlusion ray takes the dimensions of one bounce, normal plus a unit vector is cosine-weighted like a diffuse bounce
+        RT::Sampler& sampler = RT::ThreadSampler();
+        int openCount = 0;
+        for (int index = 0; index < rayCount; ++index)
+        {
+            sampler.StartBounce(index);
+            RTTVector3 direction = hitRecord.normal + RTType::SampleUnitVector();
+            if (direction.NearZero()) direction = hitRecord.normal;
+            if (!world.Occluded(RTTRay(hitRecord.point, direction), 0.001, distance / direction.Length())) ++openCount;
+        }
+        if constexpr (RT::renderStats) stats->occlusionRays += static_cast<uint64_t>(rayCount);
+
+        const RT::Real open = static_cast<RT::Real>(openCount) / static_cast<RT::Real>(rayCount);
+        return RTTColor(open, open, open);
+    }
+
+    RTTColor PathIntegrator::RenderSample(const RT::Settings& settings, const RTObject::Camera& camera, const RTTHittable& world,
+        const int i, const int y, const int sample, FirstHit* outFirstHit) const
+    {
+        const RTTRay ray = PixelRay(settings, camera, i, y, sample);
+        if (settings.ambientOcclusionRays > 0)
+        {
+            return AmbientOcclusion(ray, world, settings.ambientOcclusionRays, static_cast<RT::Real>(settings.ambientOcclusionDistance), outFirstHit);
+        }
+        return RayColor(ray, world, outFirstHit);
+    }
+
+    void PathIntegrator::RenderTile(FrameBuffer& image, const RT::Settings& settings, const RTObject::Camera& camera,
+        const RTTHittable& world, const Tile& tile, GuideBuffers* guides) const
+    {
+        for (int y = tile.y0; y < tile.y1; ++y)
+        {
+            for (int i = tile.x0; i < tile.x1; ++i)
+            {
+                RTTColor pixelColor(0.0, 0.0, 0.0);
+                if (guides == nullptr)
+                {
+                    for (int sample = 0; sample < settings.samplesPerPixel; ++sample)
+                    {
+                        pixelColor += RenderSample(settings, camera, world, i, y, sample);
+                    }
+                }
+                else
+                {
+                    FirstHit firstHit;
+                    FirstHit firstHitSum{RTTColor(0.0, 0.0, 0.0), RTTVector3(0.0, 0.0, 0.0), 0};
+                    for (int sample = 0; sample < settings.samplesPerPixel; ++sample)
+                    {
+                        pixelColor += RenderSample(settings, camera, world, i, y, sample, &firstHit);
+                        firstHitSum.albedo += firstHit.albedo;
+                        firstHitSum.normal += firstHit.normal;
+                        firstHitSum.depth += firstHit.depth;
+                    }
+                    const RT::Real scale = RT::Real(1) / static_cast<RT::Real>(settings.samplesPerPixel);
+                    guides->Set(i, y, firstHitSum.albedo * scale, firstHitSum.normal * scale, firstHitSum.depth * scale);
+                }
+
+                RTType::WriteColor(image.Pixel(i, y), pixelColor, settings.samplesPerPixel);
+            }
+        }
+    }
+
+    void PathIntegrator::AccumulateTile(RadianceBuffer& radiance, const RT::Settings& settings, const RTObject::Camera& camera,
+        const RTTHittable& world, const Tile& tile, const int sampleEnd) const
+    {
+        for (int y = tile.y0; y < tile.y1; ++y)
+        {
+            for (int i = tile.x0; i < tile.x1; ++i)
+            {
+                // Same sum, in the same order, as RenderTile takes the samples in one go
+                uint16_t& sampleCount = radiance.SampleCount(i, y);
+                RT::Real* sum = radiance.Sum(i, y);
+                RTTColor pixelColor(sum[0], sum[1], sum[2]);
+                for (int sample = sampleCount; sample < sampleEnd; ++sample)
+                {
+                    pixelColor += RenderSample(settings, camera, world, i, y, sample);
+                }
+
+                sum[0] = pixelColor.x;
+                sum[1] = pixelColor.y;
+                sum[2] = pixelColor.z;
+                sampleCount = static_cast<uint16_t>(std::max<int>(sampleCount, sampleEnd));
+            }
+        }
+    }
+
+    bool PathIntegrator::Survives(const int depth, RTTColor& throughput) const
+    {
+        if (depth + 1 < minDepth) return true;
+
+        const RT::Real survival = std::min(RT::Real(1), std::max(throughput.x, std::max(throughput.y, throughput.z)));
+        RT::ThreadSampler().StartRoulette(depth);
+        if (RT::SampleDouble() >= survival) return false;
+
+        throughput /= survival;
+        return true;
+    }
+
+    int PathIntegrator::GetMaxDepth() const
+    {
+        return maxDepth;
+    }
+
+    RTTRay PixelRay(const RT::Settings& settings, const RTObject::Camera& camera, const int i, const int y, const int sample)
+    {
+        // Image rows go top to bottom, camera rows bottom to top
+        const int j = settings.imageHeight - 1 - y;
+        RT::Sampler& sampler = RT::ThreadSampler();
+        sampler.StartSample(settings.sampler, settings.seed, i, y, settings.imageWidth, sample);
+        double jitterX, jitterY;
+        sampler.Next2D(jitterX, jitterY);
+        const double col = (static_cast<double>(i) + jitterX) / (settings.imageWidth - 1);
+        const double row = (static_cast<double>(j) + jitterY) / (settings.imageHeight - 1);
+        return camera.GetRay(col, row);
+    }
+
+    RTTColor SkyColor(const RTTVector3& direction)
+    {
+        // Scale ray direction to unit length (-1.0, 1.0)
+        const RTTVector3 unitDirection = UnitVector(direction);
+
+        // Scale y axis to [0, 1];
+        const double t = 0.5 * (unitDirection.y + 1.0);
+
+        // When scaled height is 1 return sky blue, 
+        // when scaled height is 0 return white,
+        // else return blend of blue and white
+        return t * RTType::colorSkyBlue + (1.0 - t) * RTType::colorWhite;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Denoiser.h"
+#include "FrameBuffer.h"
+#include "RadianceBuffer.h"
+#include "TileScheduler.h"
+
+#include "Common/Settings.h"
+#include "Objects/Camera.h"
+#include "Types/RTTypes.h"
+
+#include <vector>
+
+namespace RTRender
+{
+    // Surface a camera ray hits first: the guides of the denoiser, recorded while the path is traced anyway
+    struct FirstHit
+    {
+        RTTColor albedo;
+        RTTVector3 normal;
+        RT::Real depth{};
+    };
+
+    /*
+     * Iterative path tracer. Throughput is carried along the path instead of being multiplied on the way back
+     * out of a recursion, and after minDepth bounces a path survives each bounce only with a probability
+     * equal to its largest throughput component, weighted up by the inverse of that probability when it does.
+     * This Russian roulette keeps the estimate unbiased while dropping paths that could add almost nothing.
+     */
+    class PathIntegrator
+    {
+    private:
+        int minDepth;
+        int maxDepth;
+
+    public:
+        // minDepth >= maxDepth turns Russian roulette off
+        PathIntegrator(int inMinDepth, int inMaxDepth);
+
+        // Radiance along a camera ray, with the surface it hits first in outFirstHit when that is given
+        [[nodiscard]] RTTColor RayColor(const RTTRay& ray, const RTTHittable& world, FirstHit* outFirstHit = nullptr) const;
+
+        /*
+         * Ambient occlusion along a camera ray: the share of rayCount cosine-weighted rays from the surface it hits that
+         * meet nothing within distance, as a gray level, and white for the sky. Only occlusion queries follow the first
+         * hit, so it costs a fraction of a path and suits previews and utility passes.
+         */
+        [[nodiscard]] RTTColor AmbientOcclusion(const RTTRay& ray, const RTTHittable& world, int rayCount, RT::Real distance,
+            FirstHit* outFirstHit = nullptr) const;
+
+        // Color of one sample of pixel (i, y), rows counted from the top of the image, path traced or ambient occlusion
+        [[nodiscard]] RTTColor RenderSample(const RT::Settings& settings, const RTObject::Camera& camera, const RTTHittable& world,
+            int i, int y, int sample, FirstHit* outFirstHit = nullptr) const;
+
+        /*
+         * Average of samplesPerPixel samples for every pixel of the tile, into a linear RGB framebuffer, and of the
+         * first hits of those samples into the guide buffers when they are given
+         */
+        void RenderTile(FrameBuffer& image, const RT::Settings& settings, const RTObject::Camera& camera, const RTTHittable& world,
+            const Tile& tile, GuideBuffers* guides = nullptr) const;
+
+        // Take samples [held, sampleEnd) of every pixel of the tile, adding each one to its radiance sum in turn
+        void AccumulateTile(RadianceBuffer& radiance, const RT::Settings& settings, const RTObject::Camera& camera, const RTTHittable& world,
+            const Tile& tile, int sampleEnd) const;
+
+        /*
+         * Russian roulette after the bounce at depth. Returns false when the path ends here,
+         * otherwise reweights throughput by the inverse survival probability.
+         */
+        [[nodiscard]] bool Survives(int depth, RTTColor& throughput) const;
+
+        [[nodiscard]] int GetMaxDepth() const;
+    };
+
+    /*
+     * Camera ray through a random point of pixel (i, y), rows counted from the top of the image.
+     * Restarts the thread generator on the stream of this sample first, the path continues on that stream.
+     */
+    RTTRay PixelRay(const RT::Settings& settings, const RTObject::Camera& camera, int i, int y, int sample);
+
+    // Blend of white at the horizon and sky blue at the zenith
+    RTTColor SkyColor(const RTTVector3& direction);
+}
@@ -0,0 +1,254 @@
+#include "PngEncoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+    constexpr int hashBits = 15;
+    constexpr int maxDistance = 32768;
+    constexpr int minMatch = 3;
+    constexpr int maxMatch = 258;
+
+    constexpr int lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    constexpr int lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    constexpr int distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    constexpr int distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    const std::array<uint32_t, 256>& CrcTable()
+    {
+        static const std::array<uint32_t, 256> table = []
+        {
+            std::array<uint32_t, 256> result{};
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                {
+                    c = (c & 1u) ? 0xedb88320u ^ (c >> 1u) : c >> 1u;
+                }
+                result[n] = c;
+            }
+            return result;
+        }();
+        return table;
+    }
+
+    uint32_t UpdateCrc(uint32_t crc, const uint8_t* data, const size_t size)
+    {
+        const std::array<uint32_t, 256>& table = CrcTable();
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = table[(crc ^ data[i]) & 0xffu] ^ (crc >> 8u);
+        }
+        return crc;
+    }
+
+    void PutBigEndian(uint8_t* out, const uint32_t value)
+    {
+        out[0] = static_cast<uint8_t>(value >> 24u);
+        out[1] = static_cast<uint8_t>(value >> 16u);
+        out[2] = static_cast<uint8_t>(value >> 8u);
+        out[3] = static_cast<uint8_t>(value);
+    }
+
+    uint32_t ReverseBits(uint32_t code, const int length)
+    {
+        uint32_t result = 0;
+        for (int i = 0; i < length; ++i)
+        {
+            result = (result << 1u) | (code & 1u);
+            code >>= 1u;
+        }
+        return result;
+    }
+}
+
+namespace RTRender
+{
+    PngEncoder::PngEncoder(FILE* inFile, const int inWidth, const int inHeight)
+        : file(inFile), width(inWidth), height(inHeight)
+        , previousRow(static_cast<size_t>(inWidth) * 3, 0)
+        , hashTable(1u << hashBits)
+    {
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        std::fwrite(signature, 1, sizeof(signature), file);
+
+        // Width, height, bit depth 8, color type 2 (RGB), deflate, adaptive filtering, no interlace
+        uint8_t header[13] = {};
+        PutBigEndian(header, static_cast<uint32_t>(width));
+        PutBigEndian(header + 4, static_cast<uint32_t>(height));
+        header[8] = 8;
+        header[9] = 2;
+        WriteChunk("IHDR", header, sizeof(header));
+
+        // zlib header: deflate with a 32K window, no preset dictionary, check bits make it divisible by 31
+        compressed.push_back(0x78);
+        compressed.push_back(0x01);
+    }
+
+    void PngEncoder::WriteRows(const uint8_t* rows, const int rowCount)
+    {
+        const size_t rowSize = static_cast<size_t>(width) * 3;
+        filtered.resize(static_cast<size_t>(rowCount) * (rowSize + 1));
+
+        uint8_t* out = filtered.data();
+        for (int row = 0; row < rowCount; ++row)
+        {
+            const uint8_t* current = rows + row * rowSize;
+            *out++ = 2;
+            for (size_t i = 0; i < rowSize; ++i)
+            {
+                out[i] = static_cast<uint8_t>(current[i] - previousRow[i]);
+            }
+            out += rowSize;
+            std::memcpy(previousRow.data(), current, rowSize);
+        }
+
+        UpdateAdler(filtered.data(), filtered.size());
+        Deflate(filtered.data(), filtered.size());
+        FlushBytes();
+    }
+
+    void PngEncoder::Finish()
+    {
+        // Final empty fixed-Huffman block, then pad to a byte boundary and append the Adler-32 of the raw data
+        PutBits(1u | (1u << 1u), 3);
+        PutLiteral(256);
+        if (bitCount > 0)
+        {
+            PutBits(0, 8 - bitCount % 8);
+        }
+
+        uint8_t adler[4];
+        PutBigEndian(adler, (adlerB << 16u) | adlerA);
+        compressed.insert(compressed.end(), adler, adler + 4);
+        FlushBytes();
+
+        WriteChunk("IEND", nullptr, 0);
+    }
+
+    void PngEncoder::Deflate(const uint8_t* data, const size_t size)
+    {
+        // One non-final block with the fixed Huffman codes
+        PutBits(1u << 1u, 3);
+
+        // Greedy LZ77 with a single hash probe; matches never reach into the previous batch
+        std::fill(hashTable.begin(), hashTable.end(), -1);
+        size_t position = 0;
+        while (position < size)
+        {
+            if (position + minMatch <= size)
+            {
+                const uint32_t key = (static_cast<uint32_t>(data[position]) << 16u) | (static_cast<uint32_t>(data[position + 1]) << 8u) | data[position + 2];
+                const uint32_t hash = (key * 2654435761u) >> (32 - hashBits);
+                const int32_t candidate = hashTable[hash];
+                hashTable[hash] = static_cast<int32_t>(position);
+
+                if (candidate >= 0 && position - candidate <= maxDistance)
+                {
+                    const size_t limit = std::min(size - position, static_cast<size_t>(maxMatch));
+                    size_t length = 0;
+                    while (length < limit && data[candidate + length] == data[position + length])
+                    {
+                        ++length;
+                    }
+
+                    if (length >= minMatch)
+                    {
+                        PutMatch(static_cast<int>(length), static_cast<int>(position - candidate));
+                        position += length;
+                        continue;
+                    }
+                }
+            }
+
+            PutLiteral(data[position]);
+            ++position;
+        }
+
+        PutLiteral(256);
+    }
+
+    void PngEncoder::PutBits(const uint32_t bits, const int count)
+    {
+        bitBuffer |= static_cast<uint64_t>(bits) << bitCount;
+        bitCount += count;
+        while (bitCount >= 8)
+        {
+            compressed.push_back(static_cast<uint8_t>(bitBuffer));
+            bitBuffer >>= 8u;
+            bitCount -= 8;
+        }
+    }
+
+    void PngEncoder::PutHuffman(const uint32_t code, const int length)
+    {
+        // Huffman codes are packed starting from their most significant bit
+        PutBits(ReverseBits(code, length), length);
+    }
+
+    void PngEncoder::PutLiteral(const int symbol)
+    {
+        if (symbol < 144) PutHuffman(0x30 + symbol, 8);
+        else if (symbol < 256) PutHuffman(0x190 + symbol - 144, 9);
+        else if (symbol < 280) PutHuffman(symbol - 256, 7);
+        else PutHuffman(0xc0 + symbol - 280, 8);
+    }
+
+    void PngEncoder::PutMatch(const int length, const int distance)
+    {
+        int lengthCode = 28;
+        while (lengthBase[lengthCode] > length) --lengthCode;
+        PutLiteral(257 + lengthCode);
+        PutBits(static_cast<uint32_t>(length - lengthBase[lengthCode]), lengthExtra[lengthCode]);
+
+        int distanceCode = 29;
+        while (distanceBase[distanceCode] > distance) --distanceCode;
+        PutHuffman(static_cast<uint32_t>(distanceCode), 5);
+        PutBits(static_cast<uint32_t>(distance - distanceBase[distanceCode]), distanceExtra[distanceCode]);
+    }
+
+    void PngEncoder::FlushBytes()
+    {
+        if (compressed.empty()) return;
+        WriteChunk("IDAT", compressed.data(), compressed.size());
+        compressed.clear();
+    }
+
+    void PngEncoder::UpdateAdler(const uint8_t* data, size_t size)
+    {
+        // 5552 is the largest run that cannot overflow 32 bits before the modulo
+        while (size > 0)
+        {
+            const size_t run = std::min(size, static_cast<size_t>(5552));
+            for (size_t i = 0; i < run; ++i)
+            {
+                adlerA += data[i];
+                adlerB += adlerA;
+            }
+            adlerA %= 65521u;
+            adlerB %= 65521u;
+            data += run;
+            size -= run;
+        }
+    }
+
+    void PngEncoder::WriteChunk(const char* type, const uint8_t* data, const size_t size)
+    {
+        uint8_t header[8];
+        PutBigEndian(header, static_cast<uint32_t>(size));
+        std::memcpy(header + 4, type, 4);
+
+        uint32_t crc = UpdateCrc(0xffffffffu, header + 4, 4);
+        if (size > 0) crc = UpdateCrc(crc, data, size);
+
+        uint8_t footer[4];
+        PutBigEndian(footer, crc ^ 0xffffffffu);
+
+        std::fwrite(header, 1, sizeof(header), file);
+        if (size > 0) std::fwrite(data, 1, size, file);
+        std::fwrite(footer, 1, sizeof(footer), file);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace RTRender
+{
+    /*
+     * Streaming 8-bit RGB PNG encoder.
+     * Rows are filtered with the Up filter and compressed with LZ77 and the fixed deflate Huffman codes,
+     * each batch of rows becoming one deflate block and one IDAT chunk, so encoding can start long before
+     * the last row exists.
+     */
+    class PngEncoder
+    {
+    private:
+        FILE* file;
+        int width;
+        int height;
+
+        std::vector<uint8_t> previousRow;
+        std::vector<uint8_t> filtered;
+        std::vector<uint8_t> compressed;
+        std::vector<int32_t> hashTable;
+
+        uint64_t bitBuffer = 0;
+        int bitCount = 0;
+        uint32_t adlerA = 1;
+        uint32_t adlerB = 0;
+
+    public:
+        PngEncoder(FILE* inFile, int inWidth, int inHeight);
+
+        // Append rowCount rows of packed RGB bytes, top to bottom
+        void WriteRows(const uint8_t* rows, int rowCount);
+        void Finish();
+
+    private:
+        void Deflate(const uint8_t* data, size_t size);
+        void PutBits(uint32_t bits, int count);
+        void PutHuffman(uint32_t code, int length);
+        void PutLiteral(int symbol);
+        void PutMatch(int length, int distance);
+        void FlushBytes();
+        void UpdateAdler(const uint8_t* data, size_t size);
+        void WriteChunk(const char* type, const uint8_t* data, size_t size);
+    };
+}
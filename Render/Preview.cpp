@@ -0,0 +1,194 @@
+#include "Preview.h"
+
+#include "ImageWriter.h"
+
+#include "Common/Common.h"
+#include "Common/Files.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace
+{
+    // Time the server thread waits for a connection before it looks whether it should stop
+    constexpr int acceptPollMilliseconds = 100;
+    // Time a viewer may leave the image unread before it is dropped for the next one
+    constexpr int clientSendTimeoutMilliseconds = 1000;
+}
+
+namespace RTRender
+{
+    double PreviewStats::TimeToFirstImage() const
+    {
+        return levels.empty() ? 0.0 : levels.front().readySeconds;
+    }
+
+    void PreviewStats::Print(std::ostream& out) const
+    {
+        out << "Preview: first image after " << 1000.0 * TimeToFirstImage() << " ms, " << levels.size() << " levels\n";
+        for (const Level& level : levels)
+        {
+            out << "  " << level.width << "x" << level.height << " at " << level.samplesPerPixel << " spp: rendered in "
+                << 1000.0 * level.renderSeconds << " ms, published in " << 1000.0 * level.publishSeconds << " ms, shown after "
+                << 1000.0 * level.readySeconds << " ms\n";
+        }
+    }
+
+    PreviewPublisher::PreviewPublisher(const std::string& inPath, const int port, const int inWidth, const int inHeight)
+        : path(inPath), width(inWidth), height(inHeight)
+    {
+#ifdef _WIN32
+        if (path == "-") _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        if (port < 0) return;
+
+        listener = RT::Socket::Listen("127.0.0.1", port);
+        isOpen = listener.IsOpen();
+        if (isOpen)
+        {
+            server = std::thread(&PreviewPublisher::Serve, this);
+        }
+    }
+
+    PreviewPublisher::~PreviewPublisher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping.store(true);
+            listener.Shutdown();
+            client.Shutdown();
+        }
+        if (server.joinable()) server.join();
+    }
+
+    bool PreviewPublisher::IsOpen() const
+    {
+        return isOpen;
+    }
+
+    int PreviewPublisher::GetPort() const
+    {
+        return listener.IsOpen() ? listener.LocalPort() : -1;
+    }
+
+    bool PreviewPublisher::Publish(const FrameBuffer& image)
+    {
+        auto bytes = std::make_shared<std::vector<uint8_t>>();
+        ImageWriter::EncodePpm(image, width, height, *bytes);
+
+        if (path == "-")
+        {
+            hasFailed |= std::fwrite(bytes->data(), 1, bytes->size(), stdout) != bytes->size() || std::fflush(stdout) != 0;
+        }
+        else if (!path.empty())
+        {
+            const std::string temporaryPath = path + ".tmp";
+            FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+            bool isWritten = file != nullptr && std::fwrite(bytes->data(), 1, bytes->size(), file) == bytes->size();
+            isWritten &= file != nullptr && std::fclose(file) == 0;
+            if (!isWritten || !RT::ReplaceFile(temporaryPath, path))
+            {
+                std::remove(temporaryPath.c_str());
+                hasFailed = true;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        latest = std::move(bytes);
+        return !hasFailed;
+    }
+
+    void PreviewPublisher::Serve()
+    {
+        std::vector<char> isReadable;
+        while (!isStopping.load())
+        {
+            if (!RT::Socket::WaitReadable({&listener}, acceptPollMilliseconds, isReadable)) return;
+            if (!isReadable[0]) continue;
+
+            RT::Socket connection = listener.Accept();
+            if (!connection.IsOpen()) continue;
+            connection.SetSendTimeout(clientSendTimeoutMilliseconds);
+            std::shared_ptr<const std::vector<uint8_t>> image;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (isStopping.load()) return;
+                client = std::move(connection);
+                image = latest;
+            }
+            // A viewer that went away or stopped reading only loses this image
+            if (image) client.SendAll(image->data(), image->size());
+            std::lock_guard<std::mutex> lock(mutex);
+            client.Close();
+        }
+    }
+
+    bool RenderPreview(const RT::Settings& settings, const RTObject::Camera& camera, const RTTHittable& world, WorkerPool& pool,
+        FrameRenderer& renderer, RadianceBuffer& radiance, PreviewPublisher& publisher, PreviewStats& outStats, std::ostream& log)
+    {
+        if (settings.wavefront || renderer.IsAdaptive())
+        {
+            log << "Previews need depth-first rendering with a fixed sample count, without --wavefront and --adaptive.\n";
+            return false;
+        }
+
+        outStats = PreviewStats();
+        const auto start = std::chrono::steady_clock::now();
+        auto publish = [&](const FrameBuffer& image, PreviewStats::Level& level)
+        {
+            const auto publishStart = std::chrono::steady_clock::now();
+            const bool isPublished = publisher.Publish(image);
+            level.publishSeconds = RT::SecondsSince(publishStart);
+            level.readySeconds = RT::SecondsSince(start);
+            if (!isPublished) log << "Failed to write the preview to " << settings.previewPath << ".\n";
+            return isPublished;
+        };
+
+        // Coarse levels: the whole image at a fraction of its size, one sample per pixel
+        for (int shift = settings.previewLevels; shift > 0; --shift)
+        {
+            RT::Settings levelSettings = settings;
+            levelSettings.imageWidth = std::max(1, settings.imageWidth >> shift);
+            levelSettings.imageHeight = std::max(1, settings.imageHeight >> shift);
+            levelSettings.samplesPerPixel = 1;
+            FrameRenderer levelRenderer(levelSettings, camera, world, pool);
+            FrameBuffer levelImage(levelSettings.imageWidth, levelSettings.imageHeight);
+
+            PreviewStats::Level& level = outStats.levels.emplace_back();
+            level.width = levelSettings.imageWidth;
+            level.height = levelSettings.imageHeight;
+            level.samplesPerPixel = 1;
+            const TileScheduler::Stats levelStats = levelRenderer.RenderRows(levelImage, 0, levelSettings.imageHeight);
+            outStats.scheduler += levelStats;
+            level.renderSeconds = levelStats.wallSeconds;
+            outStats.primaryRays += static_cast<double>(levelSettings.PixelCount());
+            if (!publish(levelImage, level)) return false;
+        }
+
+        // Full-size passes, each with twice the samples of the last
+        FrameBuffer image(settings.imageWidth, settings.imageHeight);
+        const double samplesBefore = static_cast<double>(radiance.SampleTotal());
+        for (int samples = radiance.MinSampleCount(); samples < settings.samplesPerPixel;)
+        {
+            samples = std::min(settings.samplesPerPixel, std::max(1, 2 * samples));
+            const TileScheduler::Stats passStats = renderer.AccumulateSamples(radiance, samples);
+            outStats.scheduler += passStats;
+
+            PreviewStats::Level& level = outStats.levels.emplace_back();
+            level.width = settings.imageWidth;
+            level.height = settings.imageHeight;
+            level.samplesPerPixel = samples;
+            level.renderSeconds = passStats.wallSeconds;
+            radiance.Resolve(image);
+            if (!publish(image, level)) return false;
+        }
+        outStats.primaryRays += static_cast<double>(radiance.SampleTotal()) - samplesBefore;
+        return true;
+    }
+}
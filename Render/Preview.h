@@ -0,0 +1,102 @@
+#pragma once
+
+#include "FrameBuffer.h"
+#include "FrameRenderer.h"
+#include "RadianceBuffer.h"
+#include "TileScheduler.h"
+#include "WorkerPool.h"
+
+#include "Common/Settings.h"
+#include "Common/Socket.h"
+#include "Objects/Camera.h"
+#include "Types/RTTypes.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace RTRender
+{
+    struct PreviewStats
+    {
+        struct Level
+        {
+            int width{};
+            int height{};
+            int samplesPerPixel{};
+            double renderSeconds{};
+            double publishSeconds{};
+            // Since the preview started, once the image of the level was published
+            double readySeconds{};
+        };
+
+        std::vector<Level> levels;
+        // Primary rays of all levels, the coarse ones included
+        double primaryRays{};
+        // Coarse levels and full-size passes one after the other
+        TileScheduler::Stats scheduler;
+
+        [[nodiscard]] double TimeToFirstImage() const;
+
+        void Print(std::ostream& out) const;
+    };
+
+    /*
+     * Where preview images go, each one a binary PPM of the full image size. A file is written next to its path and
+     * then renamed over it, so a viewer that polls the file never reads half an image; "-" streams the images one after
+     * the other to standard output. A port is served from a thread of its own: every connection to it on localhost
+     * gets the latest image and is closed, connections before the first image get nothing. A viewer that stops reading
+     * is dropped after a send timeout, and one still connected when the publisher goes away is shut down.
+     */
+    class PreviewPublisher
+    {
+    private:
+        std::string path;
+        int width;
+        int height;
+        RT::Socket listener;
+        std::thread server;
+        std::atomic<bool> isStopping{false};
+        // Guards latest and the client being replaced, not the send to it
+        std::mutex mutex;
+        std::shared_ptr<const std::vector<uint8_t>> latest;
+        // Connection the server thread is sending to, shut down when the publisher goes away
+        RT::Socket client;
+        bool isOpen = true;
+        bool hasFailed = false;
+
+    public:
+        // An empty path writes no file, a negative port serves nothing
+        PreviewPublisher(const std::string& inPath, int port, int inWidth, int inHeight);
+        ~PreviewPublisher();
+
+        PreviewPublisher(const PreviewPublisher&) = delete;
+        PreviewPublisher& operator=(const PreviewPublisher&) = delete;
+
+        // False when the port could not be listened on
+        [[nodiscard]] bool IsOpen() const;
+        // Port being served, -1 when none
+        [[nodiscard]] int GetPort() const;
+
+        // Image of a frame buffer holding a whole level, scaled up to the full size; false once a write failed
+        bool Publish(const FrameBuffer& image);
+
+    private:
+        void Serve();
+    };
+
+    /*
+     * Preview render for look-dev. settings.previewLevels coarse levels of one sample per pixel come first, the
+     * smallest at 1 / 2^previewLevels of the image size, then full-size passes into the radiance buffer double the
+     * samples per pixel up to settings.samplesPerPixel. Every level is published as soon as it is done. The radiance
+     * buffer ends up with the samples of a depth-first render, so the final image is bit-identical to one.
+     * Depth-first rendering with a fixed sample count only; false with a message on log otherwise or when publishing fails.
+     */
+    bool RenderPreview(const RT::Settings& settings, const RTObject::Camera& camera, const RTTHittable& world, WorkerPool& pool,
+        FrameRenderer& renderer, RadianceBuffer& radiance, PreviewPublisher& publisher, PreviewStats& outStats, std::ostream& log);
+}
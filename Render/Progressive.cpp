@@ -0,0 +1,91 @@
+#include "Progressive.h"
+
+#include "Common/Common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+    std::atomic<bool> isStopRequested{false};
+
+    extern "C" void RequestStop(int)
+    {
+        isStopRequested.store(true, std::memory_order_relaxed);
+    }
+
+    bool FileExists(const std::string& path)
+    {
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) return false;
+        std::fclose(file);
+        return true;
+    }
+}
+
+namespace RTRender
+{
+    void ProgressiveStats::Print(std::ostream& out) const
+    {
+        out << "Progressive: " << resumedSamples << " to " << finalSamples << " samples per pixel, " << checkpointCount << " checkpoints written in "
+            << checkpointSeconds << " s" << (isInterrupted ? ", stopped" : "") << "\n";
+    }
+
+    bool RenderProgressive(const RT::Settings& settings, FrameRenderer& renderer, RadianceBuffer& radiance, ProgressiveStats& outStats, std::ostream& log)
+    {
+        if (settings.wavefront || renderer.IsAdaptive())
+        {
+            log << "Checkpoints need depth-first rendering with a fixed sample count, without --wavefront and --adaptive.\n";
+            return false;
+        }
+
+        outStats = ProgressiveStats();
+        if (FileExists(settings.checkpointPath))
+        {
+            if (!radiance.Load(settings.checkpointPath, settings, log)) return false;
+            outStats.resumedSamples = radiance.MinSampleCount();
+            log << "Resuming " << settings.checkpointPath << " at " << outStats.resumedSamples << " samples per pixel.\n";
+        }
+        const double samplesBefore = static_cast<double>(radiance.SampleTotal());
+
+        // A stop request lets the tiles in flight finish, then the samples taken so far are saved
+        isStopRequested.store(false);
+        const auto previousInterrupt = std::signal(SIGINT, RequestStop);
+        const auto previousTerminate = std::signal(SIGTERM, RequestStop);
+
+        bool isSaved = true;
+        auto lastCheckpoint = std::chrono::steady_clock::now();
+        for (int samples = outStats.resumedSamples; samples < settings.samplesPerPixel && !isStopRequested.load();)
+        {
+            samples = std::min(settings.samplesPerPixel, samples + settings.passSamples);
+            outStats.scheduler += renderer.AccumulateSamples(radiance, samples, &isStopRequested);
+
+            const bool isLastPass = samples >= settings.samplesPerPixel || isStopRequested.load();
+            if (isLastPass || RT::SecondsSince(lastCheckpoint) >= settings.checkpointSeconds)
+            {
+                const auto saveStart = std::chrono::steady_clock::now();
+                isSaved = radiance.Save(settings.checkpointPath, settings, log);
+                if (!isSaved) break;
+                outStats.checkpointSeconds += RT::SecondsSince(saveStart);
+                ++outStats.checkpointCount;
+                lastCheckpoint = std::chrono::steady_clock::now();
+            }
+        }
+
+        std::signal(SIGINT, previousInterrupt);
+        std::signal(SIGTERM, previousTerminate);
+        outStats.isInterrupted = isStopRequested.load();
+        outStats.finalSamples = radiance.MinSampleCount();
+        outStats.primaryRays = static_cast<double>(radiance.SampleTotal()) - samplesBefore;
+        if (outStats.isInterrupted)
+        {
+            log << "Stopped at " << outStats.finalSamples << " samples per pixel, run the same command again to resume from "
+                << settings.checkpointPath << ".\n";
+        }
+        return isSaved && !outStats.isInterrupted;
+    }
+}
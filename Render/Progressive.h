@@ -0,0 +1,37 @@
+#pragma once
+
+#include "FrameRenderer.h"
+#include "RadianceBuffer.h"
+#include "TileScheduler.h"
+
+#include "Common/Settings.h"
+
+#include <iostream>
+
+namespace RTRender
+{
+    struct ProgressiveStats
+    {
+        // Samples per pixel the checkpoint held when the render started, 0 for a new render
+        int resumedSamples{};
+        int finalSamples{};
+        int checkpointCount{};
+        double checkpointSeconds{};
+        // Primary rays traced by this run, not counting those of the checkpoint
+        double primaryRays{};
+        bool isInterrupted{};
+        TileScheduler::Stats scheduler;
+
+        void Print(std::ostream& out) const;
+    };
+
+    /*
+     * Progressive render with checkpoints. Samples are taken in passes of settings.passSamples per pixel into the
+     * radiance buffer, which is saved to settings.checkpointPath once settings.checkpointSeconds have passed since the
+     * last save, and after the last pass. A checkpoint found at that path is resumed from: a render that was stopped,
+     * or that asks for more samples than its checkpoint holds, takes only the samples that are missing. The image is
+     * bit-identical to a render that was never stopped, and to a single-pass depth-first render.
+     * SIGINT and SIGTERM stop the render at the next tile with a checkpoint. False on errors and when stopped.
+     */
+    bool RenderProgressive(const RT::Settings& settings, FrameRenderer& renderer, RadianceBuffer& radiance, ProgressiveStats& outStats, std::ostream& log);
+}
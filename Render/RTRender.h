@@ -0,0 +1,39 @@
+#pragma once
+
+#include "AdaptiveSampling.h"
+#include "Animation.h"
+#include "Denoiser.h"
+#include "Distributed.h"
+#include "FrameBuffer.h"
+#include "FrameRenderer.h"
+#include "ImageWriter.h"
+#include "Integrator.h"
+#include "PngEncoder.h"
+#include "Preview.h"
+#include "Progressive.h"
+#include "RadianceBuffer.h"
+#include "RenderStats.h"
+#include "TileScheduler.h"
+#include "Wavefront.h"
+#include "WorkerPool.h"
+
+using RTRAdaptiveSampler = RTRender::AdaptiveSampler;
+using RTRAnimationStats = RTRender::AnimationStats;
+using RTRDenoiser = RTRender::Denoiser;
+using RTRFrameBuffer = RTRender::FrameBuffer;
+using RTRFrameRenderer = RTRender::FrameRenderer;
+using RTRGuideBuffers = RTRender::GuideBuffers;
+using RTRImageFormat = RTRender::ImageFormat;
+using RTRImageWriter = RTRender::ImageWriter;
+using RTRPathIntegrator = RTRender::PathIntegrator;
+using RTRPixelEstimate = RTRender::PixelEstimate;
+using RTRPreviewPublisher = RTRender::PreviewPublisher;
+using RTRPreviewStats = RTRender::PreviewStats;
+using RTRProgressiveStats = RTRender::ProgressiveStats;
+using RTRRadianceBuffer = RTRender::RadianceBuffer;
+using RTRRenderReport = RTRender::RenderReport;
+using RTRRenderStats = RTRender::RenderStats;
+using RTRTile = RTRender::Tile;
+using RTRTileScheduler = RTRender::TileScheduler;
+using RTRWavefrontRenderer = RTRender::WavefrontRenderer;
+using RTRWorkerPool = RTRender::WorkerPool;
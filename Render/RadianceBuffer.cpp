@@ -0,0 +1,187 @@
+#include "RadianceBuffer.h"
+
+#include "Common/Files.h"
+#include "Common/MappedFile.h"
+#include "Common/Sampler.h"
+#include "Types/Vector3.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    constexpr char checkpointMagic[8] = {'R', 'T', 'C', 'H', 'E', 'C', 'K', '\0'};
+    constexpr uint32_t checkpointVersion = 1;
+
+    struct CheckpointHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t scalarSize;
+        uint32_t width;
+        uint32_t height;
+        uint64_t fingerprint;
+        uint64_t reserved[4];
+    };
+    static_assert(sizeof(CheckpointHeader) == 64, "checkpoint header layout changed");
+
+    // Data and metadata on the disk before the file replaces the previous checkpoint
+    bool FlushToDisk(FILE* file)
+    {
+        if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+}
+
+namespace RTRender
+{
+    RadianceBuffer::RadianceBuffer(const int inWidth, const int inHeight)
+        : width(inWidth), height(inHeight)
+    {
+        const size_t pixelCount = static_cast<size_t>(width) * static_cast<size_t>(height);
+        sums.resize(pixelCount * 3);
+        sampleCounts.resize(pixelCount);
+    }
+
+    int RadianceBuffer::GetWidth() const
+    {
+        return width;
+    }
+
+    int RadianceBuffer::GetHeight() const
+    {
+        return height;
+    }
+
+    int RadianceBuffer::MinSampleCount() const
+    {
+        return sampleCounts.empty() ? 0 : *std::min_element(sampleCounts.begin(), sampleCounts.end());
+    }
+
+    uint64_t RadianceBuffer::SampleTotal() const
+    {
+        return std::accumulate(sampleCounts.begin(), sampleCounts.end(), uint64_t{0});
+    }
+
+    void RadianceBuffer::Resolve(FrameBuffer& outImage) const
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            for (int i = 0; i < width; ++i)
+            {
+                const size_t index = PixelIndex(i, y);
+                const RT::Real* sum = sums.data() + 3 * index;
+                const int sampleCount = sampleCounts[index];
+                const RTType::Color pixelColor = sampleCount > 0 ? RTType::Color(sum[0], sum[1], sum[2]) : RTType::colorBlack;
+                RTType::WriteColor(outImage.Pixel(i, y), pixelColor, std::max(1, sampleCount));
+            }
+        }
+    }
+
+    bool RadianceBuffer::Save(const std::string& path, const RT::Settings& settings, std::ostream& errorOut) const
+    {
+        CheckpointHeader header{};
+        std::memcpy(header.magic, checkpointMagic, sizeof(checkpointMagic));
+        header.version = checkpointVersion;
+        header.scalarSize = sizeof(RT::Real);
+        header.width = static_cast<uint32_t>(width);
+        header.height = static_cast<uint32_t>(height);
+        header.fingerprint = Fingerprint(settings);
+
+        const std::string temporaryPath = path + ".tmp";
+        FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+        if (file == nullptr)
+        {
+            errorOut << "Cannot open " << temporaryPath << " for writing.\n";
+            return false;
+        }
+        bool isWritten = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        isWritten &= std::fwrite(sums.data(), sizeof(RT::Real), sums.size(), file) == sums.size();
+        isWritten &= std::fwrite(sampleCounts.data(), sizeof(uint16_t), sampleCounts.size(), file) == sampleCounts.size();
+        isWritten &= FlushToDisk(file);
+        isWritten &= std::fclose(file) == 0;
+        if (!isWritten || !RT::ReplaceFile(temporaryPath, path))
+        {
+            errorOut << "Failed to write checkpoint " << path << ".\n";
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool RadianceBuffer::Load(const std::string& path, const RT::Settings& settings, std::ostream& errorOut)
+    {
+        const RT::MappedFile file(path);
+        if (!file.IsOpen())
+        {
+            errorOut << "Cannot open checkpoint " << path << ".\n";
+            return false;
+        }
+
+        CheckpointHeader header{};
+        if (file.Size() >= sizeof(header))
+        {
+            std::memcpy(&header, file.Data(), sizeof(header));
+        }
+        if (std::memcmp(header.magic, checkpointMagic, sizeof(checkpointMagic)) != 0)
+        {
+            errorOut << path << " is not a checkpoint.\n";
+            return false;
+        }
+        if (header.version != checkpointVersion || header.scalarSize != sizeof(RT::Real))
+        {
+            errorOut << "Checkpoint " << path << " is of version " << header.version << " with " << header.scalarSize
+                << "-byte sums, this build reads version " << checkpointVersion << " with " << sizeof(RT::Real) << "-byte sums.\n";
+            return false;
+        }
+        if (header.width != static_cast<uint32_t>(width) || header.height != static_cast<uint32_t>(height) || header.fingerprint != Fingerprint(settings))
+        {
+            errorOut << "Checkpoint " << path << " is of a different image: size, seed, scene or depth do not match.\n";
+            return false;
+        }
+        const size_t dataSize = sums.size() * sizeof(RT::Real) + sampleCounts.size() * sizeof(uint16_t);
+        if (file.Size() != sizeof(header) + dataSize)
+        {
+            errorOut << "Checkpoint " << path << " is truncated.\n";
+            return false;
+        }
+
+        const uint8_t* data = file.Data() + sizeof(header);
+        std::memcpy(sums.data(), data, sums.size() * sizeof(RT::Real));
+        std::memcpy(sampleCounts.data(), data + sums.size() * sizeof(RT::Real), sampleCounts.size() * sizeof(uint16_t));
+        return true;
+    }
+
+    uint64_t RadianceBuffer::Fingerprint(const RT::Settings& settings)
+    {
+        // FNV-1a over the settings a sample depends on
+        std::string key = std::to_string(settings.imageWidth) + "x" + std::to_string(settings.imageHeight)
+            + "/seed " + std::to_string(settings.seed)
+            + "/sampler " + RT::SamplerTypeName(settings.sampler) + "/depth " + std::to_string(settings.minDepth) + "-" + std::to_string(settings.maxDepth)
+            + "/extent " + std::to_string(settings.sceneExtent) + "/cluster " + std::to_string(settings.clusterExtent) + "/group " + std::to_string(settings.sphereGroupSize)
+            + "/scene " + settings.scenePath;
+        // Path-traced checkpoints keep the key they had before ambient occlusion existed
+        if (settings.ambientOcclusionRays > 0)
+        {
+            key += "/ao " + std::to_string(settings.ambientOcclusionRays) + " within " + std::to_string(settings.ambientOcclusionDistance);
+        }
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (const char c : key)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "FrameBuffer.h"
+
+#include "Common/Config.h"
+#include "Common/Settings.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace RTRender
+{
+    /*
+     * Running radiance sums of every pixel of the image with the number of samples each one holds, the state of a
+     * progressive render. Sums are kept in the scalar the integrator accumulates in and each sample is added to them
+     * in order, so a pixel comes out the same whether its samples were taken in one pass or several, in one process
+     * or across a checkpoint.
+     */
+    class RadianceBuffer
+    {
+    private:
+        int width;
+        int height;
+        std::vector<RT::Real> sums;
+        std::vector<uint16_t> sampleCounts;
+
+    public:
+        RadianceBuffer(int inWidth, int inHeight);
+
+        [[nodiscard]] int GetWidth() const;
+        [[nodiscard]] int GetHeight() const;
+
+        // First of the three sums of pixel (i, y), rows counted from the top of the image
+        RT::Real* Sum(const int i, const int y)
+        {
+            return sums.data() + 3 * PixelIndex(i, y);
+        }
+
+        uint16_t& SampleCount(const int i, const int y)
+        {
+            return sampleCounts[PixelIndex(i, y)];
+        }
+
+        // Samples every pixel holds at least
+        [[nodiscard]] int MinSampleCount() const;
+        // Samples of all pixels together
+        [[nodiscard]] uint64_t SampleTotal() const;
+
+        // Average of the samples of every pixel into a frame buffer holding the whole image, black where there are none
+        void Resolve(FrameBuffer& outImage) const;
+
+        /*
+         * Checkpoint file: a header with the image size, the scalar size and the fingerprint of the settings, then the
+         * sums and the sample counts. Written to a temporary file next to path that then replaces it, so a render
+         * stopped while saving leaves the previous checkpoint intact.
+         */
+        bool Save(const std::string& path, const RT::Settings& settings, std::ostream& errorOut) const;
+
+        /*
+         * Load a checkpoint of the same image, false with a message on errorOut when it is missing, truncated, from a
+         * build tracing in another scalar or from settings that render a different image.
+         */
+        bool Load(const std::string& path, const RT::Settings& settings, std::ostream& errorOut);
+
+        // Hash of the settings that change the value of a sample, the sample count excepted
+        static uint64_t Fingerprint(const RT::Settings& settings);
+
+    private:
+        [[nodiscard]] size_t PixelIndex(const int i, const int y) const
+        {
+            return static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(i);
+        }
+    };
+}
@@ -0,0 +1,153 @@
+#include "RenderStats.h"
+
+#include "Common/ThreadCounters.h"
+#include "Types/BVH.h"
+
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+    using RenderCounters = RT::ThreadCounters<RTRender::RenderStats>;
+
+    const char* const materialNames[RTType::materialTypeCount] = {"lambertian", "metal", "dielectric"};
+
+    double Share(const uint64_t part, const uint64_t whole)
+    {
+        return whole > 0 ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+    }
+}
+
+namespace RTRender
+{
+    RenderStats& RenderStats::operator+=(const RenderStats& other)
+    {
+        primaryRays += other.primaryRays;
+        for (int type = 0; type < RTType::materialTypeCount; ++type)
+        {
+            secondaryRays[type] += other.secondaryRays[type];
+        }
+        occlusionRays += other.occlusionRays;
+        surfaceHits += other.surfaceHits;
+        skyMisses += other.skyMisses;
+        absorbed += other.absorbed;
+        terminatedByRoulette += other.terminatedByRoulette;
+        terminatedByDepth += other.terminatedByDepth;
+        return *this;
+    }
+
+    uint64_t RenderStats::SecondaryRays() const
+    {
+        uint64_t total = 0;
+        for (const uint64_t count : secondaryRays)
+        {
+            total += count;
+        }
+        return total;
+    }
+
+    uint64_t RenderStats::PathRays() const
+    {
+        return primaryRays + SecondaryRays();
+    }
+
+    uint64_t RenderStats::Rays() const
+    {
+        return PathRays() + occlusionRays;
+    }
+
+    double RenderStats::AveragePathLength() const
+    {
+        return primaryRays > 0 ? static_cast<double>(PathRays()) / static_cast<double>(primaryRays) : 0.0;
+    }
+
+    RenderStats& RenderStats::Local()
+    {
+        return RenderCounters::Local();
+    }
+
+    RenderStats RenderStats::Total()
+    {
+        return RenderCounters::Total();
+    }
+
+    void RenderStats::Reset()
+    {
+        RenderCounters::Reset();
+        RTType::BVH::ResetTraversalStats();
+    }
+
+    RenderReport RenderReport::Collect(const TileScheduler::Stats& schedulerStats)
+    {
+        RenderReport report;
+        report.counters = RenderStats::Total();
+        report.intersectionTests = RTType::BVH::GetTraversalStats().primitivesTested;
+        report.scheduler = schedulerStats;
+        return report;
+    }
+
+    void RenderReport::Print(std::ostream& out) const
+    {
+        const uint64_t rays = counters.Rays();
+        const double seconds = scheduler.wallSeconds;
+
+        out << "Rays: " << counters.primaryRays << " primary, " << counters.SecondaryRays() << " secondary (";
+        for (int type = 0; type < RTType::materialTypeCount; ++type)
+        {
+            out << (type > 0 ? ", " : "") << counters.secondaryRays[type] << " " << materialNames[type];
+        }
+        out << "), " << counters.occlusionRays << " occlusion, " << (seconds > 0.0 ? static_cast<double>(rays) / seconds / 1e6 : 0.0) << " M rays/s\n";
+
+        const uint64_t pathRays = counters.PathRays();
+        out << "Hits: " << counters.surfaceHits << " surface (" << Share(counters.surfaceHits, pathRays) << "%), "
+            << counters.skyMisses << " sky (" << Share(counters.skyMisses, pathRays) << "%), "
+            << (rays > 0 ? static_cast<double>(intersectionTests) / static_cast<double>(rays) : 0.0) << " intersection tests/ray\n";
+
+        out << "Paths: average length " << counters.AveragePathLength() << ", " << counters.absorbed << " absorbed, "
+            << counters.terminatedByRoulette << " ended by Russian roulette, " << counters.terminatedByDepth << " by the depth limit\n";
+
+        const std::streamsize precision = out.precision();
+        out << "Busy time per thread:" << std::fixed << std::setprecision(3);
+        for (const TileScheduler::WorkerStats& worker : scheduler.workers)
+        {
+            out << " " << worker.busySeconds;
+        }
+        out << std::defaultfloat << std::setprecision(precision) << " s\n";
+    }
+
+    bool RenderReport::WriteJson(const std::string& path) const
+    {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        out << std::setprecision(9) << "{\n"
+            << "  \"wall_seconds\": " << scheduler.wallSeconds << ",\n"
+            << "  \"primary_rays\": " << counters.primaryRays << ",\n"
+            << "  \"secondary_rays\": {";
+        for (int type = 0; type < RTType::materialTypeCount; ++type)
+        {
+            out << (type > 0 ? ", " : "") << "\"" << materialNames[type] << "\": " << counters.secondaryRays[type];
+        }
+        out << "},\n"
+            << "  \"occlusion_rays\": " << counters.occlusionRays << ",\n"
+            << "  \"rays\": " << counters.Rays() << ",\n"
+            << "  \"rays_per_second\": " << (scheduler.wallSeconds > 0.0 ? static_cast<double>(counters.Rays()) / scheduler.wallSeconds : 0.0) << ",\n"
+            << "  \"intersection_tests\": " << intersectionTests << ",\n"
+            << "  \"surface_hits\": " << counters.surfaceHits << ",\n"
+            << "  \"sky_misses\": " << counters.skyMisses << ",\n"
+            << "  \"absorbed\": " << counters.absorbed << ",\n"
+            << "  \"terminated_by_roulette\": " << counters.terminatedByRoulette << ",\n"
+            << "  \"terminated_by_depth\": " << counters.terminatedByDepth << ",\n"
+            << "  \"average_path_length\": " << counters.AveragePathLength() << ",\n"
+            << "  \"load_imbalance\": " << scheduler.LoadImbalance() << ",\n"
+            << "  \"threads\": [";
+        for (size_t worker = 0; worker < scheduler.workers.size(); ++worker)
+        {
+            const TileScheduler::WorkerStats& stats = scheduler.workers[worker];
+            out << (worker > 0 ? ", " : "") << "{\"busy_seconds\": " << stats.busySeconds << ", \"tiles\": " << stats.tilesRendered
+                << ", \"tiles_stolen\": " << stats.tilesStolen << "}";
+        }
+        out << "]\n}\n";
+        return static_cast<bool>(out);
+    }
+}
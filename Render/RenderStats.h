@@ -0,0 +1,60 @@
+#pragma once
+
+#include "TileScheduler.h"
+
+#include "Common/Config.h"
+#include "Types/Material.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace RTRender
+{
+    /*
+     * Ray and path counters. Every thread counts into its own copy, Total() merges them once the workers are idle.
+     * All counting sits behind if constexpr (RT::renderStats), so it compiles to nothing when statistics are off.
+     */
+    struct RenderStats
+    {
+        uint64_t primaryRays{};
+        // Rays leaving a surface, by the type of the material that scattered them
+        uint64_t secondaryRays[RTType::materialTypeCount]{};
+        // Any-hit visibility rays, such as those of ambient occlusion
+        uint64_t occlusionRays{};
+        uint64_t surfaceHits{};
+        uint64_t skyMisses{};
+        uint64_t absorbed{};
+        uint64_t terminatedByRoulette{};
+        uint64_t terminatedByDepth{};
+
+        RenderStats& operator+=(const RenderStats& other);
+
+        [[nodiscard]] uint64_t SecondaryRays() const;
+        // Primary and secondary rays, each ends in a surface hit or a sky miss
+        [[nodiscard]] uint64_t PathRays() const;
+        // Path rays and occlusion rays
+        [[nodiscard]] uint64_t Rays() const;
+        [[nodiscard]] double AveragePathLength() const;
+
+        // Counters of the calling thread
+        static RenderStats& Local();
+        static RenderStats Total();
+        static void Reset();
+    };
+
+    // Everything known about a finished frame
+    struct RenderReport
+    {
+        RenderStats counters;
+        // Primitives tested in BVH leaves, a SIMD sphere group counts once
+        uint64_t intersectionTests{};
+        TileScheduler::Stats scheduler;
+
+        // Totals of all threads, with the per-thread busy time of the scheduler
+        static RenderReport Collect(const TileScheduler::Stats& schedulerStats);
+
+        void Print(std::ostream& out) const;
+        bool WriteJson(const std::string& path) const;
+    };
+}
@@ -0,0 +1,196 @@
+#include "TileScheduler.h"
+
+#include "Common/Common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace RTRender
+{
+    double TileScheduler::Stats::LoadImbalance() const
+    {
+        if (workers.empty()) return 1.0;
+
+        double maxBusy = 0.0, totalBusy = 0.0;
+        for (const WorkerStats& worker : workers)
+        {
+            maxBusy = std::max(maxBusy, worker.busySeconds);
+            totalBusy += worker.busySeconds;
+        }
+        const double meanBusy = totalBusy / static_cast<double>(workers.size());
+        return meanBusy > 0.0 ? maxBusy / meanBusy : 1.0;
+    }
+
+    double TileScheduler::Stats::IdleFraction() const
+    {
+        if (workers.empty() || wallSeconds <= 0.0) return 0.0;
+
+        double totalBusy = 0.0;
+        for (const WorkerStats& worker : workers)
+        {
+            totalBusy += worker.busySeconds;
+        }
+        return std::max(0.0, 1.0 - totalBusy / (wallSeconds * static_cast<double>(workers.size())));
+    }
+
+    TileScheduler::Stats& TileScheduler::Stats::operator+=(const Stats& other)
+    {
+        workers.resize(std::max(workers.size(), other.workers.size()));
+        for (size_t worker = 0; worker < other.workers.size(); ++worker)
+        {
+            workers[worker].busySeconds += other.workers[worker].busySeconds;
+            workers[worker].finishSeconds = wallSeconds + other.workers[worker].finishSeconds;
+            workers[worker].tilesRendered += other.workers[worker].tilesRendered;
+            workers[worker].tilesStolen += other.workers[worker].tilesStolen;
+        }
+        tileCount += other.tileCount;
+        wallSeconds += other.wallSeconds;
+        return *this;
+    }
+
+    void TileScheduler::Stats::Print(std::ostream& out) const
+    {
+        int totalStolen = 0;
+        double earliestFinish = wallSeconds;
+        for (const WorkerStats& worker : workers)
+        {
+            totalStolen += worker.tilesStolen;
+            earliestFinish = std::min(earliestFinish, worker.finishSeconds);
+        }
+
+        out << "Scheduler: " << tileCount << " tiles on " << workers.size() << " workers, " << totalStolen << " stolen, "
+            << "load imbalance " << LoadImbalance() << ", idle " << 100.0 * IdleFraction() << "%, "
+            << "first worker out of work after " << earliestFinish << " s of " << wallSeconds << " s\n";
+    }
+
+    TileScheduler::TileScheduler(const int imageWidth, const int imageHeight, const int tileWidth, const int tileHeight, const bool inIsStealingEnabled)
+        : TileScheduler(Tile{0, 0, imageWidth, imageHeight}, tileWidth, tileHeight, inIsStealingEnabled)
+    {
+    }
+
+    TileScheduler::TileScheduler(const Tile& region, const int tileWidth, const int tileHeight, const bool inIsStealingEnabled)
+        : firstRow(region.y0)
+        , bandHeight(std::max(1, tileHeight))
+        , tilesPerBand((region.x1 - region.x0 + std::max(1, tileWidth) - 1) / std::max(1, tileWidth))
+        , isStealingEnabled(inIsStealingEnabled)
+    {
+        const int width = std::max(1, tileWidth);
+        const int height = bandHeight;
+        for (int y = region.y0; y < region.y1; y += height)
+        {
+            for (int x = region.x0; x < region.x1; x += width)
+            {
+                tiles.push_back({x, y, std::min(x + width, region.x1), std::min(y + height, region.y1)});
+            }
+        }
+    }
+
+    const std::vector<Tile>& TileScheduler::GetTiles() const
+    {
+        return tiles;
+    }
+
+    TileScheduler::Stats TileScheduler::Render(WorkerPool& pool, const RenderTileFunction& renderTile, const RowsFinishedFunction& onRowsFinished) const
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const int workerCount = pool.GetThreadCount();
+        std::unique_ptr<WorkerQueue[]> queues(new WorkerQueue[workerCount]);
+        if (pool.GetNodeCount() == 1)
+        {
+            for (size_t i = 0; i < tiles.size(); ++i)
+            {
+                queues[i % workerCount].tiles.push_back(tiles[i]);
+            }
+        }
+        else
+        {
+            // Each band of tiles goes to the workers of the node its rows are placed on, see FrameBuffer::PlaceRows
+            std::vector<std::vector<int>> nodeWorkers(static_cast<size_t>(pool.GetNodeCount()));
+            for (int workerId = 0; workerId < workerCount; ++workerId)
+            {
+                nodeWorkers[static_cast<size_t>(pool.GetWorkerNode(workerId))].push_back(workerId);
+            }
+            std::vector<size_t> nodeDealt(nodeWorkers.size(), 0);
+            for (const Tile& tile : tiles)
+            {
+                auto node = static_cast<size_t>(NodeOfRow(tile.y0 - firstRow, bandHeight, pool.GetNodeCount()));
+                // A node can have no workers when there are fewer workers than nodes
+                while (nodeWorkers[node].empty()) node = (node + 1) % nodeWorkers.size();
+                queues[nodeWorkers[node][nodeDealt[node]++ % nodeWorkers[node].size()]].tiles.push_back(tile);
+            }
+        }
+
+        const size_t bandCount = tiles.empty() ? 0 : static_cast<size_t>((tiles.back().y0 - firstRow) / bandHeight + 1);
+        std::unique_ptr<std::atomic<int>[]> bandTilesLeft(new std::atomic<int>[bandCount]);
+        for (size_t band = 0; band < bandCount; ++band)
+        {
+            bandTilesLeft[band] = tilesPerBand;
+        }
+
+        Stats stats;
+        stats.workers.resize(workerCount);
+        stats.tileCount = static_cast<int>(tiles.size());
+
+        const Clock::time_point start = Clock::now();
+        pool.Run([&](const int workerId)
+        {
+            WorkerStats& workerStats = stats.workers[workerId];
+            Tile tile;
+            while (true)
+            {
+                // Workers of the same node are robbed first, their tiles write memory of this node
+                bool hasTile = PopOwn(queues[workerId], tile);
+                for (int pass = 0; !hasTile && isStealingEnabled && pass < 2; ++pass)
+                {
+                    for (int offset = 1; !hasTile && offset < workerCount; ++offset)
+                    {
+                        const int victim = (workerId + offset) % workerCount;
+                        if ((pool.GetWorkerNode(victim) == pool.GetWorkerNode(workerId)) != (pass == 0)) continue;
+                        hasTile = Steal(queues[victim], tile);
+                        if (hasTile) ++workerStats.tilesStolen;
+                    }
+                }
+                if (!hasTile) break;
+
+                const Clock::time_point tileStart = Clock::now();
+                renderTile(tile, workerId);
+                workerStats.busySeconds += RT::SecondsSince(tileStart);
+                ++workerStats.tilesRendered;
+
+                if (bandTilesLeft[(tile.y0 - firstRow) / bandHeight].fetch_sub(1) == 1 && onRowsFinished)
+                {
+                    onRowsFinished(tile.y0, tile.y1);
+                }
+            }
+            workerStats.finishSeconds = RT::SecondsSince(start);
+        });
+        stats.wallSeconds = RT::SecondsSince(start);
+
+        return stats;
+    }
+
+    int TileScheduler::NodeOfRow(const int row, const int tileHeight, const int nodeCount)
+    {
+        return nodeCount > 1 ? (row / std::max(1, tileHeight)) % nodeCount : 0;
+    }
+
+    bool TileScheduler::PopOwn(WorkerQueue& queue, Tile& outTile)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tiles.empty()) return false;
+        outTile = queue.tiles.front();
+        queue.tiles.pop_front();
+        return true;
+    }
+
+    bool TileScheduler::Steal(WorkerQueue& queue, Tile& outTile)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tiles.empty()) return false;
+        outTile = queue.tiles.back();
+        queue.tiles.pop_back();
+        return true;
+    }
+}
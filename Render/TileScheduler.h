@@ -0,0 +1,88 @@
+#pragma once
+
+#include "WorkerPool.h"
+
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace RTRender
+{
+    // Rectangle of image pixels [x0, x1) x [y0, y1), rows counted from the top of the image
+    struct Tile
+    {
+        int x0{}, y0{}, x1{}, y1{};
+    };
+
+    /*
+     * Splits a frame into tiles and hands them to the workers of a pool.
+     * Tiles are dealt round-robin onto one deque per worker; a worker takes tiles from the front of its own deque
+     * and, once that is empty, steals from the back of the others, so expensive regions do not leave cores idle
+     * at the end of the frame. On a pool pinned over several NUMA nodes, bands of tiles are dealt to the nodes in turn,
+     * as NodeOfRow places their rows, and workers steal from their own node before they reach across.
+     */
+    class TileScheduler
+    {
+    public:
+        using RenderTileFunction = std::function<void(const Tile& tile, int workerId)>;
+        using RowsFinishedFunction = std::function<void(int y0, int y1)>;
+
+        struct WorkerStats
+        {
+            double busySeconds{};
+            double finishSeconds{};
+            int tilesRendered{};
+            int tilesStolen{};
+        };
+
+        struct Stats
+        {
+            std::vector<WorkerStats> workers;
+            int tileCount{};
+            double wallSeconds{};
+
+            // Busiest worker against the average one, 1.0 is a perfect balance
+            [[nodiscard]] double LoadImbalance() const;
+            // Share of worker time spent without a tile between the start and the end of the frame
+            [[nodiscard]] double IdleFraction() const;
+
+            // Append the stats of a render that followed this one on the same pool, such as the next band of a frame
+            Stats& operator+=(const Stats& other);
+
+            void Print(std::ostream& out) const;
+        };
+
+    private:
+        struct alignas(64) WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Tile> tiles;
+        };
+
+        std::vector<Tile> tiles;
+        int firstRow;
+        int bandHeight;
+        int tilesPerBand;
+        bool isStealingEnabled;
+
+    public:
+        TileScheduler(int imageWidth, int imageHeight, int tileWidth, int tileHeight, bool inIsStealingEnabled = true);
+        // Tiles of a region of the image only, tiles on its right and bottom edges are cut to it
+        TileScheduler(const Tile& region, int tileWidth, int tileHeight, bool inIsStealingEnabled = true);
+
+        [[nodiscard]] const std::vector<Tile>& GetTiles() const;
+
+        // onRowsFinished is called from the worker that completes the last tile of a horizontal band of tiles
+        Stats Render(WorkerPool& pool, const RenderTileFunction& renderTile, const RowsFinishedFunction& onRowsFinished = nullptr) const;
+
+        // Node whose workers render a row, counted from the top of the region: bands of tileHeight rows go to the nodes in turn
+        static int NodeOfRow(int row, int tileHeight, int nodeCount);
+
+    private:
+        static bool PopOwn(WorkerQueue& queue, Tile& outTile);
+        static bool Steal(WorkerQueue& queue, Tile& outTile);
+    };
+}
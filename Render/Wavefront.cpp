@@ -0,0 +1,160 @@
+#include "Wavefront.h"
+
+#include "Common/Common.h"
+
+#include <algorithm>
+
+namespace RTRender
+{
+    WavefrontRenderer::WavefrontRenderer(const PathIntegrator& inIntegrator, const RT::Settings& inSettings, const int workerCount)
+        : integrator(inIntegrator)
+          , settings(inSettings)
+          , workspaces(static_cast<size_t>(std::max(1, workerCount)))
+    {
+    }
+
+    void WavefrontRenderer::RenderTile(FrameBuffer& image, const RTObject::Camera& camera, const RTTHittable& world, const Tile& tile, const int workerId)
+    {
+        Workspace& workspace = workspaces[static_cast<size_t>(workerId)];
+
+        const int tileWidth = tile.x1 - tile.x0;
+        const size_t pixelCount = static_cast<size_t>(tileWidth) * (tile.y1 - tile.y0);
+        const int samplesPerPixel = settings.samplesPerPixel;
+        const auto batchSize = static_cast<size_t>(std::max(1, settings.wavefrontBatchSize));
+        const size_t sampleCount = pixelCount * samplesPerPixel;
+        workspace.pixels.assign(pixelCount, RTType::colorBlack);
+
+        // Samples of the tile are numbered pixel by pixel, so a batch covers whole runs of samples of each pixel
+        for (size_t batchStart = 0; batchStart < sampleCount; batchStart += batchSize)
+        {
+            const size_t batchEnd = std::min(sampleCount, batchStart + batchSize);
+            workspace.paths.resize(batchEnd - batchStart);
+
+            for (size_t k = batchStart; k < batchEnd; ++k)
+            {
+                const auto tilePixel = static_cast<int>(k / samplesPerPixel);
+                const auto sample = static_cast<int>(k % samplesPerPixel);
+                const int i = tile.x0 + tilePixel % tileWidth;
+                const int y = tile.y0 + tilePixel / tileWidth;
+
+                Path& path = workspace.paths[k - batchStart];
+                path.ray = PixelRay(settings, camera, i, y, sample);
+                path.throughput = RTType::colorWhite;
+                path.sampler = RT::ThreadSampler();
+            }
+
+            TraceBatch(workspace, world);
+
+            for (size_t k = batchStart; k < batchEnd; ++k)
+            {
+                workspace.pixels[k / samplesPerPixel] += workspace.radiance[k - batchStart];
+            }
+        }
+
+        for (size_t tilePixel = 0; tilePixel < pixelCount; ++tilePixel)
+        {
+            const int i = tile.x0 + static_cast<int>(tilePixel) % tileWidth;
+            const int y = tile.y0 + static_cast<int>(tilePixel) / tileWidth;
+            RTType::WriteColor(image.Pixel(i, y), workspace.pixels[tilePixel], samplesPerPixel);
+        }
+    }
+
+    void WavefrontRenderer::TraceBatch(Workspace& workspace, const RTTHittable& world) const
+    {
+        // Counted per batch, merged into the thread's counters at the end
+        RenderStats stats;
+
+        const size_t pathCount = workspace.paths.size();
+        if constexpr (RT::renderStats) stats.primaryRays += pathCount;
+        workspace.hits.resize(pathCount);
+        workspace.radiance.assign(pathCount, RTType::colorBlack);
+        workspace.active.resize(pathCount);
+        for (size_t index = 0; index < pathCount; ++index)
+        {
+            workspace.active[index] = static_cast<uint32_t>(index);
+        }
+
+        for (int depth = 0; depth < integrator.GetMaxDepth() && !workspace.active.empty(); ++depth)
+        {
+            // Intersect every live path, paths that leave the scene take the sky color
+            for (std::vector<uint32_t>& queue : workspace.queues)
+            {
+                queue.clear();
+            }
+            for (const uint32_t index : workspace.active)
+            {
+                const Path& path = workspace.paths[index];
+                RTTHitResult& hitRecord = workspace.hits[index];
+                if (world.Hit(path.ray, 0.001, RT::infinity, hitRecord))
+                {
+                    if constexpr (RT::renderStats) ++stats.surfaceHits;
+                    workspace.queues[static_cast<int>(hitRecord.material->GetType())].push_back(index);
+                }
+                else
+                {
+                    if constexpr (RT::renderStats) ++stats.skyMisses;
+                    workspace.radiance[index] = path.throughput * SkyColor(path.ray.Direction());
+                }
+            }
+
+            // Shade one material type at a time, surviving paths go on to the next bounce
+            workspace.next.clear();
+            ShadeQueue<RTType::Lambertian>(workspace, workspace.queues[static_cast<int>(RTType::MaterialType::Lambertian)], depth, stats);
+            ShadeQueue<RTType::Metal>(workspace, workspace.queues[static_cast<int>(RTType::MaterialType::Metal)], depth, stats);
+            ShadeQueue<RTType::Dielectric>(workspace, workspace.queues[static_cast<int>(RTType::MaterialType::Dielectric)], depth, stats);
+
+            // Keep paths in batch order, neighbouring pixels trace similar rays
+            std::sort(workspace.next.begin(), workspace.next.end());
+            std::swap(workspace.active, workspace.next);
+        }
+
+        // We've exceeded the ray bounce limit, no more light is gathered
+        if constexpr (RT::renderStats)
+        {
+            stats.terminatedByDepth += workspace.active.size();
+            RenderStats::Local() += stats;
+        }
+    }
+
+    template <typename MaterialType>
+    void WavefrontRenderer::ShadeQueue(Workspace& workspace, const std::vector<uint32_t>& queue, const int depth, RenderStats& stats) const
+    {
+        RT::Sampler& sampler = RT::ThreadSampler();
+        for (const uint32_t index : queue)
+        {
+            Path& path = workspace.paths[index];
+            const RTTHitResult& hitRecord = workspace.hits[index];
+            const auto* material = static_cast<const MaterialType*>(hitRecord.material);
+
+            // Materials draw from the thread sampler, give it the state of this path
+            sampler = path.sampler;
+            sampler.StartBounce(depth);
+
+            RTTColor attenuation;
+            RTTRay scattered;
+            if (!material->Scatter(path.ray, hitRecord, attenuation, scattered))
+            {
+                if constexpr (RT::renderStats) ++stats.absorbed;
+            }
+            else
+            {
+                path.throughput *= attenuation;
+                if (!integrator.Survives(depth, path.throughput))
+                {
+                    if constexpr (RT::renderStats) ++stats.terminatedByRoulette;
+                }
+                else
+                {
+                    path.ray = scattered;
+                    workspace.next.push_back(index);
+                    if constexpr (RT::renderStats)
+                    {
+                        if (depth + 1 < integrator.GetMaxDepth()) ++stats.secondaryRays[static_cast<int>(material->GetType())];
+                    }
+                }
+            }
+
+            path.sampler = sampler;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Integrator.h"
+#include "RenderStats.h"
+#include "TileScheduler.h"
+
+#include "Common/Sampler.h"
+#include "Common/Settings.h"
+#include "Objects/Camera.h"
+#include "Types/RTTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace RTRender
+{
+    /*
+     * Breadth-first alternative to tracing one sample at a time. A tile is rendered in batches of paths:
+     * every bounce first intersects all live paths of the batch, then sorts the hits into one queue per
+     * material type and shades each queue in its own loop, so the scatter code of one material stays hot
+     * in the caches and is called without a virtual call.
+     * Every path carries its own sampler, started exactly as in depth-first rendering, and samples
+     * are summed in the same order, so both modes produce the same image.
+     */
+    class WavefrontRenderer
+    {
+    private:
+        struct Path
+        {
+            RTTRay ray;
+            RTTColor throughput;
+            RT::Sampler sampler;
+        };
+
+        // Scratch buffers of one worker, reused for every batch
+        struct Workspace
+        {
+            std::vector<Path> paths;
+            std::vector<RTTHitResult> hits;
+            std::vector<RTTColor> radiance;
+            std::vector<uint32_t> active;
+            std::vector<uint32_t> next;
+            std::vector<uint32_t> queues[RTType::materialTypeCount];
+            std::vector<RTTColor> pixels;
+        };
+
+        const PathIntegrator& integrator;
+        const RT::Settings& settings;
+        std::vector<Workspace> workspaces;
+
+    public:
+        // Image size, samples per pixel, seed and batch size come from the settings, which must outlive the renderer
+        WavefrontRenderer(const PathIntegrator& inIntegrator, const RT::Settings& inSettings, int workerCount);
+
+        // Render one tile into a linear RGB framebuffer, workerId picks the scratch buffers
+        void RenderTile(FrameBuffer& image, const RTObject::Camera& camera, const RTTHittable& world, const Tile& tile, int workerId);
+
+    private:
+        void TraceBatch(Workspace& workspace, const RTTHittable& world) const;
+
+        template <typename MaterialType>
+        void ShadeQueue(Workspace& workspace, const std::vector<uint32_t>& queue, int depth, RenderStats& stats) const;
+    };
+}
@@ -0,0 +1,130 @@
+#include "WorkerPool.h"
+
+#include "Common/CpuTopology.h"
+#include "Common/Settings.h"
+
+#include <algorithm>
+
+namespace RTRender
+{
+    WorkerPoolOptions WorkerPoolOptions::FromSettings(const RT::Settings& settings)
+    {
+        WorkerPoolOptions options;
+        options.isPinned = settings.pinThreads;
+        options.allowOversubscription = settings.allowOversubscription;
+        return options;
+    }
+
+    WorkerPool::WorkerPool(const int inThreadCount, const WorkerPoolOptions& options)
+        : requestedThreadCount(inThreadCount > 0 ? inThreadCount : HardwareThreadCount())
+    {
+        // More workers than CPUs only take turns on them, and each switch costs the caches of the one it displaces
+        const RT::CpuTopology& topology = RT::SystemTopology();
+        const int cpuCount = static_cast<int>(topology.cpus.size());
+        const int threadCount = options.allowOversubscription ? requestedThreadCount : std::min(requestedThreadCount, cpuCount);
+
+        workerCpus.assign(threadCount, -1);
+        workerNodes.assign(threadCount, 0);
+        if (options.isPinned)
+        {
+            // Past the last CPU, oversubscribed workers start over from the first
+            const std::vector<int> order = topology.PinningOrder();
+            for (int workerId = 0; workerId < threadCount; ++workerId)
+            {
+                const RT::CpuTopology::Cpu& cpu = topology.cpus[order[workerId % cpuCount]];
+                workerCpus[workerId] = cpu.id;
+                workerNodes[workerId] = cpu.node;
+            }
+            nodeCount = topology.nodeCount;
+        }
+
+        threads.reserve(threadCount);
+        for (int workerId = 0; workerId < threadCount; ++workerId)
+        {
+            threads.emplace_back(&WorkerPool::WorkerLoop, this, workerId);
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping = true;
+        }
+        startCondition.notify_all();
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    int WorkerPool::GetThreadCount() const
+    {
+        return static_cast<int>(threads.size());
+    }
+
+    int WorkerPool::GetRequestedThreadCount() const
+    {
+        return requestedThreadCount;
+    }
+
+    bool WorkerPool::IsPinned() const
+    {
+        return !workerCpus.empty() && workerCpus.front() >= 0;
+    }
+
+    int WorkerPool::GetNodeCount() const
+    {
+        return nodeCount;
+    }
+
+    int WorkerPool::GetWorkerNode(const int workerId) const
+    {
+        return workerNodes[workerId];
+    }
+
+    void WorkerPool::Run(const Job& inJob)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        job = &inJob;
+        runningCount = static_cast<int>(threads.size());
+        ++generation;
+        startCondition.notify_all();
+        doneCondition.wait(lock, [this] { return runningCount == 0; });
+        job = nullptr;
+    }
+
+    int WorkerPool::HardwareThreadCount()
+    {
+        return static_cast<int>(RT::SystemTopology().cpus.size());
+    }
+
+    void WorkerPool::WorkerLoop(const int workerId)
+    {
+        // Pinned before the worker allocates anything, so its stack and scratch memory land on its node
+        if (workerCpus[workerId] >= 0) RT::PinCurrentThread(workerCpus[workerId]);
+
+        uint64_t seenGeneration = 0;
+        while (true)
+        {
+            const Job* currentJob;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                startCondition.wait(lock, [&] { return isStopping || generation != seenGeneration; });
+                if (isStopping) return;
+                seenGeneration = generation;
+                currentJob = job;
+            }
+
+            (*currentJob)(workerId);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--runningCount == 0)
+                {
+                    doneCondition.notify_one();
+                }
+            }
+        }
+    }
+}
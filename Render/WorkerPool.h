@@ -0,0 +1,77 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RT
+{
+    struct Settings;
+}
+
+namespace RTRender
+{
+    struct WorkerPoolOptions
+    {
+        // Pin every worker to a CPU of its own, in the order of CpuTopology::PinningOrder
+        bool isPinned = false;
+        // Keep more workers than the CPUs this process may run on, instead of cutting them down to that
+        bool allowOversubscription = false;
+
+        static WorkerPoolOptions FromSettings(const RT::Settings& settings);
+    };
+
+    /*
+     * Fixed set of threads that stay alive between jobs, so a frame does not pay for thread creation.
+     * Pinned workers know their NUMA node: the tile scheduler hands each node the rows whose memory it placed.
+     * Unpinned workers may move between nodes, so they all count as node 0 of one.
+     */
+    class WorkerPool
+    {
+    public:
+        using Job = std::function<void(int workerId)>;
+
+    private:
+        std::vector<std::thread> threads;
+        // CPU id and node of every worker, -1 and 0 when unpinned
+        std::vector<int> workerCpus;
+        std::vector<int> workerNodes;
+        int nodeCount = 1;
+        int requestedThreadCount;
+        std::mutex mutex;
+        std::condition_variable startCondition;
+        std::condition_variable doneCondition;
+        const Job* job = nullptr;
+        uint64_t generation = 0;
+        int runningCount = 0;
+        bool isStopping = false;
+
+    public:
+        // A thread count of 0 or less uses one thread per CPU this process may run on
+        explicit WorkerPool(int inThreadCount = 0, const WorkerPoolOptions& options = WorkerPoolOptions());
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        [[nodiscard]] int GetThreadCount() const;
+        // Threads asked for, more than GetThreadCount when the oversubscription guard cut them down
+        [[nodiscard]] int GetRequestedThreadCount() const;
+
+        [[nodiscard]] bool IsPinned() const;
+        [[nodiscard]] int GetNodeCount() const;
+        [[nodiscard]] int GetWorkerNode(int workerId) const;
+
+        // Run the job once on every worker and wait until all of them return
+        void Run(const Job& inJob);
+
+        // CPUs this process may run on, see CpuTopology
+        static int HardwareThreadCount();
+
+    private:
+        void WorkerLoop(int workerId);
+    };
+}
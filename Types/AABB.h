@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Common/Common.h"
+
+#include "Ray.h"
+#include "Vector3.h"
+
+#include <algorithm>
+
+namespace RTType
+{
+    // Axis-aligned bounding box
+    struct AABB
+    {
+        Point3 minimum = Point3(RT::infinity, RT::infinity, RT::infinity);
+        Point3 maximum = Point3(-RT::infinity, -RT::infinity, -RT::infinity);
+
+        AABB() = default;
+
+        AABB(const Point3& inMinimum, const Point3& inMaximum)
+            : minimum(inMinimum), maximum(inMaximum)
+        {
+        }
+
+        void Expand(const Point3& point)
+        {
+            minimum = Point3(std::min(minimum.x, point.x), std::min(minimum.y, point.y), std::min(minimum.z, point.z));
+            maximum = Point3(std::max(maximum.x, point.x), std::max(maximum.y, point.y), std::max(maximum.z, point.z));
+        }
+
+        void Expand(const AABB& other)
+        {
+            Expand(other.minimum);
+            Expand(other.maximum);
+        }
+
+        [[nodiscard]] bool IsEmpty() const
+        {
+            return minimum.x > maximum.x || minimum.y > maximum.y || minimum.z > maximum.z;
+        }
+
+        [[nodiscard]] Point3 Centroid() const
+        {
+            return 0.5 * (minimum + maximum);
+        }
+
+        [[nodiscard]] RT::Real Extent(const int axis) const
+        {
+            return Axis(maximum, axis) - Axis(minimum, axis);
+        }
+
+        [[nodiscard]] int LongestAxis() const
+        {
+            const RT::Real dx = Extent(0), dy = Extent(1), dz = Extent(2);
+            if (dx > dy && dx > dz) return 0;
+            return dy > dz ? 1 : 2;
+        }
+
+        [[nodiscard]] RT::Real SurfaceArea() const
+        {
+            if (IsEmpty()) return 0.0;
+            const Vector3 d = maximum - minimum;
+            return 2.0 * (d.x * d.y + d.y * d.z + d.z * d.x);
+        }
+
+        /*
+         * Slab test. Each pair of parallel planes clips the ray to an interval [t0, t1];
+         * the ray hits the box if the intersection of the three intervals with [tMin, tMax] is not empty.
+         * Taking the reciprocal of the direction up front turns the six divisions into multiplications,
+         * and IEEE infinities make axis-parallel rays fall out correctly.
+         * On hit, tEntry holds the distance at which the ray enters the box.
+         */
+        [[nodiscard]] bool Hit(const Point3& origin, const Vector3& inverseDirection, RT::Real tMin, RT::Real tMax, RT::Real& tEntry) const
+        {
+            const RT::Real tx0 = (minimum.x - origin.x) * inverseDirection.x;
+            const RT::Real tx1 = (maximum.x - origin.x) * inverseDirection.x;
+            tMin = std::max(tMin, std::min(tx0, tx1));
+            tMax = std::min(tMax, std::max(tx0, tx1));
+
+            const RT::Real ty0 = (minimum.y - origin.y) * inverseDirection.y;
+            const RT::Real ty1 = (maximum.y - origin.y) * inverseDirection.y;
+            tMin = std::max(tMin, std::min(ty0, ty1));
+            tMax = std::min(tMax, std::max(ty0, ty1));
+
+            const RT::Real tz0 = (minimum.z - origin.z) * inverseDirection.z;
+            const RT::Real tz1 = (maximum.z - origin.z) * inverseDirection.z;
+            tMin = std::max(tMin, std::min(tz0, tz1));
+            tMax = std::min(tMax, std::max(tz0, tz1));
+
+            tEntry = tMin;
+            return tMin <= tMax;
+        }
+
+        static RT::Real Axis(const Vector3& vector, const int axis)
+        {
+            return axis == 0 ? vector.x : (axis == 1 ? vector.y : vector.z);
+        }
+    };
+
+    inline AABB Union(AABB boxA, const AABB& boxB)
+    {
+        boxA.Expand(boxB);
+        return boxA;
+    }
+}
@@ -0,0 +1,382 @@
+#include "BVH.h"
+
+#include "Common/Common.h"
+#include "Common/ThreadCounters.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    constexpr int binCount = 32;
+    constexpr int maxTreeDepth = 64;
+
+    // Relative cost of visiting an interior node against testing one primitive
+    constexpr double traversalCost = 0.125;
+
+    // Counters are kept per thread, so traversal never touches shared memory
+    using TraversalCounters = RT::ThreadCounters<RTType::BVH::TraversalStats>;
+}
+
+namespace RTType
+{
+    BVH::BVH(const HittableList& list, const int inMaxLeafSize)
+        : maxLeafSize(std::max(1, inMaxLeafSize))
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<PrimitiveInfo> infos;
+        infos.reserve(list.objects.size());
+        for (size_t i = 0; i < list.objects.size(); ++i)
+        {
+            AABB box;
+            if (list.objects[i]->BoundingBox(box))
+            {
+                infos.push_back({box, box.Centroid(), i});
+            }
+            else
+            {
+                unboundedPrimitives.push_back(list.objects[i]);
+            }
+        }
+
+        if (!infos.empty())
+        {
+            nodes.reserve(2 * infos.size() / maxLeafSize + 1);
+            primitives.reserve(infos.size());
+            Build(infos, 0, infos.size(), list.objects, 1);
+        }
+        nodes.shrink_to_fit();
+
+        const auto end = std::chrono::steady_clock::now();
+
+        buildStats.primitiveCount = primitives.size();
+        buildStats.unboundedCount = unboundedPrimitives.size();
+        buildStats.nodeCount = nodes.size();
+        buildStats.sahCost = ComputeSAHCost();
+        buildStats.buildMilliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    uint32_t BVH::Build(std::vector<PrimitiveInfo>& infos, const size_t begin, const size_t end, const std::vector<const Hittable*>& objects, const int depth)
+    {
+        const auto nodeIndex = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+        buildStats.maxDepth = std::max(buildStats.maxDepth, depth);
+
+        AABB bounds, centroidBounds;
+        for (size_t i = begin; i < end; ++i)
+        {
+            bounds.Expand(infos[i].bounds);
+            centroidBounds.Expand(infos[i].centroid);
+        }
+        nodes[nodeIndex].bounds = bounds;
+
+        const size_t count = end - begin;
+        if (count == 1 || depth >= maxTreeDepth)
+        {
+            return MakeLeaf(infos, begin, end, objects, nodeIndex);
+        }
+
+        const int axis = centroidBounds.LongestAxis();
+        const double axisMin = AABB::Axis(centroidBounds.minimum, axis);
+        const double axisExtent = centroidBounds.Extent(axis);
+
+        size_t mid = begin;
+        if (axisExtent > 0.0)
+        {
+            /*
+             * Binned surface area heuristic. Centroids are sorted into equal-width bins along the longest axis,
+             * then every plane between two bins is scored with
+             *	cost = traversalCost + (areaLeft * countLeft + areaRight * countRight) / area,
+             * which estimates the expected number of primitive tests for a random ray that hits the node.
+             */
+            struct Bin
+            {
+                AABB bounds;
+                size_t count{};
+            };
+            Bin bins[binCount];
+
+            const double binScale = binCount / axisExtent;
+            auto binIndex = [&](const PrimitiveInfo& info)
+            {
+                const int index = static_cast<int>((AABB::Axis(info.centroid, axis) - axisMin) * binScale);
+                return std::min(index, binCount - 1);
+            };
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                Bin& bin = bins[binIndex(infos[i])];
+                bin.bounds.Expand(infos[i].bounds);
+                ++bin.count;
+            }
+
+            // Sweep from the right to get the area and count of everything right of each plane
+            double rightCost[binCount - 1];
+            AABB rightBounds;
+            size_t rightCount = 0;
+            for (int i = binCount - 1; i > 0; --i)
+            {
+                rightBounds.Expand(bins[i].bounds);
+                rightCount += bins[i].count;
+                rightCost[i - 1] = rightBounds.SurfaceArea() * static_cast<double>(rightCount);
+            }
+
+            // Sweep from the left and keep the cheapest plane
+            AABB leftBounds;
+            size_t leftCount = 0;
+            double minCost = RT::infinity;
+            int minPlane = -1;
+            for (int i = 0; i < binCount - 1; ++i)
+            {
+                leftBounds.Expand(bins[i].bounds);
+                leftCount += bins[i].count;
+                if (leftCount == 0 || leftCount == count) continue;
+
+                const double cost = leftBounds.SurfaceArea() * static_cast<double>(leftCount) + rightCost[i];
+                if (cost < minCost)
+                {
+                    minCost = cost;
+                    minPlane = i;
+                }
+            }
+
+            const double area = bounds.SurfaceArea();
+            minCost = traversalCost + (area > 0.0 ? minCost / area : 0.0);
+            const double leafCost = static_cast<double>(count);
+
+            if (minPlane < 0 || (count <= static_cast<size_t>(maxLeafSize) && leafCost <= minCost))
+            {
+                if (count <= static_cast<size_t>(maxLeafSize))
+                {
+                    return MakeLeaf(infos, begin, end, objects, nodeIndex);
+                }
+            }
+            else
+            {
+                mid = static_cast<size_t>(std::partition(infos.begin() + begin, infos.begin() + end,
+                    [&](const PrimitiveInfo& info) { return binIndex(info) <= minPlane; }) - infos.begin());
+            }
+        }
+        else if (count <= static_cast<size_t>(maxLeafSize))
+        {
+            return MakeLeaf(infos, begin, end, objects, nodeIndex);
+        }
+
+        // All centroids coincide or binning could not separate them: split in half by count
+        if (mid == begin || mid == end)
+        {
+            mid = begin + count / 2;
+            std::nth_element(infos.begin() + begin, infos.begin() + mid, infos.begin() + end,
+                [axis](const PrimitiveInfo& a, const PrimitiveInfo& b) { return AABB::Axis(a.centroid, axis) < AABB::Axis(b.centroid, axis); });
+        }
+
+        Build(infos, begin, mid, objects, depth + 1);
+        nodes[nodeIndex].offset = Build(infos, mid, end, objects, depth + 1);
+        return nodeIndex;
+    }
+
+    uint32_t BVH::MakeLeaf(const std::vector<PrimitiveInfo>& infos, const size_t begin, const size_t end, const std::vector<const Hittable*>& objects, const uint32_t nodeIndex)
+    {
+        nodes[nodeIndex].offset = static_cast<uint32_t>(primitives.size());
+        nodes[nodeIndex].count = static_cast<uint32_t>(end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            primitives.push_back(objects[infos[i].index]);
+        }
+        ++buildStats.leafCount;
+        return nodeIndex;
+    }
+
+    double BVH::ComputeSAHCost() const
+    {
+        if (nodes.empty()) return 0.0;
+
+        const double rootArea = nodes[0].bounds.SurfaceArea();
+        if (rootArea <= 0.0) return 0.0;
+
+        double cost = 0.0;
+        for (const Node& node : nodes)
+        {
+            const double relativeArea = node.bounds.SurfaceArea() / rootArea;
+            cost += relativeArea * (node.count > 0 ? static_cast<double>(node.count) : traversalCost);
+        }
+        return cost;
+    }
+
+    template <bool isAnyHit>
+    bool BVH::Traverse(const Ray& ray, const RT::Real tMin, const RT::Real tMax, HitResult& hitRecord) const
+    {
+        bool isAnythingHit = false;
+        RT::Real closestSoFar = tMax;
+
+        for (const Hittable* object : unboundedPrimitives)
+        {
+            if constexpr (isAnyHit)
+            {
+                if (object->Occluded(ray, tMin, tMax)) return true;
+            }
+            else if (object->Hit(ray, tMin, closestSoFar, hitRecord))
+            {
+                isAnythingHit = true;
+                closestSoFar = hitRecord.t;
+            }
+        }
+
+        if (nodes.empty()) return isAnythingHit;
+
+        const Point3& origin = ray.Origin();
+        const Vector3& direction = ray.Direction();
+        const Vector3 inverseDirection(1 / direction.x, 1 / direction.y, 1 / direction.z);
+
+        // Render statistics only need the primitive tests, BVH statistics want everything
+        constexpr bool isCountingTests = RT::bvhStats || RT::renderStats;
+        TraversalStats* counters = nullptr;
+        if constexpr (isCountingTests) counters = &TraversalCounters::Local();
+        if constexpr (RT::bvhStats) ++counters->rays;
+
+        RT::Real tEntry;
+        if (!nodes[0].bounds.Hit(origin, inverseDirection, tMin, closestSoFar, tEntry)) return isAnythingHit;
+
+        // Far children waiting to be visited, with the distance at which the ray enters them
+        uint32_t stackNodes[maxTreeDepth];
+        RT::Real stackEntries[maxTreeDepth];
+        int stackSize = 0;
+
+        uint32_t current = 0;
+        while (true)
+        {
+            const Node& node = nodes[current];
+            if constexpr (RT::bvhStats) ++counters->nodesVisited;
+
+            if (node.count > 0)
+            {
+                if constexpr (isCountingTests) counters->primitivesTested += node.count;
+
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                {
+                    if constexpr (isAnyHit)
+                    {
+                        if (primitives[i]->Occluded(ray, tMin, tMax)) return true;
+                    }
+                    else if (primitives[i]->Hit(ray, tMin, closestSoFar, hitRecord))
+                    {
+                        isAnythingHit = true;
+                        closestSoFar = hitRecord.t;
+                    }
+                }
+            }
+            else
+            {
+                // Visit the child the ray enters first, so the closest hit shrinks tMax as early as possible
+                uint32_t nearChild = current + 1;
+                uint32_t farChild = node.offset;
+                RT::Real tNear, tFar;
+                const bool isNearHit = nodes[nearChild].bounds.Hit(origin, inverseDirection, tMin, closestSoFar, tNear);
+                const bool isFarHit = nodes[farChild].bounds.Hit(origin, inverseDirection, tMin, closestSoFar, tFar);
+
+                if (isNearHit && isFarHit)
+                {
+                    if (tFar < tNear)
+                    {
+                        std::swap(nearChild, farChild);
+                        std::swap(tNear, tFar);
+                    }
+                    stackNodes[stackSize] = farChild;
+                    stackEntries[stackSize] = tFar;
+                    ++stackSize;
+                    current = nearChild;
+                    continue;
+                }
+                if (isNearHit || isFarHit)
+                {
+                    current = isNearHit ? nearChild : farChild;
+                    continue;
+                }
+            }
+
+            // Pop the next pending node, skipping those that start beyond the closest hit found so far
+            do
+            {
+                if (stackSize == 0) return isAnythingHit;
+                --stackSize;
+            } while (stackEntries[stackSize] > closestSoFar);
+            current = stackNodes[stackSize];
+        }
+    }
+
+    bool BVH::Hit(const Ray& ray, const RT::Real tMin, const RT::Real tMax, HitResult& hitRecord) const
+    {
+        return Traverse<false>(ray, tMin, tMax, hitRecord);
+    }
+
+    bool BVH::Occluded(const Ray& ray, const RT::Real tMin, const RT::Real tMax) const
+    {
+        HitResult unused;
+        return Traverse<true>(ray, tMin, tMax, unused);
+    }
+
+    bool BVH::BoundingBox(AABB& outBox) const
+    {
+        if (!unboundedPrimitives.empty() || nodes.empty()) return false;
+        outBox = nodes[0].bounds;
+        return true;
+    }
+
+    std::vector<HittableList> BVH::GetLeafGroups() const
+    {
+        std::vector<HittableList> groups;
+        groups.reserve(buildStats.leafCount);
+        for (const Node& node : nodes)
+        {
+            if (node.count == 0) continue;
+
+            HittableList& group = groups.emplace_back();
+            group.objects.assign(primitives.begin() + node.offset, primitives.begin() + node.offset + node.count);
+        }
+        return groups;
+    }
+
+    const BVH::BuildStats& BVH::GetBuildStats() const
+    {
+        return buildStats;
+    }
+
+    size_t BVH::MemorySize() const
+    {
+        return sizeof(BVH) + nodes.capacity() * sizeof(Node) + (primitives.capacity() + unboundedPrimitives.capacity()) * sizeof(const Hittable*);
+    }
+
+    BVH::TraversalStats BVH::GetTraversalStats()
+    {
+        return TraversalCounters::Total();
+    }
+
+    void BVH::ResetTraversalStats()
+    {
+        TraversalCounters::Reset();
+    }
+
+    void BVH::PrintStats(std::ostream& out) const
+    {
+        out << "BVH: " << buildStats.primitiveCount << " primitives";
+        if (buildStats.unboundedCount > 0)
+        {
+            out << " (+" << buildStats.unboundedCount << " unbounded)";
+        }
+        out << ", " << buildStats.nodeCount << " nodes, " << buildStats.leafCount << " leaves, depth " << buildStats.maxDepth
+            << ", SAH cost " << buildStats.sahCost << ", built in " << buildStats.buildMilliseconds << " ms\n";
+
+        if constexpr (RT::bvhStats)
+        {
+            const TraversalStats stats = GetTraversalStats();
+            if (stats.rays > 0)
+            {
+                const auto rays = static_cast<double>(stats.rays);
+                out << "BVH traversal: " << stats.rays << " rays, "
+                    << static_cast<double>(stats.nodesVisited) / rays << " nodes/ray, "
+                    << static_cast<double>(stats.primitivesTested) / rays << " primitives/ray\n";
+            }
+        }
+    }
+}
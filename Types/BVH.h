@@ -0,0 +1,94 @@
+#pragma once
+
+#include "AABB.h"
+#include "HitResult.h"
+#include "HittableList.h"
+#include "Ray.h"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace RTType
+{
+    // Bounding volume hierarchy built over the objects of a HittableList with a binned SAH builder
+    class BVH : public Hittable
+    {
+    public:
+        struct BuildStats
+        {
+            size_t primitiveCount{};
+            size_t unboundedCount{};
+            size_t nodeCount{};
+            size_t leafCount{};
+            int maxDepth{};
+            double sahCost{};
+            double buildMilliseconds{};
+        };
+
+        // Collected only when RT::bvhStats is enabled, except primitivesTested, which RT::renderStats needs as well
+        struct TraversalStats
+        {
+            uint64_t rays{};
+            uint64_t nodesVisited{};
+            uint64_t primitivesTested{};
+
+            TraversalStats& operator+=(const TraversalStats& other)
+            {
+                rays += other.rays;
+                nodesVisited += other.nodesVisited;
+                primitivesTested += other.primitivesTested;
+                return *this;
+            }
+        };
+
+    private:
+        // Nodes are stored depth-first: the left child of an interior node directly follows it,
+        // the right child is at offset. Leaves (count > 0) hold primitives [offset, offset + count).
+        struct Node
+        {
+            AABB bounds;
+            uint32_t offset{};
+            uint32_t count{};
+        };
+
+        struct PrimitiveInfo
+        {
+            AABB bounds;
+            Point3 centroid;
+            size_t index{};
+        };
+
+        std::vector<Node> nodes;
+        std::vector<const Hittable*> primitives;
+        std::vector<const Hittable*> unboundedPrimitives;
+        BuildStats buildStats;
+        int maxLeafSize;
+
+    public:
+        explicit BVH(const HittableList& list, int inMaxLeafSize = 4);
+
+        bool Hit(const Ray& ray, RT::Real tMin, RT::Real tMax, HitResult& hitRecord) const override;
+        bool BoundingBox(AABB& outBox) const override;
+        bool Occluded(const Ray& ray, RT::Real tMin, RT::Real tMax) const override;
+
+        // Primitives of every leaf in tree order, spatially close primitives end up in the same list
+        [[nodiscard]] std::vector<HittableList> GetLeafGroups() const;
+
+        [[nodiscard]] const BuildStats& GetBuildStats() const;
+        // Bytes of the tree and of its primitive pointers, not of the primitives
+        [[nodiscard]] size_t MemorySize() const;
+        static TraversalStats GetTraversalStats();
+        static void ResetTraversalStats();
+
+        void PrintStats(std::ostream& out) const;
+
+    private:
+        uint32_t Build(std::vector<PrimitiveInfo>& infos, size_t begin, size_t end, const std::vector<const Hittable*>& objects, int depth);
+        uint32_t MakeLeaf(const std::vector<PrimitiveInfo>& infos, size_t begin, size_t end, const std::vector<const Hittable*>& objects, uint32_t nodeIndex);
+        [[nodiscard]] double ComputeSAHCost() const;
+        // Closest hit into hitRecord, or with isAnyHit the first hit found, which ends the traversal and writes nothing
+        template <bool isAnyHit>
+        bool Traverse(const Ray& ray, RT::Real tMin, RT::Real tMax, HitResult& hitRecord) const;
+    };
+}
@@ -11,8 +11,9 @@ namespace RTType
     {
         Point3 point;
         Vector3 normal;
-        std::shared_ptr<Material> material;
-        double t{};
+        // Owned by the scene
+        const Material* material = nullptr;
+        RT::Real t{};
         bool frontFace{};
 
         void SetFaceNormal(const Ray& ray, const Vector3& outNormal)
@@ -1,9 +1,9 @@
 #pragma once
 
+#include "AABB.h"
 #include "HitResult.h"
 #include "Ray.h"
 
-#include <memory>
 #include <vector>
 
 namespace RTType
@@ -12,16 +12,30 @@ namespace RTType
     {
     public:
         virtual ~Hittable() = default;
-        virtual bool Hit(const Ray& ray, double tMin, double tMax, HitResult& hitRecord) const = 0;
+
+        // Writes hitRecord only when something is hit
+        virtual bool Hit(const Ray& ray, RT::Real tMin, RT::Real tMax, HitResult& hitRecord) const = 0;
+        virtual bool BoundingBox(AABB& outBox) const = 0;
+
+        /*
+         * Whether anything is hit in [tMin, tMax], for visibility only. Overrides return at the first hit they find,
+         * not the closest one, and build no hit result; this fallback finds the closest hit.
+         */
+        virtual bool Occluded(const Ray& ray, const RT::Real tMin, const RT::Real tMax) const
+        {
+            HitResult hitRecord;
+            return Hit(ray, tMin, tMax, hitRecord);
+        }
     };
 
+    // Non-owning list, the objects belong to the scene
     struct HittableList : Hittable
     {
-        std::vector<std::shared_ptr<Hittable>> objects;
+        std::vector<const Hittable*> objects;
 
         HittableList() = default;
 
-        HittableList(const std::shared_ptr<Hittable>& hittable)
+        HittableList(const Hittable* hittable)
         {
             Add(hittable);
         }
@@ -31,27 +45,50 @@ namespace RTType
             objects.clear();
         }
 
-        void Add(const std::shared_ptr<Hittable>& hittable)
+        void Add(const Hittable* hittable)
         {
             objects.push_back(hittable);
         }
 
-        bool Hit(const Ray& ray, const double tMin, const double tMax, HitResult& hitRecord) const
+        bool Hit(const Ray& ray, const RT::Real tMin, const RT::Real tMax, HitResult& hitRecord) const override
         {
-            HitResult currentRecord;
             bool isAnythingHit = false;
-            double closestSoFar = tMax;
+            RT::Real closestSoFar = tMax;
 
-            for (const auto& object : objects)
+            // Each hit is closer than the previous one, so it can go straight into the result
+            for (const Hittable* object : objects)
             {
-                if (object->Hit(ray, tMin, closestSoFar, currentRecord))
+                if (object->Hit(ray, tMin, closestSoFar, hitRecord))
                 {
                     isAnythingHit = true;
-                    closestSoFar = currentRecord.t;
-                    hitRecord = currentRecord;
+                    closestSoFar = hitRecord.t;
                 }
             }
             return isAnythingHit;
         }
+
+        bool Occluded(const Ray& ray, const RT::Real tMin, const RT::Real tMax) const override
+        {
+            for (const Hittable* object : objects)
+            {
+                if (object->Occluded(ray, tMin, tMax)) return true;
+            }
+            return false;
+        }
+
+        bool BoundingBox(AABB& outBox) const override
+        {
+            outBox = AABB();
+            for (const Hittable* object : objects)
+            {
+                AABB objectBox;
+                if (!object->BoundingBox(objectBox))
+                {
+                    return false;
+                }
+                outBox.Expand(objectBox);
+            }
+            return !objects.empty();
+        }
     };
 }
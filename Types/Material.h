@@ -8,26 +8,50 @@
 
 namespace RTType
 {
+    // Concrete type of a material, lets batched shading call Scatter without a virtual call
+    enum class MaterialType
+    {
+        Lambertian,
+        Metal,
+        Dielectric
+    };
+
+    constexpr int materialTypeCount = 3;
+
     class Material
     {
+    private:
+        MaterialType type;
+
     public:
+        explicit Material(MaterialType inType)
+            : type(inType)
+        {
+        }
+
+        virtual ~Material() = default;
         virtual bool Scatter(const Ray& inRay, const HitResult& hitResult, Color& attenuation, Ray& scattered) const = 0;
+
+        [[nodiscard]] MaterialType GetType() const
+        {
+            return type;
+        }
     };
 
-    class Lambertian : public Material
+    class Lambertian final : public Material
     {
     public:
         Color albedo;
 
     public:
         Lambertian(const Color& inAlbedo)
-            : albedo(inAlbedo)
+            : Material(MaterialType::Lambertian), albedo(inAlbedo)
         {
         }
 
-        bool Scatter(const Ray& inRay, const HitResult& hitResult, Color& attenuation, Ray& scattered) const override
+        bool Scatter([[maybe_unused]] const Ray& inRay, const HitResult& hitResult, Color& attenuation, Ray& scattered) const override
         {
-            Vector3 scatterDirection = hitResult.normal + RandomUnitVector();
+            Vector3 scatterDirection = hitResult.normal + SampleUnitVector();
             if (scatterDirection.NearZero())
             {
                 scatterDirection = hitResult.normal;
@@ -38,49 +62,49 @@ namespace RTType
         }
     };
 
-    class Metal : public Material
+    class Metal final : public Material
     {
     public:
         Color albedo;
-        double fuzziness;
+        RT::Real fuzziness;
 
     public:
-        Metal(const Color& inAlbedo, double inFuzziness)
-            : albedo(inAlbedo), fuzziness(inFuzziness < 1 ? inFuzziness : 1)
+        Metal(const Color& inAlbedo, RT::Real inFuzziness)
+            : Material(MaterialType::Metal), albedo(inAlbedo), fuzziness(inFuzziness < 1 ? inFuzziness : 1)
         {
         }
 
         bool Scatter(const Ray& inRay, const HitResult& hitResult, Color& attenuation, Ray& scattered) const override
         {
             const Vector3 reflected = Reflect(UnitVector(inRay.Direction()), hitResult.normal);
-            scattered = Ray(hitResult.point, reflected + fuzziness * RandomInUnitSphere());
+            scattered = Ray(hitResult.point, reflected + fuzziness * SampleInUnitSphere());
             attenuation = albedo;
             return Dot(scattered.Direction(), hitResult.normal) > 0;
         }
     };
 
-    class Dielectric : public Material
+    class Dielectric final : public Material
     {
     public:
-        double refraction;
+        RT::Real refraction;
 
     public:
-        Dielectric(double inRefraction)
-            : refraction(inRefraction)
+        Dielectric(RT::Real inRefraction)
+            : Material(MaterialType::Dielectric), refraction(inRefraction)
         {
         }
 
         bool Scatter(const Ray& inRay, const HitResult& hitResult, Color& attenuation, Ray& scattered) const override
         {
-            const double refractionRatio = hitResult.frontFace ? (1.0 / refraction) : refraction;
+            const RT::Real refractionRatio = hitResult.frontFace ? (1 / refraction) : refraction;
             const Vector3 unitDirection = UnitVector(inRay.Direction());
-            const double cosineTheta = fmin(Dot(-unitDirection, hitResult.normal), 1.0);
-            const double sineTheta = sqrt(1.0 - cosineTheta * cosineTheta);
+            const RT::Real cosineTheta = std::fmin(Dot(-unitDirection, hitResult.normal), RT::Real(1));
+            const RT::Real sineTheta = std::sqrt(1 - cosineTheta * cosineTheta);
 
             const bool canRetract = refractionRatio * sineTheta <= 1.0;
             Vector3 direction;
 
-            if (!canRetract || Reflectance(cosineTheta, refractionRatio) > RT::RandomDouble())
+            if (!canRetract || Reflectance(cosineTheta, refractionRatio) > RT::SampleDouble())
             {
                 direction = Reflect(unitDirection, hitResult.normal);
             }
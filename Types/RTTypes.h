@@ -1,12 +1,17 @@
 ﻿#pragma once
 
+#include "AABB.h"
+#include "BVH.h"
 #include "HitResult.h"
 #include "HittableList.h"
 #include "Material.h"
 #include "Ray.h"
+#include "Transform.h"
 #include "Vector3.h"
 
 // Type aliases for Vector3
+using RTTAABB = RTType::AABB;
+using RTTBVH = RTType::BVH;
 using RTTColor = RTType::Color;
 using RTTHitResult = RTType::HitResult;
 using RTTHittable = RTType::Hittable;
@@ -14,4 +19,5 @@ using RTTHittableList = RTType::HittableList;
 using RTTMaterial = RTType::Material;
 using RTTPoint3 = RTType::Point3;
 using RTTRay = RTType::Ray;
+using RTTTransform = RTType::Transform;
 using RTTVector3 = RTType::Vector3;
\ No newline at end of file
@@ -5,18 +5,40 @@
 
 namespace RTType
 {
-    struct Ray
+    // Ray over the same scalar as its vectors, see TVector3
+    template <typename T>
+    struct TRay
     {
     public:
-        Point3 origin;
-        Vector3 direction;
+        using Scalar = T;
+
+        TVector3<T> origin;
+        TVector3<T> direction;
 
     public:
-        Ray();
-        explicit Ray(const Point3& inOrigin, const Vector3& inDirection);
+        constexpr TRay() = default;
+
+        constexpr explicit TRay(const TVector3<T>& inOrigin, const TVector3<T>& inDirection)
+            : origin(inOrigin), direction(inDirection)
+        {
+        }
+
+        [[nodiscard]] constexpr const TVector3<T>& Origin() const
+        {
+            return origin;
+        }
 
-        [[nodiscard]] Point3 Origin() const;
-        [[nodiscard]] Vector3 Direction() const;
-        [[nodiscard]] Point3 At(double length) const;
+        [[nodiscard]] constexpr const TVector3<T>& Direction() const
+        {
+            return direction;
+        }
+
+        [[nodiscard]] constexpr TVector3<T> At(const T length) const
+        {
+            return origin + direction * length;
+        }
     };
+
+    // Ray of the precision the renderer is built with
+    using Ray = TRay<RT::Real>;
 }
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "AABB.h"
+#include "Ray.h"
+#include "Vector3.h"
+
+#include <cmath>
+
+namespace RTType
+{
+    /*
+     * Affine transform: a 3x3 matrix, stored as its rows, followed by a translation. Points take the translation,
+     * direction vectors do not. Normals go through the transposed inverse, so for a transform that maps world space to
+     * object space, ApplyTransposed of its matrix takes object normals back to world space.
+     */
+    struct Transform
+    {
+        Vector3 rows[3] = {Vector3(1.0, 0.0, 0.0), Vector3(0.0, 1.0, 0.0), Vector3(0.0, 0.0, 1.0)};
+        Vector3 translation;
+
+        Transform() = default;
+
+        static Transform Translation(const Vector3& offset)
+        {
+            Transform transform;
+            transform.translation = offset;
+            return transform;
+        }
+
+        static Transform Scaling(const RT::Real scale)
+        {
+            Transform transform;
+            for (int row = 0; row < 3; ++row)
+            {
+                transform.rows[row] *= scale;
+            }
+            return transform;
+        }
+
+        // Counterclockwise around the y axis, seen from above
+        static Transform RotationY(const RT::Real radians)
+        {
+            const RT::Real cosine = std::cos(radians);
+            const RT::Real sine = std::sin(radians);
+            Transform transform;
+            transform.rows[0] = Vector3(cosine, 0.0, sine);
+            transform.rows[2] = Vector3(-sine, 0.0, cosine);
+            return transform;
+        }
+
+        [[nodiscard]] Point3 ApplyToPoint(const Point3& point) const
+        {
+            return ApplyToVector(point) + translation;
+        }
+
+        [[nodiscard]] Vector3 ApplyToVector(const Vector3& vector) const
+        {
+            return Vector3(Dot(rows[0], vector), Dot(rows[1], vector), Dot(rows[2], vector));
+        }
+
+        // Transposed matrix times the vector, without the translation
+        [[nodiscard]] Vector3 ApplyTransposed(const Vector3& vector) const
+        {
+            return vector.x * rows[0] + vector.y * rows[1] + vector.z * rows[2];
+        }
+
+        [[nodiscard]] Ray ApplyToRay(const Ray& ray) const
+        {
+            return Ray(ApplyToPoint(ray.Origin()), ApplyToVector(ray.Direction()));
+        }
+
+        // Box around the eight transformed corners of box
+        [[nodiscard]] AABB ApplyToBox(const AABB& box) const
+        {
+            AABB result;
+            for (int corner = 0; corner < 8; ++corner)
+            {
+                result.Expand(ApplyToPoint(Point3(
+                    corner & 1 ? box.maximum.x : box.minimum.x, corner & 2 ? box.maximum.y : box.minimum.y, corner & 4 ? box.maximum.z : box.minimum.z)));
+            }
+            return result;
+        }
+
+        // The rows of the inverse matrix are the columns of the cross products of the rows, over the determinant
+        [[nodiscard]] Transform Inverse() const
+        {
+            const Vector3 column0 = Cross(rows[1], rows[2]);
+            const Vector3 column1 = Cross(rows[2], rows[0]);
+            const Vector3 column2 = Cross(rows[0], rows[1]);
+            const RT::Real inverseDeterminant = RT::Real(1) / Dot(rows[0], column0);
+
+            Transform inverse;
+            inverse.rows[0] = inverseDeterminant * Vector3(column0.x, column1.x, column2.x);
+            inverse.rows[1] = inverseDeterminant * Vector3(column0.y, column1.y, column2.y);
+            inverse.rows[2] = inverseDeterminant * Vector3(column0.z, column1.z, column2.z);
+            inverse.translation = -inverse.ApplyToVector(translation);
+            return inverse;
+        }
+    };
+
+    // Transform that applies b first, then a
+    inline Transform operator*(const Transform& a, const Transform& b)
+    {
+        // Row i of the product sums the rows of b weighted by row i of a
+        Transform result;
+        for (int row = 0; row < 3; ++row)
+        {
+            result.rows[row] = b.ApplyTransposed(a.rows[row]);
+        }
+        result.translation = a.ApplyToPoint(b.translation);
+        return result;
+    }
+}
@@ -1,64 +1,339 @@
 #pragma once
 
+#include "Common/Common.h"
+
 #include <iostream>
 #include <vector>
 
+#if RT_SIMD_VECTOR3 && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RT_SIMD_VECTOR3_FLOAT 1
+#include <immintrin.h>
+#endif
+#if RT_SIMD_VECTOR3 && defined(__AVX2__)
+#define RT_SIMD_VECTOR3_DOUBLE 1
+#endif
+
 namespace RTType
 {
-    struct Vector3
+    template <typename T>
+    struct TVector3;
+
+    namespace Detail
+    {
+        /*
+         * Whole-vector operations on one register, for the padded layout of RT_SIMD_VECTOR3.
+         * Specialized for float with SSE and for double with AVX2; anything else computes the lanes one by one.
+         */
+        template <typename T>
+        struct VectorRegister
+        {
+            static constexpr bool isAvailable = false;
+        };
+
+#if RT_SIMD_VECTOR3_FLOAT
+        template <>
+        struct VectorRegister<float>
+        {
+            static constexpr bool isAvailable = true;
+            using Register = __m128;
+
+            static Register Load(const TVector3<float>& vector);
+            static TVector3<float> Store(Register value);
+            static Register Set(const float value) { return _mm_set1_ps(value); }
+            static Register Add(const Register a, const Register b) { return _mm_add_ps(a, b); }
+            static Register Sub(const Register a, const Register b) { return _mm_sub_ps(a, b); }
+            static Register Mul(const Register a, const Register b) { return _mm_mul_ps(a, b); }
+
+            // Lanes summed as (x + y) + z, the order of the scalar code, so both layouts round the same
+            static float Dot(const Register a, const Register b)
+            {
+                const Register product = _mm_mul_ps(a, b);
+                const Register sum = _mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1)));
+                return _mm_cvtss_f32(_mm_add_ss(sum, _mm_movehl_ps(product, product)));
+            }
+
+            static Register Cross(const Register a, const Register b)
+            {
+                const Register aYzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+                const Register bYzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+                const Register aZxy = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+                const Register bZxy = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+                return _mm_sub_ps(_mm_mul_ps(aYzx, bZxy), _mm_mul_ps(aZxy, bYzx));
+            }
+        };
+#endif
+
+#if RT_SIMD_VECTOR3_DOUBLE
+        template <>
+        struct VectorRegister<double>
+        {
+            static constexpr bool isAvailable = true;
+            using Register = __m256d;
+
+            static Register Load(const TVector3<double>& vector);
+            static TVector3<double> Store(Register value);
+            static Register Set(const double value) { return _mm256_set1_pd(value); }
+            static Register Add(const Register a, const Register b) { return _mm256_add_pd(a, b); }
+            static Register Sub(const Register a, const Register b) { return _mm256_sub_pd(a, b); }
+            static Register Mul(const Register a, const Register b) { return _mm256_mul_pd(a, b); }
+
+            static double Dot(const Register a, const Register b)
+            {
+                const Register product = _mm256_mul_pd(a, b);
+                const __m128d xy = _mm256_castpd256_pd128(product);
+                const __m128d sum = _mm_add_sd(xy, _mm_unpackhi_pd(xy, xy));
+                return _mm_cvtsd_f64(_mm_add_sd(sum, _mm256_extractf128_pd(product, 1)));
+            }
+
+            static Register Cross(const Register a, const Register b)
+            {
+                const Register aYzx = _mm256_permute4x64_pd(a, _MM_SHUFFLE(3, 0, 2, 1));
+                const Register bYzx = _mm256_permute4x64_pd(b, _MM_SHUFFLE(3, 0, 2, 1));
+                const Register aZxy = _mm256_permute4x64_pd(a, _MM_SHUFFLE(3, 1, 0, 2));
+                const Register bZxy = _mm256_permute4x64_pd(b, _MM_SHUFFLE(3, 1, 0, 2));
+                return _mm256_sub_pd(_mm256_mul_pd(aYzx, bZxy), _mm256_mul_pd(aZxy, bYzx));
+            }
+        };
+#endif
+    }
+
+    /*
+     * Three component vector over a floating point scalar, defined in the header so every operation inlines.
+     * The renderer uses TVector3<RT::Real> (see Config.h); float and double are both usable, so tools can compare them.
+     * Built with RT_SIMD_VECTOR3, vectors take four lanes, aligned to a full register with the fourth lane kept at 0,
+     * and the arithmetic operators work on whole registers. Operations are constexpr in the default three lane layout.
+     */
+    template <typename T>
+    struct alignas(RT_SIMD_VECTOR3 ? 4 * sizeof(T) : alignof(T)) TVector3
     {
     public:
-        double x, y, z;
+        using Scalar = T;
+
+        T x{}, y{}, z{};
+#if RT_SIMD_VECTOR3
+        // Padding lane, always 0
+        T w{};
+#endif
 
     public:
-        Vector3();
-        explicit Vector3(double inX, double inY, double inZ);
+        constexpr TVector3() = default;
 
-        Vector3 operator-() const;
-        Vector3& operator+=(const Vector3& other);
-        Vector3& operator*=(double multiplier);
-        Vector3& operator*=(const Vector3& other);
-        Vector3& operator/=(double divisor);
+        constexpr explicit TVector3(const T inX, const T inY, const T inZ)
+            : x(inX), y(inY), z(inZ)
+        {
+        }
 
-        [[nodiscard]] double Length() const;
-        [[nodiscard]] double LengthSquared() const;
+        constexpr TVector3 operator-() const
+        {
+            return TVector3(-x, -y, -z);
+        }
 
-        [[nodiscard]] bool NearZero() const;
+        constexpr TVector3& operator+=(const TVector3& other);
+        constexpr TVector3& operator*=(T multiplier);
+        constexpr TVector3& operator*=(const TVector3& other);
 
-        static Vector3 Random();
-        static Vector3 Random(double min, double max);
+        constexpr TVector3& operator/=(const T divisor)
+        {
+            return *this *= 1 / divisor;
+        }
+
+        [[nodiscard]] T Length() const
+        {
+            return std::sqrt(LengthSquared());
+        }
+
+        [[nodiscard]] constexpr T LengthSquared() const;
+
+        [[nodiscard]] bool NearZero() const
+        {
+            return (std::fabs(x) < RT::nearZero && std::fabs(y) < RT::nearZero && std::fabs(z) < RT::nearZero);
+        }
+
+        static TVector3 Random()
+        {
+            return TVector3(static_cast<T>(RT::RandomDouble()), static_cast<T>(RT::RandomDouble()), static_cast<T>(RT::RandomDouble()));
+        }
+
+        static TVector3 Random(const T min, const T max)
+        {
+            return TVector3(static_cast<T>(RT::RandomDouble(min, max)), static_cast<T>(RT::RandomDouble(min, max)), static_cast<T>(RT::RandomDouble(min, max)));
+        }
     };
 
+#if RT_SIMD_VECTOR3_FLOAT
+    namespace Detail
+    {
+        inline VectorRegister<float>::Register VectorRegister<float>::Load(const TVector3<float>& vector)
+        {
+            return _mm_load_ps(&vector.x);
+        }
+
+        inline TVector3<float> VectorRegister<float>::Store(const Register value)
+        {
+            TVector3<float> vector;
+            _mm_store_ps(&vector.x, value);
+            return vector;
+        }
+    }
+#endif
+
+#if RT_SIMD_VECTOR3_DOUBLE
+    namespace Detail
+    {
+        inline VectorRegister<double>::Register VectorRegister<double>::Load(const TVector3<double>& vector)
+        {
+            return _mm256_load_pd(&vector.x);
+        }
+
+        inline TVector3<double> VectorRegister<double>::Store(const Register value)
+        {
+            TVector3<double> vector;
+            _mm256_store_pd(&vector.x, value);
+            return vector;
+        }
+    }
+#endif
+
+    // Vector of the precision the renderer is built with
+    using Vector3 = TVector3<RT::Real>;
+
     // Type aliases for Vector3
     using Point3 = Vector3;   // 3D point
     using Color = Vector3;    // RGB color
 
     // Colors
-    const Color colorWhite(1.0, 1.0, 1.0);
-    const Color colorSkyBlue(0.5, 0.7, 1.0);
-    const Color colorBlack(0.0, 0.0, 0.0);
+    constexpr Color colorWhite(1.0, 1.0, 1.0);
+    constexpr Color colorSkyBlue(0.5, 0.7, 1.0);
+    constexpr Color colorBlack(0.0, 0.0, 0.0);
+
+    // Vector3 utility functions, scalars take the precision of the vector
+    template <typename T>
+    std::ostream& operator<<(std::ostream& out, const TVector3<T>& vector)
+    {
+        return out << vector.x << ' ' << vector.y << ' ' << vector.z;
+    }
+
+    template <typename T>
+    constexpr TVector3<T> operator+(const TVector3<T>& vectorA, const TVector3<T>& vectorB)
+    {
+        using Lanes = Detail::VectorRegister<T>;
+        if constexpr (Lanes::isAvailable) return Lanes::Store(Lanes::Add(Lanes::Load(vectorA), Lanes::Load(vectorB)));
+        else return TVector3<T>(vectorA.x + vectorB.x, vectorA.y + vectorB.y, vectorA.z + vectorB.z);
+    }
+
+    template <typename T>
+    constexpr TVector3<T> operator-(const TVector3<T>& vectorA, const TVector3<T>& vectorB)
+    {
+        using Lanes = Detail::VectorRegister<T>;
+        if constexpr (Lanes::isAvailable) return Lanes::Store(Lanes::Sub(Lanes::Load(vectorA), Lanes::Load(vectorB)));
+        else return TVector3<T>(vectorA.x - vectorB.x, vectorA.y - vectorB.y, vectorA.z - vectorB.z);
+    }
+
+    template <typename T>
+    constexpr TVector3<T> operator*(const TVector3<T>& vector, const typename TVector3<T>::Scalar multiplier)
+    {
+        using Lanes = Detail::VectorRegister<T>;
+        if constexpr (Lanes::isAvailable) return Lanes::Store(Lanes::Mul(Lanes::Load(vector), Lanes::Set(multiplier)));
+        else return TVector3<T>(vector.x * multiplier, vector.y * multiplier, vector.z * multiplier);
+    }
 
-    // Vector3 utility functions
-    std::ostream& operator<<(std::ostream& out, const Vector3& vector);
+    template <typename T>
+    constexpr TVector3<T> operator*(const typename TVector3<T>::Scalar multiplier, const TVector3<T>& vector)
+    {
+        return vector * multiplier;
+    }
+
+    template <typename T>
+    constexpr TVector3<T> operator*(const TVector3<T>& vectorA, const TVector3<T>& vectorB)
+    {
+        using Lanes = Detail::VectorRegister<T>;
+        if constexpr (Lanes::isAvailable) return Lanes::Store(Lanes::Mul(Lanes::Load(vectorA), Lanes::Load(vectorB)));
+        else return TVector3<T>(vectorA.x * vectorB.x, vectorA.y * vectorB.y, vectorA.z * vectorB.z);
+    }
 
-    Vector3 operator+(const Vector3& vectorA, const Vector3& vectorB);
-    Vector3 operator-(const Vector3& vectorA, const Vector3& vectorB);
-    Vector3 operator*(const Vector3& vector, const double multiplier);
-    Vector3 operator*(const double multiplier, const Vector3& vector);
-    Vector3 operator*(const Vector3& vectorA, const Vector3& vectorB);
-    Vector3 operator/(const Vector3& vector, const double divisor);
+    template <typename T>
+    constexpr TVector3<T> operator/(const TVector3<T>& vector, const typename TVector3<T>::Scalar divisor)
+    {
+        return vector * (1 / divisor);
+    }
 
-    double Dot(const Vector3& vectorA, const Vector3& vectorB);
-    Vector3 Cross(const Vector3& vectorA, const Vector3& vectorB);
-    Vector3 UnitVector(const Vector3& vector);
+    template <typename T>
+    constexpr TVector3<T>& TVector3<T>::operator+=(const TVector3& other)
+    {
+        return *this = *this + other;
+    }
+
+    template <typename T>
+    constexpr TVector3<T>& TVector3<T>::operator*=(const T multiplier)
+    {
+        return *this = *this * multiplier;
+    }
 
-    Vector3 RandomInUnitSphere();
-    Vector3 RandomUnitVector();
-    Vector3 RandomUnitDisk();
-    Vector3 RandomInHemisphere(const Vector3& normal);
+    template <typename T>
+    constexpr TVector3<T>& TVector3<T>::operator*=(const TVector3& other)
+    {
+        return *this = *this * other;
+    }
+
+    template <typename T>
+    constexpr T Dot(const TVector3<T>& vectorA, const TVector3<T>& vectorB)
+    {
+        using Lanes = Detail::VectorRegister<T>;
+        if constexpr (Lanes::isAvailable) return Lanes::Dot(Lanes::Load(vectorA), Lanes::Load(vectorB));
+        else return vectorA.x * vectorB.x
+        + vectorA.y * vectorB.y
+        + vectorA.z * vectorB.z;
+    }
+
+    template <typename T>
+    constexpr T TVector3<T>::LengthSquared() const
+    {
+        return Dot(*this, *this);
+    }
+
+    template <typename T>
+    constexpr TVector3<T> Cross(const TVector3<T>& vectorA, const TVector3<T>& vectorB)
+    {
+        using Lanes = Detail::VectorRegister<T>;
+        if constexpr (Lanes::isAvailable) return Lanes::Store(Lanes::Cross(Lanes::Load(vectorA), Lanes::Load(vectorB)));
+        else return TVector3<T>(
+            vectorA.y * vectorB.z - vectorA.z * vectorB.y,
+            vectorA.z * vectorB.x - vectorA.x * vectorB.z,
+            vectorA.x * vectorB.y - vectorA.y * vectorB.x
+        );
+    }
+
+    template <typename T>
+    TVector3<T> UnitVector(const TVector3<T>& vector)
+    {
+        return vector / vector.Length();
+    }
+
+    template <typename T>
+    constexpr TVector3<T> Reflect(const TVector3<T>& vector, const TVector3<T>& normal)
+    {
+        return vector - 2 * Dot(vector, normal) * normal;
+    }
+
+    template <typename T>
+    TVector3<T> Refract(const TVector3<T>& vector, const TVector3<T>& normal, const typename TVector3<T>::Scalar etaiOverEtat)
+    {
+        const T cosineTheta = std::fmin(Dot(-vector, normal), T(1));
+        const TVector3<T> rOutPerpeindicular = etaiOverEtat * (vector + cosineTheta * normal);
+        const TVector3<T> rOutParallel = -std::sqrt(std::fabs(1 - rOutPerpeindicular.LengthSquared())) * normal;
+        return rOutPerpeindicular + rOutParallel;
+    }
 
-    Vector3 Reflect(const Vector3& vector, const Vector3& normal);
-    Vector3 Refract(const Vector3& vector, const Vector3& normal, double etaiOverEtat);
+    /*
+     * Warps of the numbers of the thread's sampler (see Sampler.h) that render paths draw from. Each one maps a fixed
+     * number of dimensions without rejection, so the structure of low-discrepancy points carries over to the result.
+     */
+    // Uniform on the unit sphere, two dimensions
+    Vector3 SampleUnitVector();
+    // Uniform in the unit ball, three dimensions
+    Vector3 SampleInUnitSphere();
+    // Uniform in the unit disk of the xy plane by the concentric mapping (Shirley and Chiu), two dimensions
+    Vector3 SampleUnitDisk();
 
-    void WriteColor(std::vector<int>& image, const int pixelIndex, const Color pixelColor, const int inSamplesPerPixel);
+    void WriteColor(float* pixel, const Color pixelColor, const int inSamplesPerPixel);
 }
@@ -1,134 +1,266 @@
 #include "Common/Common.h"
+#include "Common/CpuTopology.h"
+#include "Common/Settings.h"
 #include "Types/RTTypes.h"
 #include "Objects/RTObjects.h"
+#include "Render/RTRender.h"
 
+#include <chrono>
+#include <memory>
+#include <string>
 #include <vector>
-#include <thread>
 
-RTTColor RayColor(const RTTRay& ray, const RTTHittable& world, int depth) {
-	// If we've exceeded the ray bounce limit, no more light is gathered
-	if (depth <= 0) {
-		return RTType::colorBlack;
+int main(int argc, char* argv[]) {
+	// Settings
+	RT::Settings settings;
+	const RT::CommandLineResult commandLine = RT::ParseCommandLine(argc, argv, settings, std::cerr);
+	if (commandLine == RT::CommandLineResult::Help) {
+		RT::PrintUsage(argv[0], std::cout);
+		return 0;
+	}
+	if (commandLine == RT::CommandLineResult::Error) {
+		RT::PrintUsage(argv[0], std::cerr);
+		return 1;
+	}
+	// Wavefront batches shade whole paths, ambient occlusion is taken per camera sample
+	if (settings.ambientOcclusionRays > 0 && settings.wavefront) {
+		std::cerr << "--ao renders depth-first, without --wavefront.\n";
+		return 1;
 	}
 
-	RTTHitResult hitRecord;
-	if (world.Hit(ray, 0.001, RT::infinity, hitRecord)) {
-		RTTRay scattered;
-		RTTColor attenuation;
-		if (hitRecord.material->Scatter(ray, hitRecord, attenuation, scattered)) {
-			return attenuation * RayColor(scattered, world, --depth);
-		}
-		return RTType::colorBlack;
+	// Options that only work together in one process are checked before the frame may be handed out to workers
+	const bool isDistributed = !settings.coordinatorAddress.empty() || settings.IsCoordinator();
+	const bool isAdaptiveRequested = settings.adaptiveSampling && !settings.wavefront;
+	// The denoiser filters the whole image with the guides that depth-first rendering records
+	if (settings.denoise && (settings.wavefront || isAdaptiveRequested || !settings.checkpointPath.empty() || settings.frameCount > 0 || isDistributed)) {
+		std::cerr << "--denoise needs depth-first rendering of one image with a fixed sample count in one process, without --wavefront, --adaptive, --checkpoint, --frames, --listen, --spawn and --connect.\n";
+		return 1;
 	}
-	
-	// Sky
 
-	// Scale ray direction to unit length (-1.0, 1.0)
-	const RTTVector3 unitDirection = UnitVector(ray.Direction());
-	
-	// Scale y axis to [0, 1];
-	const double t = 0.5 * (unitDirection.y + 1.0);
+	// Workers render units of one frame, the frames of an animation are rendered in one process
+	if (settings.frameCount > 0 && isDistributed) {
+		std::cerr << "--frames renders in one process, without --listen, --spawn and --connect.\n";
+		return 1;
+	}
 
-	// When scaled height is 1 return sky blue, 
-	// when scaled height is 0 return white,
-	// else return blend of blue and white
-	return t * RTType::colorSkyBlue + (1.0 - t) * RTType::colorWhite;
-}
+	// Checkpoints hold the radiance of one process, a coordinator only sees finished units
+	if (!settings.checkpointPath.empty() && isDistributed) {
+		std::cerr << "--checkpoint renders in one process, without --listen, --spawn and --connect.\n";
+		return 1;
+	}
 
-RTTHittableList RandomScene() {
-	RTTHittableList scene;
-
-	// Ground 
-	auto materialGround = std::make_shared<RTType::Lambertian>(RTTColor(0.5, 0.5, 0.5));
-	scene.Add(std::make_shared<RTOSphere>(RTTPoint3(0.0, -1000.0, 0.0), 1000.0, materialGround));
-
-	for (int a = -11; a < 11; ++a) {
-		for (int b = -11; b < 11; ++b) {
-			const double randomMaterial = RT::RandomDouble();
-			RTTPoint3 center(a + 0.9 * RT::RandomDouble(), 0.2, b + 0.9 * RT::RandomDouble());
-
-			if ((center - RTTPoint3(4.0, 0.2, 0.0)).Length() > 0.9) {
-				std::shared_ptr<RTTMaterial> material;
-
-				if (randomMaterial < 0.75) {
-					// Diffuse material
-					RTTColor albedo = RTTColor::Random() * RTTColor::Random();
-					material = std::make_shared<RTType::Lambertian>(albedo);
-					scene.Add(std::make_shared<RTOSphere>(center, 0.2, material));
-				} else if (randomMaterial < 0.95) {
-					// Metallic material
-					RTTColor albedo = RTTColor::Random(0.5, 1.0);
-					double fuzziness = RT::RandomDouble(0.1, 0.9);
-					material = std::make_shared<RTType::Metal>(albedo, fuzziness);
-					scene.Add(std::make_shared<RTOSphere>(center, 0.2, material));
-				} else {
-					material = std::make_shared<RTType::Dielectric>(1.5);
-					scene.Add(std::make_shared<RTOSphere>(center, 0.2, material));
-				}
-			}
-		}
+	// Previews refine one image in place, standard output can take either the previews or the image
+	if (settings.IsPreview() && (settings.wavefront || isAdaptiveRequested || !settings.checkpointPath.empty() || settings.denoise || settings.frameCount > 0 || isDistributed)) {
+		std::cerr << "--preview needs depth-first rendering of one image with a fixed sample count in one process, without --wavefront, --adaptive, --checkpoint, --denoise, --frames, --listen, --spawn and --connect.\n";
+		return 1;
+	}
+	if (settings.previewPath == "-" && settings.outputPath == "-") {
+		std::cerr << "--preview - and -o - both write to standard output.\n";
+		return 1;
 	}
-	
-	auto materialMatte = std::make_shared<RTType::Lambertian>(RTTColor(1.0, 0.75, 0.8));
-	scene.Add(std::make_shared<RTOSphere>(RTTPoint3(0.0, 1.0, 0.0), 1.0, materialMatte));
-	
-	auto materialMetal = std::make_shared<RTType::Metal>(RTTColor(1.0, 0.85, 0.0), 0.3);
-	scene.Add(std::make_shared<RTOSphere>(RTTPoint3(-4.0, 1.0, 0.0), 1.0, materialMetal));
-	
-	auto materialDielectric = std::make_shared<RTType::Dielectric>(1.5);
-	scene.Add(std::make_shared<RTOSphere>(RTTPoint3(4.0, 1.0, 0.0), 1.0, materialDielectric));
-	
-	return scene;
-}
 
-void RenderLines(std::vector<int>& inImage, const RTOCamera inCamera, const RTTHittableList& inWorld, const int inWorkerId, const int inStep) {
-	for (int j = RT::imageHeight - 1 - inWorkerId; j >= 0; j -= inStep) {
-		for (int i = 0; i < RT::imageWidth; ++i) {
-			RTTColor pixelColor(0.0, 0.0, 0.0);
+	// Distributed rendering: this process either renders units for a coordinator or hands the frame out to workers
+	if (!settings.coordinatorAddress.empty()) {
+		return RTRender::RunRenderWorker(settings, std::cerr) ? 0 : 1;
+	}
+	if (settings.IsCoordinator()) {
+		return RTRender::RunRenderCoordinator(settings, argv[0], std::vector<std::string>(argv + 1, argv + argc), std::cerr) ? 0 : 1;
+	}
 
-			for (int sample = 0; sample < RT::samplesPerPixel; ++sample) {
-				const double col = (static_cast<double>(i) + RT::RandomDouble()) / (RT::imageWidth - 1);
-				const double row = (static_cast<double>(j) + RT::RandomDouble()) / (RT::imageHeight - 1);
-				const RTTRay ray(inCamera.GetRay(col, row));
-				pixelColor += RayColor(ray, inWorld, RT::maxDepth);
-			}
+	RTRImageFormat format = RTRImageWriter::FormatFromPath(settings.outputPath);
+	if (!settings.outputFormat.empty()) {
+		RTRImageWriter::FormatFromName(settings.outputFormat, format);
+	}
 
-			RTType::WriteColor(inImage, 3 * ((RT::imageHeight - 1 - j) * RT::imageWidth + i), pixelColor, RT::samplesPerPixel);
-		}
+	// A progressive, preview or denoised render keeps the whole image until it is finished, anything else is rendered
+	// band by band. Bands are only written in file order on a pipe, and the bottom band of a PFM image is rendered last
+	const bool isProgressive = !settings.checkpointPath.empty();
+	const bool isPreview = settings.IsPreview();
+	const bool isBanded = !isProgressive && !isPreview && !settings.denoise && settings.BandHeight() < settings.imageHeight;
+	if (isBanded && RTRImageWriter::NeedsWholeImage(settings.outputPath, format)) {
+		std::cerr << "--band-rows cannot write PFM to standard output, its rows run bottom to top. Write to a file instead.\n";
+		return 1;
 	}
-}
 
-int main() {
 	// World
-	const RTTHittableList world = RandomScene();
-	
+	const std::chrono::steady_clock::time_point worldStart = std::chrono::steady_clock::now();
+	RTOScene scene;
+	RTOCameraView view;
+	if (!RTObject::MakeScene(settings, scene, view, std::cerr)) {
+		return 1;
+	}
+	if (!settings.exportScenePath.empty()) {
+		if (!RTObject::SaveScene(settings.exportScenePath, scene, view, std::cerr)) {
+			return 1;
+		}
+		std::cerr << "Wrote " << scene.spheres.size() << " spheres and " << scene.MaterialCount() << " materials to " << settings.exportScenePath << ".\n";
+		return 0;
+	}
+	const RTTBVH world = scene.BuildHierarchy(settings.sphereGroupSize);
+	std::cerr << "Scene: " << scene.RenderedSphereCount() << " spheres, " << scene.instances.size() << " instances, " << scene.MaterialCount() << " materials, "
+		<< (scene.MemorySize() + world.MemorySize()) / 1024 << " KiB with the BVH, "
+		<< (settings.scenePath.empty() ? "generated" : "loaded") << " and ready to trace in "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - worldStart).count() << " ms.\n";
+
 	// Camera
-	const RTTPoint3 lookFrom(13.0, 2.0, 3.0);
-	const RTTPoint3 lookAt(0.0, 0.0, 0.0);
-	const RTTVector3 vectorUp(0.0, 1.0, 0.0);
-	
-	const RTOCamera camera(lookFrom, lookAt, vectorUp, 20.0, RT::aspectRatio, 0.1, 10);
+	const RTOCamera camera = view.ToCamera(settings.AspectRatio());
 
 	// Multithreading
-	std::vector<std::thread> workers;
+	RTRWorkerPool pool(settings.threadCount, RTRender::WorkerPoolOptions::FromSettings(settings));
+	RTRFrameRenderer renderer(settings, camera, world, pool);
+	if (pool.GetThreadCount() < pool.GetRequestedThreadCount()) {
+		std::cerr << "Using " << pool.GetThreadCount() << " of the " << pool.GetRequestedThreadCount()
+			<< " threads asked for, one per CPU this process may run on; --oversubscribe keeps them all.\n";
+	}
+	if (pool.IsPinned()) {
+		const RT::CpuTopology& topology = RT::SystemTopology();
+		std::cerr << "Workers pinned over " << topology.cpus.size() << " CPUs, " << topology.coreCount << " cores and "
+			<< topology.nodeCount << " NUMA nodes" << (topology.isFromSysfs ? "" : " (topology not read from sysfs)") << ".\n";
+	}
+
+	// Animation: the scene, BVH and threads stay for every frame of the camera path
+	if (settings.frameCount > 0) {
+		RTOCameraPath cameraPath = RTOCameraPath::Orbit(view);
+		if (!settings.cameraPathPath.empty() && !RTOCameraPath::Load(settings.cameraPathPath, view, cameraPath, std::cerr)) {
+			return 1;
+		}
+		std::cerr << "Animating " << settings.frameCount << " frames of " << settings.imageWidth << "x" << settings.imageHeight << ", "
+			<< settings.samplesPerPixel << " samples per pixel, with " << renderer.GetThreadCount() << " threads, camera path of "
+			<< cameraPath.KeyframeCount() << " keyframes" << (cameraPath.IsLoop() ? ", looped" : "") << ".\n";
+		RTRAnimationStats animationStats;
+		if (!RTRender::RenderAnimation(settings, cameraPath, renderer, animationStats, std::cerr)) {
+			return 1;
+		}
+		animationStats.Print(std::cerr);
+		world.PrintStats(std::cerr);
+		std::cerr << "Done.\n";
+		return 0;
+	}
+
+	// Framebuffer
+	// One band of rows in memory at a time, the writer takes each band before the next one is rendered over it
+	const bool isAdaptive = renderer.IsAdaptive();
+	RTRFrameBuffer image(settings.imageWidth, settings.imageHeight, isBanded ? settings.BandHeight() : 0, isAdaptive);
+	RTRImageWriter writer(settings.outputPath, format, image);
+	if (!writer.IsOpen()) {
+		std::cerr << "Cannot open " << settings.outputPath << " for writing.\n";
+		return 1;
+	}
+	std::unique_ptr<RTRFrameBuffer> heatmap;
+	std::unique_ptr<RTRImageWriter> heatmapWriter;
+	if (isAdaptive && !settings.sampleHeatmapPath.empty()) {
+		heatmap = std::make_unique<RTRFrameBuffer>(settings.imageWidth, settings.imageHeight, image.GetBandHeight());
+		heatmapWriter = std::make_unique<RTRImageWriter>(settings.sampleHeatmapPath, RTRImageWriter::FormatFromPath(settings.sampleHeatmapPath), *heatmap);
+		if (!heatmapWriter->IsOpen()) {
+			std::cerr << "Cannot open " << settings.sampleHeatmapPath << " for writing.\n";
+			return 1;
+		}
+	}
+	std::unique_ptr<RTRGuideBuffers> guides;
+	if (settings.denoise) {
+		guides = std::make_unique<RTRGuideBuffers>(settings.imageWidth, settings.imageHeight);
+		renderer.SetGuideBuffers(guides.get());
+	}
 
 	// Render
-	std::cout << "P3\n" << RT::imageWidth << ' ' << RT::imageHeight << "\n255\n";
-	std::vector<int> image(RT::imageWidth * RT::imageHeight * 3);
+	std::cerr << "Tracing " << settings.imageWidth << "x" << settings.imageHeight << " image, " << settings.samplesPerPixel << " samples per pixel, with "
+		<< pool.GetThreadCount() << " threads on CPU, " << RTOSphereGroup::KernelName() << " sphere kernel, "
+		<< (settings.ambientOcclusionRays > 0 ? "ambient occlusion" : settings.wavefront ? "wavefront paths" : "depth-first paths") << ".\n";
+	std::cerr << "Frame buffer: " << image.GetBandHeight() << " rows per band, "
+		<< static_cast<double>(image.MemorySize() + (heatmap ? heatmap->MemorySize() : 0) + (guides ? guides->MemorySize() : 0)) / (1 << 20) << " MiB.\n";
 
-	std::cerr << "Tracing image with " << RT::threadCount << " threads on CPU.\n";
-	for (int workerId = 0; workerId < RT::threadCount; ++workerId) {
-		workers.emplace_back(RenderLines, std::ref(image), std::ref(camera), std::ref(world), workerId, RT::threadCount);
+	RTRTileScheduler::Stats renderStats;
+	// Adaptive sampling counts the samples each band took
+	double primaryRays = isAdaptive ? 0.0 : static_cast<double>(settings.PixelCount()) * settings.samplesPerPixel;
+	if (isPreview) {
+		RTRPreviewPublisher publisher(settings.previewPath, settings.previewPort, settings.imageWidth, settings.imageHeight);
+		if (!publisher.IsOpen()) {
+			std::cerr << "Cannot listen on port " << settings.previewPort << " for previews.\n";
+			return 1;
+		}
+		if (publisher.GetPort() >= 0) {
+			std::cerr << "Serving previews on 127.0.0.1:" << publisher.GetPort() << ".\n";
+		}
+		RTRRadianceBuffer radiance(settings.imageWidth, settings.imageHeight);
+		RTRPreviewStats previewStats;
+		if (!RTRender::RenderPreview(settings, camera, world, pool, renderer, radiance, publisher, previewStats, std::cerr)) {
+			return 1;
+		}
+		previewStats.Print(std::cerr);
+		renderStats = previewStats.scheduler;
+		primaryRays = previewStats.primaryRays;
+		radiance.Resolve(image);
+		writer.RowsFinished(0, settings.imageHeight);
+	} else if (isProgressive) {
+		RTRRadianceBuffer radiance(settings.imageWidth, settings.imageHeight);
+		RTRProgressiveStats progressiveStats;
+		const bool isFinished = RTRender::RenderProgressive(settings, renderer, radiance, progressiveStats, std::cerr);
+		if (!isFinished) {
+			return 1;
+		}
+		progressiveStats.Print(std::cerr);
+		renderStats = progressiveStats.scheduler;
+		primaryRays = progressiveStats.primaryRays;
+		radiance.Resolve(image);
+		writer.RowsFinished(0, settings.imageHeight);
+	} else {
+		for (int bandStart = 0; bandStart < settings.imageHeight; bandStart += image.GetBandHeight()) {
+			image.SetBand(bandStart);
+			const RTRTile band{0, bandStart, settings.imageWidth, image.GetEndRow()};
+			renderStats += renderer.RenderRows(image, band.y0, band.y1, [&](const int y0, const int y1) {
+				// Rows are encoded while the other tiles are still rendering, once denoised when a denoiser runs
+				if (!guides) {
+					writer.RowsFinished(y0, y1);
+				}
+			});
+
+			if (isAdaptive) {
+				primaryRays += static_cast<double>(image.SampleTotal());
+			}
+			if (heatmap) {
+				heatmap->SetBand(bandStart);
+				renderer.GetSampler().SampleHeatmap(image, *heatmap);
+				heatmapWriter->RowsFinished(band.y0, band.y1);
+			}
+		}
 	}
-	
-	for (std::thread& worker : workers) {
-		worker.join();
+	if (guides) {
+		const std::chrono::steady_clock::time_point denoiseStart = std::chrono::steady_clock::now();
+		RTRDenoiser::Parameters denoiseParameters;
+		denoiseParameters.iterations = settings.denoiseIterations;
+		denoiseParameters.samplesPerPixel = settings.samplesPerPixel;
+		RTRDenoiser(denoiseParameters).Denoise(image, *guides, pool);
+		std::cerr << "Denoised in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - denoiseStart).count()
+			<< " ms, " << settings.denoiseIterations << " iterations.\n";
+		writer.RowsFinished(0, settings.imageHeight);
 	}
-	
+	std::cerr << "Traced in " << renderStats.wallSeconds << " s, " << primaryRays / renderStats.wallSeconds / 1e6 << " M primary rays/s\n";
+	renderStats.Print(std::cerr);
+	if (isAdaptive) {
+		const auto pixelCount = static_cast<double>(settings.PixelCount());
+		std::cerr << "Adaptive sampling: " << primaryRays / pixelCount << " samples per pixel on average, "
+			<< 100.0 * primaryRays / (pixelCount * settings.samplesPerPixel) << "% of the fixed budget\n";
+	}
+	if constexpr (RT::renderStats) {
+		const RTRRenderReport report = RTRRenderReport::Collect(renderStats);
+		report.Print(std::cerr);
+		if (!settings.statsJsonPath.empty() && !report.WriteJson(settings.statsJsonPath)) {
+			std::cerr << "Failed to write " << settings.statsJsonPath << ".\n";
+			return 1;
+		}
+	} else if (!settings.statsJsonPath.empty()) {
+		std::cerr << "Render statistics are compiled out, " << settings.statsJsonPath << " is not written.\n";
+	}
+	world.PrintStats(std::cerr);
+
 	// Output
-	std::cerr << "Writing image\n";
-	for (int i = 0; i < image.size(); i += 3) {
-		std::cout << image[i] << ' ' << image[i + 1] << ' ' << image[i + 2] << '\n';
+	if (!writer.Finish()) {
+		std::cerr << "Failed to write " << settings.outputPath << ".\n";
+		return 1;
+	}
+	if (heatmapWriter && !heatmapWriter->Finish()) {
+		std::cerr << "Failed to write " << settings.sampleHeatmapPath << ".\n";
+		return 1;
 	}
 	std::cerr << "Done.\n";
 }